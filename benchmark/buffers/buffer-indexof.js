@@ -0,0 +1,43 @@
+var common = require('../common.js');
+var BufferSearcher = require('buffer').BufferSearcher;
+
+var bench = common.createBenchmark(main, {
+  needle: [1, 2, 4, 8, 16, 32, 64, 256],
+  size: [1024, 64 * 1024, 4 * 1024 * 1024],
+  type: ['buffer', 'string', 'searcher'],
+  mb: [256]
+});
+
+function main(conf) {
+  var size = conf.size >>> 0;
+  var needleLength = conf.needle >>> 0;
+  var iter = Math.max(1, Math.floor(conf.mb * 1024 * 1024 / size));
+
+  // Fill the haystack with text that shares most of its bytes with the
+  // needle so that the search cannot get away with first-byte filtering.
+  var haystack = new Buffer(size);
+  for (var i = 0; i < size; i++)
+    haystack[i] = 0x61 + (i % 26);
+
+  var needle = new Buffer(needleLength);
+  for (var i = 0; i < needleLength; i++)
+    needle[i] = 0x61 + (i % 26);
+  needle[needleLength - 1] = 0x2d;  // '-', never in the haystack
+
+  if (conf.type === 'searcher') {
+    var searcher = new BufferSearcher(needle);
+    bench.start();
+    for (var i = 0; i < iter; i++)
+      searcher.search(haystack);
+    bench.end(iter * size / (1024 * 1024));
+    return;
+  }
+
+  if (conf.type === 'string')
+    needle = needle.toString('binary');
+
+  bench.start();
+  for (var i = 0; i < iter; i++)
+    haystack.indexOf(needle);
+  bench.end(iter * size / (1024 * 1024));
+}
@@ -0,0 +1,30 @@
+var common = require('../common.js');
+
+var bench = common.createBenchmark(main, {
+  content: ['ascii', 'latin1', 'bmp', 'invalid'],
+  size: [16, 256, 4096, 65536],
+  n: [1e5]
+});
+
+var samples = {
+  ascii: '{"id":123,"name":"value","tags":["a","b"]} ',
+  latin1: 'Cafe au lait, crème brûlée. ',
+  bmp: 'Привет, 世界! ',
+  invalid: 'abc� '
+};
+
+function main(conf) {
+  var size = conf.size >>> 0;
+  var n = conf.n >>> 0;
+  var text = '';
+  while (Buffer.byteLength(text) < size)
+    text += samples[conf.content];
+  var buf = new Buffer(text).slice(0, size);
+  if (conf.content === 'invalid')
+    buf[buf.length >> 1] = 0xff;
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    buf.toString('utf8');
+  bench.end(n);
+}
@@ -4,7 +4,9 @@ var keylen = {'aes-128-gcm': 16, 'aes-192-gcm': 24, 'aes-256-gcm': 32};
 var bench = common.createBenchmark(main, {
   n: [500],
   cipher: ['aes-128-gcm', 'aes-192-gcm', 'aes-256-gcm'],
-  len: [1024, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024]
+  len: [1024, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024],
+  // inplace encrypts and decrypts the message with update(data, data)
+  api: ['alloc', 'inplace']
 });
 
 function main(conf) {
@@ -12,8 +14,9 @@ function main(conf) {
   var key = crypto.randomBytes(keylen[conf.cipher]);
   var iv = crypto.randomBytes(12);
   var associate_data = (new Buffer(16)).fill('z');
+  var fn = conf.api === 'inplace' ? AEAD_InPlace_Bench : AEAD_Bench;
   bench.start();
-  AEAD_Bench(conf.cipher, message, associate_data, key, iv, conf.n, conf.len);
+  fn(conf.cipher, message, associate_data, key, iv, conf.n, conf.len);
 }
 
 function AEAD_Bench(cipher, message, associate_data, key, iv, n, len) {
@@ -36,3 +39,24 @@ function AEAD_Bench(cipher, message, associate_data, key, iv, n, len) {
 
   bench.end(mbits);
 }
+
+function AEAD_InPlace_Bench(cipher, message, associate_data, key, iv, n, len) {
+  var written = n * len;
+  var bits = written * 8;
+  var mbits = bits / (1024 * 1024);
+
+  for (var i = 0; i < n; i++) {
+    var alice = crypto.createCipheriv(cipher, key, iv);
+    alice.setAAD(associate_data);
+    alice.update(message, message);
+    alice.final();
+    var tag = alice.getAuthTag();
+    var bob = crypto.createDecipheriv(cipher, key, iv);
+    bob.setAuthTag(tag);
+    bob.setAAD(associate_data);
+    bob.update(message, message);
+    bob.final();
+  }
+
+  bench.end(mbits);
+}
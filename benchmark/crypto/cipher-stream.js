@@ -5,7 +5,7 @@ var bench = common.createBenchmark(main, {
   cipher: [ 'AES192', 'AES256' ],
   type: ['asc', 'utf', 'buf'],
   len: [2, 1024, 102400, 1024 * 1024],
-  api: ['legacy', 'stream']
+  api: ['legacy', 'stream', 'into']
 });
 
 function main(conf) {
@@ -54,7 +54,17 @@ function main(conf) {
       throw new Error('unknown message type: ' + conf.type);
   }
 
-  var fn = api === 'stream' ? streamWrite : legacyWrite;
+  var fn;
+  if (api === 'stream') {
+    fn = streamWrite;
+  } else if (api === 'into') {
+    // update(data, output) only takes buffers
+    if (encoding)
+      message = new Buffer(message, encoding);
+    fn = intoWrite;
+  } else {
+    fn = legacyWrite;
+  }
 
   // write data as fast as possible to alice, and have bob decrypt.
   // use old API for comparison to v0.8
@@ -96,6 +106,23 @@ function legacyWrite(alice, bob, message, encoding, writes) {
   dec = bob.final();
   written += dec.length;
   var bits = written * 8;
-  var gbits = written / (1024 * 1024 * 1024);
+  var gbits = bits / (1024 * 1024 * 1024);
+  bench.end(gbits);
+}
+
+// Reuses the same output buffers for all of the writes
+function intoWrite(alice, bob, message, encoding, writes) {
+  var enc = new Buffer(message.length + 32);
+  var dec = new Buffer(message.length + 64);
+  var written = 0;
+  for (var i = 0; i < writes; i++) {
+    var n = alice.update(message, enc);
+    written += bob.update(enc.slice(0, n), dec);
+  }
+  var final = alice.final();
+  written += bob.update(final).length;
+  written += bob.final().length;
+  var bits = written * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
   bench.end(gbits);
 }
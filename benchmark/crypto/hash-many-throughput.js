@@ -0,0 +1,47 @@
+// throughput benchmark of digesting many buffers, one after the other on
+// the main thread or with crypto.hashMany() on the threadpool
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  batches: [20],
+  inputs: [100],
+  algo: ['sha1', 'sha256'],
+  len: [1024, 102400, 1024 * 1024],
+  api: ['sync', 'hashMany']
+});
+
+function main(conf) {
+  var inputs = [];
+  for (var i = 0; i < conf.inputs; i++) {
+    var buf = new Buffer(conf.len);
+    buf.fill(i);
+    inputs.push(buf);
+  }
+
+  var batches = conf.batches;
+  var bits = batches * conf.inputs * conf.len * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
+
+  bench.start();
+
+  if (conf.api === 'sync') {
+    while (batches-- > 0) {
+      inputs.map(function(buf) {
+        return crypto.createHash(conf.algo).update(buf).digest();
+      });
+    }
+    bench.end(gbits);
+    return;
+  }
+
+  (function next() {
+    if (batches-- === 0)
+      return bench.end(gbits);
+    crypto.hashMany(conf.algo, inputs, function(err) {
+      if (err)
+        throw err;
+      next();
+    });
+  })();
+}
@@ -1,5 +1,6 @@
 // throughput benchmark
 // creates a single hasher, then pushes a bunch of data through it
+// api=oneshot uses crypto.hash() instead of a hasher
 var common = require('../common.js');
 var crypto = require('crypto');
 
@@ -9,7 +10,7 @@ var bench = common.createBenchmark(main, {
   type: ['asc', 'utf', 'buf'],
   out: ['hex', 'binary', 'buffer'],
   len: [2, 1024, 102400, 1024 * 1024],
-  api: ['legacy', 'stream']
+  api: ['legacy', 'stream', 'oneshot']
 });
 
 function main(conf) {
@@ -42,7 +43,13 @@ function main(conf) {
       throw new Error('unknown message type: ' + conf.type);
   }
 
-  var fn = api === 'stream' ? streamWrite : legacyWrite;
+  var fn;
+  if (api === 'stream')
+    fn = streamWrite;
+  else if (api === 'oneshot')
+    fn = oneShot;
+  else
+    fn = legacyWrite;
 
   bench.start();
   fn(conf.algo, message, encoding, conf.writes, conf.len, conf.out);
@@ -84,3 +91,19 @@ function streamWrite(algo, message, encoding, writes, len, outEnc) {
 
   bench.end(gbits);
 }
+
+function oneShot(algo, message, encoding, writes, len, outEnc) {
+  var written = writes * len;
+  var bits = written * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
+
+  // crypto.hash() takes strings as binary, like hash.update() without an
+  // encoding
+  if (encoding)
+    message = new Buffer(message, encoding);
+
+  while (writes-- > 0)
+    crypto.hash(algo, message, outEnc);
+
+  bench.end(gbits);
+}
@@ -0,0 +1,84 @@
+// throughput benchmark of Diffie-Hellman and ECDH key agreement, run
+// synchronously or on the threadpool.  report=lag reports how late, on
+// average, a 10 ms timer fires in the meantime.
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  dur: [5],
+  type: ['modp2', 'modp14', 'prime256v1'],
+  mode: ['sync', 'async'],
+  // Operations in flight, or run back to back before yielding to the loop
+  concurrency: [1, 16],
+  report: ['ops', 'lag']
+});
+
+// Interval of the timer that measures event loop lag, in ms
+var LAG_INTERVAL = 10;
+
+function main(conf) {
+  var alice, bob;
+  if (/^modp/.test(conf.type)) {
+    alice = crypto.getDiffieHellman(conf.type);
+    bob = crypto.getDiffieHellman(conf.type);
+  } else {
+    alice = crypto.createECDH(conf.type);
+    bob = crypto.createECDH(conf.type);
+  }
+  alice.generateKeys();
+  var bobKey = bob.generateKeys();
+
+  function run(cb) {
+    return alice.computeSecret(bobKey, null, null, cb);
+  }
+
+  var concurrency = +conf.concurrency;
+  var ops = 0;
+  var running = true;
+
+  var lagTotal = 0;
+  var lagCount = 0;
+  var last = process.hrtime();
+  var timer = setInterval(function() {
+    var now = process.hrtime();
+    var elapsed = (now[0] - last[0]) * 1e3 + (now[1] - last[1]) / 1e6;
+    lagTotal += Math.max(0, elapsed - LAG_INTERVAL);
+    lagCount++;
+    last = now;
+  }, LAG_INTERVAL);
+
+  function onDone(err) {
+    if (err)
+      throw err;
+    ops++;
+    if (running)
+      run(onDone);
+  }
+
+  function syncBatch() {
+    for (var i = 0; i < concurrency; i++)
+      run();
+    ops += concurrency;
+    if (running)
+      setImmediate(syncBatch);
+  }
+
+  setTimeout(function() {
+    running = false;
+    clearInterval(timer);
+    if (conf.report === 'lag') {
+      // Average lag in ms
+      bench.report(lagCount === 0 ? 0 : lagTotal / lagCount);
+    } else {
+      bench.end(ops);
+    }
+  }, conf.dur * 1000);
+
+  bench.start();
+  if (conf.mode === 'async') {
+    for (var i = 0; i < concurrency; i++)
+      run(onDone);
+  } else {
+    syncBatch();
+  }
+}
@@ -0,0 +1,123 @@
+// throughput benchmark of the RSA operations, run synchronously or on the
+// threadpool.  report=lag reports how late, on average, a 10 ms timer fires
+// in the meantime.
+var common = require('../common.js');
+var crypto = require('crypto');
+var fs = require('fs');
+var path = require('path');
+var fixtures_keydir = path.resolve(__dirname, '../../test/fixtures/keys/');
+var keylen_list = ['1024', '2048'];
+var RSA_PublicPem = {};
+var RSA_PrivatePem = {};
+
+keylen_list.forEach(function(key) {
+  RSA_PublicPem[key] = fs.readFileSync(fixtures_keydir +
+                                       '/rsa_public_' + key + '.pem');
+  RSA_PrivatePem[key] = fs.readFileSync(fixtures_keydir +
+                                        '/rsa_private_' + key + '.pem');
+});
+
+var bench = common.createBenchmark(main, {
+  dur: [5],
+  op: ['sign', 'verify', 'encrypt', 'decrypt'],
+  keylen: keylen_list,
+  mode: ['sync', 'async'],
+  // Operations in flight, or run back to back before yielding to the loop
+  concurrency: [1, 16],
+  report: ['ops', 'lag']
+});
+
+// Interval of the timer that measures event loop lag, in ms
+var LAG_INTERVAL = 10;
+
+function main(conf) {
+  var privateKey = RSA_PrivatePem[conf.keylen];
+  var publicKey = RSA_PublicPem[conf.keylen];
+  var message = new Buffer(32);
+  message.fill('b');
+
+  var signature = crypto.createSign('RSA-SHA256')
+                        .update(message)
+                        .sign(privateKey);
+  var encrypted = crypto.publicEncrypt(publicKey, message);
+
+  var run;
+  switch (conf.op) {
+    case 'sign':
+      run = function(cb) {
+        return crypto.createSign('RSA-SHA256')
+                     .update(message)
+                     .sign(privateKey, cb);
+      };
+      break;
+    case 'verify':
+      run = function(cb) {
+        return crypto.createVerify('RSA-SHA256')
+                     .update(message)
+                     .verify(publicKey, signature, null, cb);
+      };
+      break;
+    case 'encrypt':
+      run = function(cb) {
+        return crypto.publicEncrypt(publicKey, message, cb);
+      };
+      break;
+    case 'decrypt':
+      run = function(cb) {
+        return crypto.privateDecrypt(privateKey, encrypted, cb);
+      };
+      break;
+    default:
+      throw new Error('invalid op');
+  }
+
+  var concurrency = +conf.concurrency;
+  var ops = 0;
+  var running = true;
+
+  var lagTotal = 0;
+  var lagCount = 0;
+  var last = process.hrtime();
+  var timer = setInterval(function() {
+    var now = process.hrtime();
+    var elapsed = (now[0] - last[0]) * 1e3 + (now[1] - last[1]) / 1e6;
+    lagTotal += Math.max(0, elapsed - LAG_INTERVAL);
+    lagCount++;
+    last = now;
+  }, LAG_INTERVAL);
+
+  function onDone(err) {
+    if (err)
+      throw err;
+    ops++;
+    if (running)
+      run(onDone);
+  }
+
+  function syncBatch() {
+    for (var i = 0; i < concurrency; i++)
+      run();
+    ops += concurrency;
+    if (running)
+      setImmediate(syncBatch);
+  }
+
+  setTimeout(function() {
+    running = false;
+    clearInterval(timer);
+    if (conf.report === 'lag') {
+      // Average lag in ms
+      bench.report(lagCount === 0 ? 0 : lagTotal / lagCount);
+    } else {
+      bench.end(ops);
+    }
+  }, conf.dur * 1000);
+
+  bench.start();
+  if (conf.mode === 'async') {
+    for (var i = 0; i < concurrency; i++)
+      run(onDone);
+  } else {
+    syncBatch();
+  }
+}
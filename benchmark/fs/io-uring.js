@@ -0,0 +1,85 @@
+// throughput of small fs requests on the threadpool and on io_uring.
+// backend=io_uring needs Linux 5.6 or newer, it falls back to the threadpool
+// otherwise.
+var path = require('path');
+var common = require('../common.js');
+var fs = require('fs');
+var filename = path.resolve(__dirname, '.removeme-benchmark-garbage');
+
+var bench = common.createBenchmark(main, {
+  dur: [5],
+  op: ['stat', 'fstat', 'open', 'read', 'write'],
+  backend: ['threadpool', 'io_uring'],
+  // Requests in flight
+  concurrency: [1, 32]
+});
+
+function main(conf) {
+  // Has to be set before the first asynchronous fs call
+  process.env.UV_USE_IO_URING = conf.backend === 'io_uring' ? '1' : '0';
+
+  var buf = new Buffer(4096);
+  buf.fill('x');
+  fs.writeFileSync(filename, buf);
+  var fd = fs.openSync(filename, 'r+');
+
+  var run;
+  switch (conf.op) {
+    case 'stat':
+      run = function(cb) {
+        fs.stat(filename, cb);
+      };
+      break;
+    case 'fstat':
+      run = function(cb) {
+        fs.fstat(fd, cb);
+      };
+      break;
+    case 'open':
+      run = function(cb) {
+        fs.open(filename, 'r', function(err, fd) {
+          if (err)
+            return cb(err);
+          fs.closeSync(fd);
+          cb();
+        });
+      };
+      break;
+    case 'read':
+      run = function(cb) {
+        fs.read(fd, new Buffer(4096), 0, 4096, 0, cb);
+      };
+      break;
+    case 'write':
+      run = function(cb) {
+        fs.write(fd, buf, 0, buf.length, 0, cb);
+      };
+      break;
+    default:
+      throw new Error('invalid op');
+  }
+
+  var ops = 0;
+  var running = true;
+
+  function onDone(err) {
+    // Requests still in flight at the end see the file go away
+    if (!running)
+      return;
+    if (err)
+      throw err;
+    ops++;
+    run(onDone);
+  }
+
+  setTimeout(function() {
+    running = false;
+    fs.closeSync(fd);
+    try { fs.unlinkSync(filename); } catch (e) {}
+    bench.end(ops);
+  }, conf.dur * 1000);
+
+  bench.start();
+  for (var i = 0; i < +conf.concurrency; i++)
+    run(onDone);
+}
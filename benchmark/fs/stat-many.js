@@ -0,0 +1,57 @@
+// stat() the files of the lib/ directory, one fs.stat() call per file or a
+// single fs.statMany() call.
+var path = require('path');
+var common = require('../common.js');
+var fs = require('fs');
+
+var bench = common.createBenchmark(main, {
+  n: [1000],
+  method: ['stat', 'statMany'],
+  // Copies of the file list per round
+  files: [1, 10]
+});
+
+function main(conf) {
+  var dir = path.resolve(__dirname, '../../lib');
+  var paths = [];
+  for (var i = 0; i < +conf.files; i++) {
+    paths = paths.concat(fs.readdirSync(dir).map(function(name) {
+      return path.join(dir, name);
+    }));
+  }
+
+  var n = +conf.n;
+  var rounds = 0;
+
+  function next() {
+    if (++rounds === n)
+      return bench.end(n * paths.length);
+    run(next);
+  }
+
+  var run;
+  if (conf.method === 'statMany') {
+    run = function(cb) {
+      fs.statMany(paths, function(err, stats, errors) {
+        if (err)
+          throw err;
+        cb();
+      });
+    };
+  } else {
+    run = function(cb) {
+      var pending = paths.length;
+      paths.forEach(function(p) {
+        fs.stat(p, function(err, stats) {
+          if (err)
+            throw err;
+          if (--pending === 0)
+            cb();
+        });
+      });
+    };
+  }
+
+  bench.start();
+  run(next);
+}
@@ -0,0 +1,36 @@
+// fs.statSync() of a single file, returning a new fs.Stats object per call,
+// filling in a reused Float64Array, or wrapping that array in a lazy fs.Stats
+// object of which only the mtime is read.
+var common = require('../common.js');
+var fs = require('fs');
+
+var bench = common.createBenchmark(main, {
+  n: [1e5],
+  method: ['object', 'values', 'fromValues']
+});
+
+function main(conf) {
+  var file = __filename;
+  var n = +conf.n;
+  var values = new Float64Array(14);
+  var i;
+
+  bench.start();
+  switch (conf.method) {
+    case 'object':
+      for (i = 0; i < n; i++)
+        fs.statSync(file).mtime;
+      break;
+    case 'values':
+      for (i = 0; i < n; i++)
+        fs.statSync(file, values)[11];
+      break;
+    case 'fromValues':
+      for (i = 0; i < n; i++)
+        fs.Stats.fromValues(fs.statSync(file, values)).mtime;
+      break;
+    default:
+      throw new Error('invalid method');
+  }
+  bench.end(n);
+}
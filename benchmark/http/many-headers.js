@@ -0,0 +1,35 @@
+// Parse requests with a growing number of headers.  Above 32 headers the
+// parser used to hand them to JS in batches through onHeaders().
+
+var common = require('../common.js');
+var HTTPParser = process.binding('http_parser').HTTPParser;
+
+var kOnHeaders = HTTPParser.kOnHeaders | 0;
+var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+var kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+
+var bench = common.createBenchmark(main, {
+  headers: [8, 32, 33, 60, 100],
+  n: [1e5]
+});
+
+function main(conf) {
+  var n = conf.n | 0;
+  var request = 'GET /index.html HTTP/1.1\r\nHost: example.com\r\n';
+  for (var i = 1; i < conf.headers; i++)
+    request += 'X-Forwarded-Header-' + i + ': some value ' + i + '\r\n';
+  var buffer = new Buffer(request + '\r\n');
+
+  var parser = new HTTPParser(HTTPParser.REQUEST);
+  var received = 0;
+  parser[kOnHeaders] = function(headers, url) {};
+  parser[kOnHeadersComplete] = function(versionMajor, versionMinor, headers) {
+    received += headers.length;
+  };
+  parser[kOnMessageComplete] = function() {};
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    parser.execute(buffer);
+  bench.end(n);
+}
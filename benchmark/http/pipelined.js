@@ -0,0 +1,62 @@
+// Requests per second with clients that pipeline a number of requests in
+// every write.
+
+var common = require('../common.js');
+var http = require('http');
+var net = require('net');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  pipeline: [1, 8, 32],
+  c: [10],
+  dur: [5]
+});
+
+function main(conf) {
+  var pipeline = conf.pipeline | 0;
+  var request = '';
+  for (var i = 0; i < pipeline; i++)
+    request += 'GET / HTTP/1.1\r\nHost: localhost\r\n\r\n';
+
+  var responses = 0;
+  var running = true;
+  var server = http.createServer(function(req, res) {
+    res.writeHead(200, { 'Content-Type': 'text/plain',
+                         'Content-Length': 2 });
+    res.end('ok');
+    responses++;
+  });
+
+  server.listen(PORT, function() {
+    for (var i = 0; i < conf.c; i++)
+      connect();
+    bench.start();
+    setTimeout(function() {
+      running = false;
+      bench.end(responses);
+      process.exit(0);
+    }, conf.dur * 1000);
+  });
+
+  function connect() {
+    var socket = net.connect(PORT);
+    var pending = 0;
+    var last = 0;
+    socket.on('data', function(data) {
+      // Every response ends in "ok", send the next batch once all of them
+      // are in.
+      for (var i = 0; i < data.length; i++) {
+        if (last === 111 && data[i] === 107)
+          pending--;
+        last = data[i];
+      }
+      if (pending <= 0 && running)
+        send();
+    });
+    send();
+    function send() {
+      pending += pipeline;
+      socket.write(request);
+    }
+  }
+}
@@ -0,0 +1,73 @@
+// Read buffers sliced from a shared slab versus a malloc() per read, with
+// many connections doing small reads.
+
+var common = require('../common.js');
+var child_process = require('child_process');
+var net = require('net');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  alloc: ['slab', 'malloc'],
+  report: ['gbits', 'rss'],
+  conns: [100, 1000],
+  len: [128, 4096],
+  dur: [5]
+});
+
+function main(conf) {
+  // The malloc path needs a fresh process without the slab allocator.
+  if (conf.alloc === 'malloc' &&
+      process.execArgv.indexOf('--read-slab-size=0') === -1) {
+    var argv = process.execArgv.concat('--read-slab-size=0',
+                                       process.argv.slice(1));
+    child_process.spawn(process.execPath, argv, { stdio: 'inherit' });
+    return;
+  }
+
+  var conns = +conf.conns;
+  var chunk = new Buffer(+conf.len);
+  chunk.fill('x');
+
+  var received = 0;
+  var maxRss = 0;
+  var connected = 0;
+  var sockets = [];
+
+  var server = net.createServer(function(socket) {
+    socket.on('data', function(data) {
+      received += data.length;
+    });
+    socket.on('error', function() {});
+  });
+
+  server.listen(PORT, function() {
+    for (var i = 0; i < conns; i++)
+      sockets.push(net.connect(PORT, onconnect));
+  });
+
+  function onconnect() {
+    if (++connected < conns)
+      return;
+
+    var rssTimer = setInterval(function() {
+      maxRss = Math.max(maxRss, process.memoryUsage().rss);
+    }, 100);
+
+    sockets.forEach(function(socket) {
+      socket.on('drain', write);
+      write();
+      function write() {
+        while (socket.write(chunk));
+      }
+    });
+
+    bench.start();
+    setTimeout(function() {
+      clearInterval(rssTimer);
+      if (conf.report === 'rss')
+        return bench.report(maxRss / (1024 * 1024));
+      var gbits = (received * 8) / (1024 * 1024 * 1024);
+      bench.end(gbits);
+    }, +conf.dur * 1000);
+  }
+}
@@ -1,9 +1,22 @@
+// Serves a static body to a fixed number of requests.
+//
+// usage: iojs static_http_server.js [mode] [bytes]
+//
+// mode is one of:
+//   string    res.end() with a string (default)
+//   readfile  read the body from a file into a buffer for every request
+//   sendfile  res.sendFile() from a file descriptor
+
+var fs = require('fs');
 var http = require('http');
+var os = require('os');
+var path = require('path');
 
 var concurrency = 30;
 var port = 12346;
 var n = 700;
-var bytes = 1024*5;
+var mode = process.argv[2] || 'string';
+var bytes = +process.argv[3] || 1024*5;
 
 var requests = 0;
 var responses = 0;
@@ -13,17 +26,42 @@ for (var i = 0; i < bytes; i++) {
   body += 'C';
 }
 
+var file = path.join(os.tmpdir(), 'static_http_server.' + process.pid);
+fs.writeFileSync(file, body);
+var fd = fs.openSync(file, 'r');
+process.on('exit', function() {
+  fs.closeSync(fd);
+  fs.unlinkSync(file);
+});
+
 var server = http.createServer(function(req, res) {
   res.writeHead(200, {
     'Content-Type': 'text/plain',
     'Content-Length': body.length
   });
-  res.end(body);
+  switch (mode) {
+    case 'string':
+      res.end(body);
+      break;
+    case 'readfile':
+      var buf = new Buffer(bytes);
+      fs.read(fd, buf, 0, bytes, 0, function(err) {
+        if (err) throw err;
+        res.end(buf);
+      });
+      break;
+    case 'sendfile':
+      res.sendFile(fd, 0, bytes);
+      break;
+    default:
+      throw new Error('unknown mode: ' + mode);
+  }
 })
 
 server.listen(port, function() {
   var agent = new http.Agent();
   agent.maxSockets = concurrency;
+  var start = process.hrtime();
 
   for (var i = 0; i < n; i++) {
     var req = http.get({
@@ -34,6 +72,10 @@ server.listen(port, function() {
       res.resume();
       res.on('end', function() {
         if (++responses === n) {
+          var elapsed = process.hrtime(start);
+          var seconds = elapsed[0] + elapsed[1] / 1e9;
+          console.log('%s %d bytes: %d req/s',
+                      mode, bytes, (n / seconds).toFixed(2));
           server.close();
         }
       });
@@ -2,7 +2,10 @@ var common = require('../common.js');
 var bench = common.createBenchmark(main, {
   dur: [5],
   type: ['buf', 'asc', 'utf'],
-  size: [2, 1024, 1024 * 1024]
+  size: [2, 1024, 1024 * 1024],
+  conns: [1, 4],
+  async: [0, 1],
+  report: ['mbits', 'lag']
 });
 
 var dur, type, encoding, size;
@@ -14,6 +17,9 @@ var cert_dir = path.resolve(__dirname, '../../test/fixtures');
 var options;
 var tls = require('tls');
 
+// Interval of the timer that measures event loop lag, in ms
+var LAG_INTERVAL = 10;
+
 function main(conf) {
   dur = +conf.dur;
   type = conf.type;
@@ -40,23 +46,35 @@ function main(conf) {
   options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
               cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
               ca: [ fs.readFileSync(cert_dir + '/test_ca.pem') ],
-              ciphers: 'AES256-GCM-SHA384' };
+              ciphers: 'AES256-GCM-SHA384',
+              asyncCrypto: !!+conf.async };
 
+  var conns = [];
+  var writers = [];
+  var connected = 0;
   server = tls.createServer(options, onConnection);
-  setTimeout(done, dur * 1000);
   server.listen(common.PORT, function() {
-    var opt = { port: common.PORT, rejectUnauthorized: false };
+    var opt = { port: common.PORT,
+                rejectUnauthorized: false,
+                asyncCrypto: options.asyncCrypto };
+    for (var i = 0; i < conf.conns; i++)
+      conns.push(connect(opt));
+  });
+
+  function connect(opt) {
     var conn = tls.connect(opt, function() {
-      bench.start();
       conn.on('drain', write);
-      write();
+      if (++connected === +conf.conns)
+        start();
     });
 
     function write() {
-      var i = 0;
       while (false !== conn.write(chunk, encoding));
     }
-  });
+
+    writers.push(write);
+    return conn;
+  }
 
   var received = 0;
   function onConnection(conn) {
@@ -65,11 +83,40 @@ function main(conf) {
     });
   }
 
+  // Every connection writes as fast as it can, while a timer keeps track of
+  // how late the loop gets to it.
+  var lagTotal = 0;
+  var lagCount = 0;
+  var last;
+  function tick() {
+    var now = process.hrtime();
+    var elapsed = (now[0] - last[0]) * 1e3 + (now[1] - last[1]) / 1e6;
+    lagTotal += Math.max(0, elapsed - LAG_INTERVAL);
+    lagCount++;
+    last = now;
+  }
+
+  function start() {
+    bench.start();
+    last = process.hrtime();
+    setInterval(tick, LAG_INTERVAL);
+    setTimeout(done, dur * 1000);
+    writers.forEach(function(write) {
+      write();
+    });
+  }
+
   function done() {
-    var mbits = (received * 8) / (1024 * 1024);
-    bench.end(mbits);
-    conn.destroy();
+    conns.forEach(function(conn) {
+      conn.destroy();
+    });
     server.close();
+    if (conf.report === 'lag') {
+      // Average lag in ms
+      bench.report(lagCount === 0 ? 0 : lagTotal / lagCount);
+    } else {
+      var mbits = (received * 8) / (1024 * 1024);
+      bench.end(mbits);
+    }
   }
 }
-
@@ -1,33 +1,83 @@
 var assert = require('assert'),
+    cluster = require('cluster'),
+    constants = require('constants'),
     fs = require('fs'),
+    os = require('os'),
     path = require('path'),
     tls = require('tls');
 
 var common = require('../common.js');
-var bench = common.createBenchmark(main, {
-  concurrency: [1, 10],
-  dur: [5]
-});
+
+// mode=full does a full handshake for every connection.  mode=resume and
+// mode=shared offer the session of an earlier connection; tickets are off,
+// so only mode=shared, where the servers share a session cache, lets the
+// servers in the other workers resume it.  workers=0 runs the server in
+// this process.
+if (cluster.isMaster) {
+  var bench = common.createBenchmark(main, {
+    concurrency: [1, 10],
+    dur: [5],
+    mode: ['full', 'resume', 'shared'],
+    workers: [0, 4]
+  });
+} else {
+  createServer(process.env.TLS_SESSION_CACHE).listen(common.PORT);
+}
 
 var clientConn = 0;
 var serverConn = 0;
-var server;
 var dur;
 var concurrency;
+var workers;
+var session;
 var running = true;
 
-function main(conf) {
-  dur = +conf.dur;
-  concurrency = +conf.concurrency;
-
+function createServer(cacheFile) {
   var cert_dir = path.resolve(__dirname, '../../test/fixtures'),
       options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
                   cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
                   ca: [ fs.readFileSync(cert_dir + '/test_ca.pem') ],
-                  ciphers: 'AES256-GCM-SHA384' };
+                  ciphers: 'AES256-GCM-SHA384',
+                  secureOptions: constants.SSL_OP_NO_TICKET };
+  if (cacheFile)
+    options.sharedSessionCache = cacheFile;
+
+  return tls.createServer(options, onConnection);
+}
+
+function main(conf) {
+  dur = +conf.dur;
+  concurrency = +conf.concurrency;
 
-  server = tls.createServer(options, onConnection);
-  server.listen(common.PORT, onListening);
+  var cacheFile;
+  if (conf.mode === 'shared') {
+    cacheFile = path.join(os.tmpdir(), 'bench-tls-sessions-' + process.pid);
+    process.on('exit', function() {
+      fs.unlinkSync(cacheFile);
+    });
+  }
+
+  var start = conf.mode === 'full' ? onListening : getSession;
+  workers = +conf.workers;
+  if (workers === 0)
+    return createServer(cacheFile).listen(common.PORT, start);
+
+  var listening = 0;
+  for (var i = 0; i < workers; i++)
+    cluster.fork({ TLS_SESSION_CACHE: cacheFile || '' });
+  cluster.on('listening', function() {
+    if (++listening === workers)
+      start();
+  });
+}
+
+function getSession() {
+  var conn = tls.connect({ port: common.PORT,
+                           rejectUnauthorized: false }, function() {
+    session = conn.getSession();
+    conn.end();
+    onListening();
+  });
 }
 
 function onListening() {
@@ -43,7 +93,8 @@ function onConnection(conn) {
 
 function makeConnection() {
   var conn = tls.connect({ port: common.PORT,
-                           rejectUnauthorized: false }, function() {
+                           rejectUnauthorized: false,
+                           session: session }, function() {
     clientConn++;
     conn.on('error', function(er) {
       console.error('client error', er);
@@ -56,6 +107,14 @@ function makeConnection() {
 
 function done() {
   running = false;
+
+  // The workers' connections are not counted here
+  if (workers > 0) {
+    for (var id in cluster.workers)
+      cluster.workers[id].kill();
+    return bench.end(clientConn);
+  }
+
   // it's only an established connection if they both saw it.
   // because we destroy the server somewhat abruptly, these
   // don't always match.  Generally, serverConn will be
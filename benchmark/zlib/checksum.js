@@ -0,0 +1,63 @@
+// throughput of zlib.crc32() and zlib.adler32(), compared with the ways to
+// get a checksum without them: a table driven CRC-32 in JS and MD5
+var common = require('../common.js');
+var crypto = require('crypto');
+var zlib = require('zlib');
+
+var bench = common.createBenchmark(main, {
+  type: ['crc32', 'adler32', 'crc32-js', 'md5'],
+  len: [64, 1024, 64 * 1024, 1024 * 1024],
+  // Total amount of data to checksum, in MB
+  mb: [64]
+});
+
+var crcTable = null;
+
+function crc32js(buf, crc) {
+  if (crcTable === null) {
+    crcTable = new Int32Array(256);
+    for (var n = 0; n < 256; n++) {
+      var c = n;
+      for (var k = 0; k < 8; k++)
+        c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+      crcTable[n] = c;
+    }
+  }
+  crc = ~crc;
+  for (var i = 0; i < buf.length; i++)
+    crc = crcTable[(crc ^ buf[i]) & 0xff] ^ (crc >>> 8);
+  return ~crc >>> 0;
+}
+
+function main(conf) {
+  var len = conf.len;
+  var buf = new Buffer(len);
+  for (var i = 0; i < len; i++)
+    buf[i] = i * 7;
+  var n = conf.mb * 1024 * 1024 / len;
+
+  var fn;
+  switch (conf.type) {
+    case 'crc32':
+      fn = zlib.crc32;
+      break;
+    case 'adler32':
+      fn = zlib.adler32;
+      break;
+    case 'crc32-js':
+      fn = crc32js;
+      break;
+    case 'md5':
+      fn = function(buf) {
+        return crypto.createHash('md5').update(buf).digest();
+      };
+      break;
+    default:
+      throw new Error('unknown type: ' + conf.type);
+  }
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    fn(buf, 0);
+  bench.end(conf.mb * 8 / 1024);
+}
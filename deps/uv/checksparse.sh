@@ -71,6 +71,7 @@ test/benchmark-sizes.c
 test/benchmark-spawn.c
 test/benchmark-tcp-write-batch.c
 test/benchmark-thread.c
+test/benchmark-threadpool-burst.c
 test/benchmark-udp-pummel.c
 test/blackhole-server.c
 test/dns-server.c
@@ -98,6 +99,7 @@ test/test-fail-always.c
 test/test-fs-event.c
 test/test-fs-poll.c
 test/test-fs.c
+test/test-fs-io-uring.c
 test/test-get-currentexe.c
 test/test-get-loadavg.c
 test/test-get-memory.c
@@ -151,6 +153,8 @@ test/test-tcp-write-to-half-open-connection.c
 test/test-tcp-writealot.c
 test/test-thread.c
 test/test-threadpool-cancel.c
+test/test-threadpool-class.c
+test/test-threadpool-size.c
 test/test-threadpool.c
 test/test-timer-again.c
 test/test-timer.c
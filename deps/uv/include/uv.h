@@ -953,6 +953,46 @@ UV_EXTERN int uv_queue_work(uv_loop_t* loop,
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
 
+/*
+ * Work in the threadpool is queued per class.  Each class can be limited to
+ * a number of threads and given a priority, see uv_threadpool_set_class().
+ */
+typedef enum {
+  UV_THREADPOOL_FS,
+  UV_THREADPOOL_CPU,
+  UV_THREADPOOL_DNS,
+  UV_THREADPOOL_USER,
+  UV_THREADPOOL_CLASS_MAX
+} uv_threadpool_class_t;
+
+typedef struct uv_threadpool_stats_s {
+  unsigned int limit;
+  int priority;
+  unsigned int queued;
+  unsigned int running;
+  uint64_t completed;
+  uint64_t wait_time;      /* Total time spent in the queue, in nanoseconds */
+  uint64_t max_wait_time;  /* Longest time spent in the queue, in nanoseconds */
+  unsigned int concurrency;  /* Requests of the class that can run at once */
+} uv_threadpool_stats_t;
+
+UV_EXTERN int uv_queue_work_class(uv_loop_t* loop,
+                                  uv_work_t* req,
+                                  uv_threadpool_class_t cls,
+                                  uv_work_cb work_cb,
+                                  uv_after_work_cb after_work_cb);
+
+UV_EXTERN int uv_threadpool_set_size(unsigned int min_size,
+                                     unsigned int max_size,
+                                     uint64_t spawn_delay,
+                                     uint64_t idle_time);
+UV_EXTERN int uv_threadpool_set_class(uv_threadpool_class_t cls,
+                                      unsigned int limit,
+                                      int priority);
+UV_EXTERN int uv_threadpool_get_stats(uv_threadpool_class_t cls,
+                                      uv_threadpool_stats_t* stats);
+
+
 struct uv_cpu_info_s {
   char* model;
   int speed;
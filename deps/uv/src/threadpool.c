@@ -38,58 +38,308 @@ static void uv__req_init(uv_loop_t* loop,
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_THREADPOOL_SIZE 128
+#define DEFAULT_SPAWN_THRESHOLD 5  /* ms */
+#define DEFAULT_IDLE_TIMEOUT 5000  /* ms */
+
+enum {
+  SLOT_FREE,
+  SLOT_RUNNING,
+  SLOT_EXITED  /* Thread retired, needs to be joined. */
+};
 
 static uv_once_t once = UV_ONCE_INIT;
 static uv_cond_t cond;
 static uv_mutex_t mutex;
 static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static unsigned int idle_threads;
+static unsigned int starting_threads;
+static struct thread_slot {
+  uv_thread_t thread;
+  int state;
+} slots[MAX_THREADPOOL_SIZE];
+static int exiting;
 static volatile int initialized;
 
+/* The pool starts with min_threads threads.  When a request has waited
+ * longer than spawn_threshold and no thread is idle, the monitor thread adds
+ * a thread, up to max_threads.  Threads above min_threads exit after
+ * idle_timeout without work.  By default min_threads equals max_threads, the
+ * size is fixed and there is no monitor thread.
+ */
+static unsigned int min_threads;
+static unsigned int max_threads;
+static uint64_t spawn_threshold;  /* ns */
+static uint64_t idle_timeout;  /* ns */
+static uv_thread_t monitor_thread;
+static uv_cond_t monitor_cond;
+static int monitor_started;
+
+/* Every class of work has its own queue.  Workers take the oldest request of
+ * the class with the highest priority that is still below its limit, so with
+ * the defaults (no limits, all priorities equal) the pool is a single FIFO.
+ */
+static struct {
+  QUEUE wq;
+  unsigned int limit;  /* 0 means no limit */
+  int priority;
+  unsigned int running;
+  uint64_t completed;
+  uint64_t wait_time;
+  uint64_t max_wait_time;
+} classes[UV_THREADPOOL_CLASS_MAX];
+
+/* The queues link the requests through their reserved fields, which also
+ * hold the time the request was queued at, so struct uv__work and the
+ * public request types keep their layout: reserved[0] and reserved[1] are
+ * the QUEUE, reserved[2] and reserved[3] the uint64_t timestamp.
+ */
+#define REQ_QUEUE(req) ((QUEUE*) &(req)->reserved[0])
+#define QUEUE_REQ(q) QUEUE_DATA(q, uv_req_t, reserved)
+
+STATIC_ASSERT(sizeof(QUEUE) <= 2 * sizeof(void*));
+STATIC_ASSERT(sizeof(uint64_t) <= 2 * sizeof(void*));
+
+static uint64_t queued_at(const uv_req_t* req) {
+  uint64_t t;
+  memcpy(&t, &req->reserved[2], sizeof(t));
+  return t;
+}
+
+
+static void set_queued_at(uv_req_t* req, uint64_t t) {
+  memcpy(&req->reserved[2], &t, sizeof(t));
+}
+
+
+static struct uv__work* req_work(uv_req_t* req) {
+  switch (req->type) {
+  case UV_FS:
+    return &((uv_fs_t*) req)->work_req;
+  case UV_GETADDRINFO:
+    return &((uv_getaddrinfo_t*) req)->work_req;
+  case UV_GETNAMEINFO:
+    return &((uv_getnameinfo_t*) req)->work_req;
+  case UV_WORK:
+    return &((uv_work_t*) req)->work_req;
+  default:
+    return NULL;
+  }
+}
+
 
 static void uv__cancelled(struct uv__work* w) {
   abort();
 }
 
 
+/* Returns the class to take the next request from, or -1 if none of them
+ * has a request that can run now.  Must be called with the mutex held.
+ */
+static int next_class(void) {
+  uint64_t oldest;
+  uint64_t t;
+  unsigned int i;
+  int best;
+
+  best = -1;
+  oldest = 0;
+
+  for (i = 0; i < ARRAY_SIZE(classes); i++) {
+    if (QUEUE_EMPTY(&classes[i].wq))
+      continue;
+
+    if (classes[i].limit != 0 && classes[i].running >= classes[i].limit)
+      continue;
+
+    t = queued_at(QUEUE_REQ(QUEUE_HEAD(&classes[i].wq)));
+
+    if (best != -1) {
+      if (classes[i].priority < classes[best].priority)
+        continue;
+      if (classes[i].priority == classes[best].priority && t >= oldest)
+        continue;
+    }
+
+    best = i;
+    oldest = t;
+  }
+
+  return best;
+}
+
+
+static void worker(void* arg);
+
+
+/* Adds a thread to the pool.  Must be called with the mutex held. */
+static int spawn_thread(void) {
+  unsigned int i;
+  int err;
+
+  for (i = 0; i < ARRAY_SIZE(slots); i++)
+    if (slots[i].state != SLOT_RUNNING)
+      break;
+
+  if (i == ARRAY_SIZE(slots))
+    return UV_EAGAIN;
+
+  /* A retired thread has released the mutex already, it's safe to wait
+   * for it here.
+   */
+  if (slots[i].state == SLOT_EXITED) {
+    if (uv_thread_join(&slots[i].thread))
+      abort();
+    slots[i].state = SLOT_FREE;
+  }
+
+  err = uv_thread_create(&slots[i].thread, worker, &slots[i]);
+  if (err)
+    return err;
+
+  slots[i].state = SLOT_RUNNING;
+  nthreads++;
+  starting_threads++;
+  return 0;
+}
+
+
+/* Adds a thread whenever the oldest request that can run has waited longer
+ * than spawn_threshold while all threads are busy.
+ */
+static void monitor(void* arg) {
+  uint64_t wait_time;
+  uint64_t timeout;
+  QUEUE* q;
+  int c;
+
+  (void) arg;
+
+  uv_mutex_lock(&mutex);
+
+  while (!exiting) {
+    c = next_class();
+
+    /* A thread that is idle or starting up takes the request. */
+    if (c == -1 ||
+        idle_threads > 0 ||
+        starting_threads > 0 ||
+        nthreads >= max_threads) {
+      uv_cond_wait(&monitor_cond, &mutex);
+      continue;
+    }
+
+    q = QUEUE_HEAD(&classes[c].wq);
+    wait_time = uv_hrtime() - queued_at(QUEUE_REQ(q));
+
+    if (wait_time < spawn_threshold)
+      timeout = spawn_threshold - wait_time;
+    else if (spawn_thread() == 0)
+      continue;
+    else
+      timeout = spawn_threshold + 1000000;  /* Try again later. */
+
+    uv_cond_timedwait(&monitor_cond, &mutex, timeout);
+  }
+
+  uv_mutex_unlock(&mutex);
+}
+
+
+/* Must be called with the mutex held. */
+static void start_monitor(void) {
+  if (monitor_started || min_threads == max_threads)
+    return;
+
+  if (uv_thread_create(&monitor_thread, monitor, NULL) == 0)
+    monitor_started = 1;
+}
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
  * never holds the global mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
+  struct thread_slot* slot;
   struct uv__work* w;
+  uv_req_t* req;
+  uint64_t wait_time;
+  uint64_t idle_since;
+  uint64_t now;
   QUEUE* q;
+  int c;
 
-  (void) arg;
+  slot = arg;
+
+  uv_mutex_lock(&mutex);
+  starting_threads--;
+  uv_mutex_unlock(&mutex);
 
   for (;;) {
     uv_mutex_lock(&mutex);
 
-    while (QUEUE_EMPTY(&wq))
-      uv_cond_wait(&cond, &mutex);
+    idle_since = 0;
+    while ((c = next_class()) == -1 && !exiting) {
+      if (nthreads > max_threads)
+        break;
+
+      idle_threads++;
+      if (nthreads > min_threads) {
+        now = uv_hrtime();
+        if (idle_since == 0)
+          idle_since = now;
+        if (now - idle_since >= idle_timeout) {
+          idle_threads--;
+          break;
+        }
+        uv_cond_timedwait(&cond, &mutex, idle_timeout - (now - idle_since));
+      } else {
+        uv_cond_wait(&cond, &mutex);
+      }
+      idle_threads--;
+    }
 
-    q = QUEUE_HEAD(&wq);
+    if (c == -1) {
+      if (!exiting) {
+        /* Retire, the next spawn_thread() or cleanup() joins the thread. */
+        nthreads--;
+        slot->state = SLOT_EXITED;
+      }
+      uv_cond_signal(&cond);
+      uv_mutex_unlock(&mutex);
+      break;
+    }
 
-    if (q == &exit_message)
+    q = QUEUE_HEAD(&classes[c].wq);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is executing. */
+
+    req = QUEUE_REQ(q);
+    w = req_work(req);
+    wait_time = uv_hrtime() - queued_at(req);
+    classes[c].running++;
+    classes[c].wait_time += wait_time;
+    if (wait_time > classes[c].max_wait_time)
+      classes[c].max_wait_time = wait_time;
+
+    /* Wake up another worker if there is more work that can run now. */
+    if (next_class() != -1) {
       uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
+      if (monitor_started)
+        uv_cond_signal(&monitor_cond);
     }
 
     uv_mutex_unlock(&mutex);
 
-    if (q == &exit_message)
-      break;
-
-    w = QUEUE_DATA(q, struct uv__work, wq);
     w->work(w);
 
+    uv_mutex_lock(&mutex);
+    classes[c].running--;
+    classes[c].completed++;
+    uv_mutex_unlock(&mutex);
+
     uv_mutex_lock(&w->loop->wq_mutex);
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
                         executing. */
@@ -100,10 +350,13 @@ static void worker(void* arg) {
 }
 
 
-static void post(QUEUE* q) {
+static void post(uv_req_t* req, uv_threadpool_class_t cls) {
   uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
+  set_queued_at(req, uv_hrtime());
+  QUEUE_INSERT_TAIL(&classes[cls].wq, REQ_QUEUE(req));
   uv_cond_signal(&cond);
+  if (monitor_started)
+    uv_cond_signal(&monitor_cond);
   uv_mutex_unlock(&mutex);
 }
 
@@ -115,72 +368,103 @@ UV_DESTRUCTOR(static void cleanup(void)) {
   if (initialized == 0)
     return;
 
-  post(&exit_message);
+  uv_mutex_lock(&mutex);
+  exiting = 1;
+  uv_cond_signal(&cond);
+  uv_cond_signal(&monitor_cond);
+  uv_mutex_unlock(&mutex);
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
+  if (monitor_started) {
+    if (uv_thread_join(&monitor_thread))
       abort();
+    monitor_started = 0;
+  }
 
-  if (threads != default_threads)
-    free(threads);
+  for (i = 0; i < ARRAY_SIZE(slots); i++) {
+    if (slots[i].state == SLOT_FREE)
+      continue;
+    if (uv_thread_join(&slots[i].thread))
+      abort();
+    slots[i].state = SLOT_FREE;
+  }
 
   uv_mutex_destroy(&mutex);
   uv_cond_destroy(&cond);
+  uv_cond_destroy(&monitor_cond);
 
-  threads = NULL;
   nthreads = 0;
+  exiting = 0;
   initialized = 0;
 }
 #endif
 
 
-static void init_once(void) {
-  unsigned int i;
+static unsigned int threadpool_size_from_env(const char* name,
+                                             unsigned int default_size) {
+  unsigned int size;
   const char* val;
 
-  nthreads = ARRAY_SIZE(default_threads);
-  val = getenv("UV_THREADPOOL_SIZE");
+  size = default_size;
+  val = getenv(name);
   if (val != NULL)
-    nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
-
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
-    }
-  }
+    size = atoi(val);
+  if (size == 0)
+    size = 1;
+  if (size > MAX_THREADPOOL_SIZE)
+    size = MAX_THREADPOOL_SIZE;
+
+  return size;
+}
+
+
+static void init_once(void) {
+  unsigned int i;
+
+  /* UV_THREADPOOL_MAX_SIZE makes the pool elastic, it then starts with
+   * UV_THREADPOOL_SIZE threads and grows up to UV_THREADPOOL_MAX_SIZE.
+   */
+  min_threads = threadpool_size_from_env("UV_THREADPOOL_SIZE", 4);
+  max_threads = threadpool_size_from_env("UV_THREADPOOL_MAX_SIZE",
+                                         min_threads);
+  if (max_threads < min_threads)
+    max_threads = min_threads;
+  spawn_threshold = DEFAULT_SPAWN_THRESHOLD * (uint64_t) 1e6;
+  idle_timeout = DEFAULT_IDLE_TIMEOUT * (uint64_t) 1e6;
 
   if (uv_cond_init(&cond))
     abort();
 
+  if (uv_cond_init(&monitor_cond))
+    abort();
+
   if (uv_mutex_init(&mutex))
     abort();
 
-  QUEUE_INIT(&wq);
+  for (i = 0; i < ARRAY_SIZE(classes); i++)
+    QUEUE_INIT(&classes[i].wq);
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
+  for (i = 0; i < min_threads; i++)
+    if (spawn_thread())
       abort();
 
+  start_monitor();
+
   initialized = 1;
 }
 
 
 void uv__work_submit(uv_loop_t* loop,
+                     uv_req_t* req,
                      struct uv__work* w,
+                     uv_threadpool_class_t cls,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
+  assert(req_work(req) == w);
   uv_once(&once, init_once);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  post(req, cls);
 }
 
 
@@ -190,9 +474,9 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
   uv_mutex_lock(&mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
-  cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
+  cancelled = w->work != NULL && !QUEUE_EMPTY(REQ_QUEUE(req));
   if (cancelled)
-    QUEUE_REMOVE(&w->wq);
+    QUEUE_REMOVE(REQ_QUEUE(req));
 
   uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
@@ -262,14 +546,114 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_class(loop,
+                             req,
+                             UV_THREADPOOL_USER,
+                             work_cb,
+                             after_work_cb);
+}
+
+
+int uv_queue_work_class(uv_loop_t* loop,
+                        uv_work_t* req,
+                        uv_threadpool_class_t cls,
+                        uv_work_cb work_cb,
+                        uv_after_work_cb after_work_cb) {
   if (work_cb == NULL)
     return UV_EINVAL;
 
+  if ((unsigned int) cls >= UV_THREADPOOL_CLASS_MAX)
+    return UV_EINVAL;
+
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop,
+                  (uv_req_t*) req,
+                  &req->work_req,
+                  cls,
+                  uv__queue_work,
+                  uv__queue_done);
+  return 0;
+}
+
+
+int uv_threadpool_set_class(uv_threadpool_class_t cls,
+                            unsigned int limit,
+                            int priority) {
+  if ((unsigned int) cls >= UV_THREADPOOL_CLASS_MAX)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+  classes[cls].limit = limit;
+  classes[cls].priority = priority;
+  /* Raising a limit can make queued requests runnable. */
+  uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
+int uv_threadpool_set_size(unsigned int min_size,
+                           unsigned int max_size,
+                           uint64_t spawn_delay,
+                           uint64_t idle_time) {
+  int err;
+
+  if (min_size == 0 || min_size > max_size || max_size > MAX_THREADPOOL_SIZE)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+
+  min_threads = min_size;
+  max_threads = max_size;
+  spawn_threshold = spawn_delay * (uint64_t) 1e6;
+  idle_timeout = idle_time * (uint64_t) 1e6;
+
+  err = 0;
+  while (nthreads < min_threads && err == 0)
+    err = spawn_thread();
+
+  start_monitor();
+
+  /* Idle threads above the new limits exit, the others restart their idle
+   * timeout.
+   */
+  uv_cond_broadcast(&cond);
+  uv_cond_signal(&monitor_cond);
+  uv_mutex_unlock(&mutex);
+
+  return err;
+}
+
+
+int uv_threadpool_get_stats(uv_threadpool_class_t cls,
+                            uv_threadpool_stats_t* stats) {
+  QUEUE* q;
+
+  if ((unsigned int) cls >= UV_THREADPOOL_CLASS_MAX)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+  stats->limit = classes[cls].limit;
+  stats->priority = classes[cls].priority;
+  stats->queued = 0;
+  QUEUE_FOREACH(q, &classes[cls].wq)
+    stats->queued++;
+  stats->running = classes[cls].running;
+  stats->completed = classes[cls].completed;
+  stats->wait_time = classes[cls].wait_time;
+  stats->max_wait_time = classes[cls].max_wait_time;
+  stats->concurrency = max_threads;
+  if (classes[cls].limit != 0 && classes[cls].limit < max_threads)
+    stats->concurrency = classes[cls].limit;
+  uv_mutex_unlock(&mutex);
+
   return 0;
 }
 
@@ -97,7 +97,14 @@
 #define POST                                                                  \
   do {                                                                        \
     if ((cb) != NULL) {                                                       \
-      uv__work_submit((loop), &(req)->work_req, uv__fs_work, uv__fs_done);    \
+      if (uv__fs_iou_submit((loop), (req)) == 0)                              \
+        return 0;                                                             \
+      uv__work_submit((loop),                                                 \
+                      (uv_req_t*) (req),                                      \
+                      &(req)->work_req,                                       \
+                      UV_THREADPOOL_FS,                                       \
+                      uv__fs_work,                                            \
+                      uv__fs_done);                                           \
       return 0;                                                               \
     }                                                                         \
     else {                                                                    \
@@ -108,6 +115,12 @@
   }                                                                           \
   while (0)
 
+#if defined(__linux__)
+static int uv__fs_iou_submit(uv_loop_t* loop, uv_fs_t* req);
+#else
+# define uv__fs_iou_submit(loop, req) (-1)
+#endif
+
 
 static ssize_t uv__fs_fdatasync(uv_fs_t* req) {
 #if defined(__linux__) || defined(__sun) || defined(__NetBSD__)
@@ -836,6 +849,177 @@ static void uv__fs_done(struct uv__work* w, int status) {
 }
 
 
+#if defined(__linux__)
+static uint64_t uv__fs_makedev(uint32_t major, uint32_t minor) {
+  /* Same encoding as glibc's makedev(). */
+  return ((uint64_t) (major & 0xfffff000) << 32) |
+         ((uint64_t) (major & 0x00000fff) << 8) |
+         ((uint64_t) (minor & 0xffffff00) << 12) |
+         ((uint64_t) (minor & 0x000000ff));
+}
+
+
+static void uv__statx_to_stat(const struct uv__statx* src, uv_stat_t* dst) {
+  dst->st_dev = uv__fs_makedev(src->stx_dev_major, src->stx_dev_minor);
+  dst->st_mode = src->stx_mode;
+  dst->st_nlink = src->stx_nlink;
+  dst->st_uid = src->stx_uid;
+  dst->st_gid = src->stx_gid;
+  dst->st_rdev = uv__fs_makedev(src->stx_rdev_major, src->stx_rdev_minor);
+  dst->st_ino = src->stx_ino;
+  dst->st_size = src->stx_size;
+  dst->st_blksize = src->stx_blksize;
+  dst->st_blocks = src->stx_blocks;
+  dst->st_atim.tv_sec = src->stx_atime.tv_sec;
+  dst->st_atim.tv_nsec = src->stx_atime.tv_nsec;
+  dst->st_mtim.tv_sec = src->stx_mtime.tv_sec;
+  dst->st_mtim.tv_nsec = src->stx_mtime.tv_nsec;
+  dst->st_ctim.tv_sec = src->stx_ctime.tv_sec;
+  dst->st_ctim.tv_nsec = src->stx_ctime.tv_nsec;
+  /* Match uv__to_stat(), which has no birth time on Linux. */
+  dst->st_birthtim.tv_sec = src->stx_ctime.tv_sec;
+  dst->st_birthtim.tv_nsec = src->stx_ctime.tv_nsec;
+  dst->st_flags = 0;
+  dst->st_gen = 0;
+}
+
+
+/* Try to run the request on the loop's io_uring instead of the threadpool.
+ * Returns 0 when submitted, -1 when the caller should use the threadpool.
+ */
+static int uv__fs_iou_submit(uv_loop_t* loop, uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__statx* statxbuf;
+  int opcode;
+
+  statxbuf = NULL;
+
+  switch (req->fs_type) {
+  case UV_FS_READ: opcode = UV__IORING_OP_READV; break;
+  case UV_FS_WRITE: opcode = UV__IORING_OP_WRITEV; break;
+  case UV_FS_FSYNC: opcode = UV__IORING_OP_FSYNC; break;
+  case UV_FS_FDATASYNC: opcode = UV__IORING_OP_FSYNC; break;
+  case UV_FS_OPEN: opcode = UV__IORING_OP_OPENAT; break;
+  case UV_FS_STAT:
+  case UV_FS_LSTAT:
+  case UV_FS_FSTAT:
+    opcode = UV__IORING_OP_STATX;
+    statxbuf = malloc(sizeof(*statxbuf));
+    if (statxbuf == NULL)
+      return -1;
+    break;
+  default:
+    return -1;
+  }
+
+  sqe = uv__iou_get_sqe(loop, opcode);
+  if (sqe == NULL) {
+    free(statxbuf);
+    return -1;
+  }
+
+  switch (req->fs_type) {
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    sqe->fd = req->file;
+    sqe->addr = (uintptr_t) req->bufs;
+    sqe->len = req->nbufs;
+    /* -1 reads from or writes to the current file position. */
+    sqe->off = req->off < 0 ? (uint64_t) -1 : (uint64_t) req->off;
+    break;
+  case UV_FS_FSYNC:
+    sqe->fd = req->file;
+    break;
+  case UV_FS_FDATASYNC:
+    sqe->fd = req->file;
+    sqe->op_flags = UV__IORING_FSYNC_DATASYNC;
+    break;
+  case UV_FS_OPEN:
+    sqe->fd = UV__AT_FDCWD;
+    sqe->addr = (uintptr_t) req->path;
+    sqe->len = req->mode;
+    sqe->op_flags = req->flags | O_CLOEXEC;
+    break;
+  case UV_FS_STAT:
+  case UV_FS_LSTAT:
+    sqe->fd = UV__AT_FDCWD;
+    sqe->addr = (uintptr_t) req->path;
+    sqe->len = UV__STATX_BASIC_STATS;
+    sqe->off = (uintptr_t) statxbuf;
+    if (req->fs_type == UV_FS_LSTAT)
+      sqe->op_flags = UV__AT_SYMLINK_NOFOLLOW;
+    break;
+  case UV_FS_FSTAT:
+    sqe->fd = req->file;
+    sqe->addr = (uintptr_t) "";
+    sqe->len = UV__STATX_BASIC_STATS;
+    sqe->off = (uintptr_t) statxbuf;
+    sqe->op_flags = UV__AT_EMPTY_PATH;
+    break;
+  default:
+    abort();
+  }
+
+  sqe->user_data = (uintptr_t) req;
+  req->ptr = statxbuf;
+
+  /* Not on the threadpool's queue, uv_cancel() returns UV_EBUSY. */
+  req->work_req.loop = loop;
+  req->work_req.work = NULL;
+  QUEUE_INIT(&req->work_req.wq);
+
+  return 0;
+}
+
+
+void uv__fs_iou_done(uv_fs_t* req, int result) {
+  switch (req->fs_type) {
+  case UV_FS_STAT:
+  case UV_FS_LSTAT:
+  case UV_FS_FSTAT:
+    if (result == 0)
+      uv__statx_to_stat(req->ptr, &req->statbuf);
+    free(req->ptr);
+    req->ptr = NULL;
+    break;
+  default:
+    break;
+  }
+
+  /* The kernel can hand back EAGAIN, e.g. when it is short on memory, or for
+   * non-blocking descriptors.  Let the threadpool deal with it, it handles
+   * those cases the way it always has.
+   */
+  if (result == -EAGAIN || result == -EINTR) {
+    uv__work_submit(req->loop,
+                    (uv_req_t*) req,
+                    &req->work_req,
+                    UV_THREADPOOL_FS,
+                    uv__fs_work,
+                    uv__fs_done);
+    return;
+  }
+
+  if (req->fs_type == UV_FS_READ || req->fs_type == UV_FS_WRITE) {
+    if (req->bufs != req->bufsml)
+      free(req->bufs);
+  }
+
+  req->result = result;
+  if (result == 0 && (req->fs_type == UV_FS_STAT ||
+                      req->fs_type == UV_FS_FSTAT ||
+                      req->fs_type == UV_FS_LSTAT)) {
+    req->ptr = &req->statbuf;
+  }
+
+  uv__req_unregister(req->loop, req);
+
+  if (req->cb != NULL)
+    req->cb(req);
+}
+#endif  /* defined(__linux__) */
+
+
 int uv_fs_access(uv_loop_t* loop,
                  uv_fs_t* req,
                  const char* path,
@@ -225,6 +225,14 @@ int uv__platform_loop_init(uv_loop_t* loop);
 void uv__platform_loop_delete(uv_loop_t* loop);
 void uv__platform_invalidate_fd(uv_loop_t* loop, int fd);
 
+#if defined(__linux__)
+/* io_uring */
+struct uv__io_uring_sqe* uv__iou_get_sqe(uv_loop_t* loop, int opcode);
+void uv__iou_flush(uv_loop_t* loop);
+void uv__iou_delete(uv_loop_t* loop);
+void uv__fs_iou_done(uv_fs_t* req, int result);
+#endif
+
 /* various */
 void uv__async_close(uv_async_t* handle);
 void uv__check_close(uv_check_t* handle);
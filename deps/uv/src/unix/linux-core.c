@@ -101,6 +101,7 @@ int uv__platform_loop_init(uv_loop_t* loop) {
 
 
 void uv__platform_loop_delete(uv_loop_t* loop) {
+  uv__iou_delete(loop);
   if (loop->inotify_fd == -1) return;
   uv__io_stop(loop, &loop->inotify_read_watcher, UV__POLLIN);
   uv__close(loop->inotify_fd);
@@ -154,6 +155,9 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   int op;
   int i;
 
+  /* Submit the io_uring requests queued since the last iteration. */
+  uv__iou_flush(loop);
+
   if (loop->nfds == 0) {
     assert(QUEUE_EMPTY(&loop->watcher_queue));
     return;
@@ -0,0 +1,444 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+/* Optional io_uring backend for file system requests.  The ring is created
+ * lazily, per loop, the first time a request tries to use it.  When the
+ * kernel doesn't support io_uring, or lacks one of the operations, callers
+ * fall back to the threadpool.
+ *
+ * uv_loop_t has no room for the ring and growing it would change the ABI,
+ * so the rings live in a list keyed by loop.  Loops can run on different
+ * threads, the list is guarded by a mutex.  When the backend is disabled,
+ * the default, nothing ever takes that mutex.
+ */
+
+#include "uv.h"
+#include "internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <sys/mman.h>
+
+#define UV__IOU_ENTRIES 64
+
+STATIC_ASSERT(sizeof(struct uv__io_uring_params) == 120);
+STATIC_ASSERT(sizeof(struct uv__io_uring_sqe) == 64);
+STATIC_ASSERT(sizeof(struct uv__io_uring_cqe) == 16);
+STATIC_ASSERT(sizeof(struct uv__statx) == 256);
+
+struct uv__iou {
+  uv_loop_t* loop;
+  struct uv__iou* next;
+  int fd;
+  uv__io_t watcher;
+  /* Submission queue. */
+  uint32_t* sqhead;
+  uint32_t* sqtail;
+  uint32_t* sqarray;
+  uint32_t sqmask;
+  uint32_t sqentries;
+  struct uv__io_uring_sqe* sqes;
+  /* Completion queue. */
+  uint32_t* cqhead;
+  uint32_t* cqtail;
+  uint32_t cqmask;
+  uint32_t cqentries;
+  struct uv__io_uring_cqe* cqes;
+  /* Mappings, for munmap(). */
+  void* sq;
+  size_t sqlen;
+  void* cq;
+  size_t cqlen;
+  size_t sqeslen;
+  uint32_t tail;          /* Local tail, ahead of *sqtail until flushed. */
+  unsigned int inflight;  /* Queued or submitted, not yet reaped. */
+  unsigned char ops[UV__IORING_OP_STATX + 1];
+};
+
+
+static uv_once_t uv__iou_once = UV_ONCE_INIT;
+static uv_mutex_t uv__iou_mutex;
+static struct uv__iou* uv__iou_list;
+static int uv__iou_enabled;
+
+
+static void uv__iou_reap(uv_loop_t* loop, uv__io_t* w, unsigned int events);
+static void uv__iou_submit(struct uv__iou* iou);
+
+
+static void uv__iou_init_once(void) {
+  const char* val;
+
+  if (uv_mutex_init(&uv__iou_mutex))
+    abort();
+
+  val = getenv("UV_USE_IO_URING");
+  uv__iou_enabled = val != NULL && atoi(val) != 0;
+}
+
+
+/* Must be called with uv__iou_mutex held. */
+static struct uv__iou** uv__iou_find(uv_loop_t* loop) {
+  struct uv__iou** p;
+
+  for (p = &uv__iou_list; *p != NULL; p = &(*p)->next)
+    if ((*p)->loop == loop)
+      break;
+
+  return p;
+}
+
+
+/* Returns the loop's ring, or NULL when it doesn't have one. */
+static struct uv__iou* uv__iou_lookup(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  uv_once(&uv__iou_once, uv__iou_init_once);
+  if (!uv__iou_enabled)
+    return NULL;
+
+  uv_mutex_lock(&uv__iou_mutex);
+  iou = *uv__iou_find(loop);
+  uv_mutex_unlock(&uv__iou_mutex);
+
+  return iou;
+}
+
+
+static int uv__iou_probe(struct uv__iou* iou) {
+  struct uv__io_uring_probe* probe;
+  unsigned int i;
+  int op;
+
+  probe = calloc(1, sizeof(*probe));
+  if (probe == NULL)
+    return -1;
+
+  if (uv__io_uring_register(iou->fd,
+                            UV__IORING_REGISTER_PROBE,
+                            probe,
+                            ARRAY_SIZE(probe->ops)) == -1) {
+    free(probe);
+    return -1;
+  }
+
+  for (i = 0; i < probe->ops_len && i < ARRAY_SIZE(probe->ops); i++) {
+    op = probe->ops[i].op;
+    if (op < (int) ARRAY_SIZE(iou->ops))
+      iou->ops[op] = !!(probe->ops[i].flags & UV__IO_URING_OP_SUPPORTED);
+  }
+
+  free(probe);
+  return 0;
+}
+
+
+static void uv__iou_unmap(struct uv__iou* iou) {
+  if (iou->sqes != NULL)
+    munmap(iou->sqes, iou->sqeslen);
+  if (iou->cq != NULL && iou->cq != iou->sq)
+    munmap(iou->cq, iou->cqlen);
+  if (iou->sq != NULL)
+    munmap(iou->sq, iou->sqlen);
+  iou->sqes = NULL;
+  iou->cq = NULL;
+  iou->sq = NULL;
+}
+
+
+static int uv__iou_setup(uv_loop_t* loop, struct uv__iou* iou) {
+  struct uv__io_uring_params params;
+  void* sq;
+  void* cq;
+  void* sqes;
+  uint32_t i;
+  int fd;
+
+  memset(&params, 0, sizeof(params));
+  fd = uv__io_uring_setup(UV__IOU_ENTRIES, &params);
+  if (fd == -1)
+    return -1;
+
+  uv__cloexec(fd, 1);
+  iou->fd = fd;
+
+  /* Reading at the current file position needs IORING_FEAT_RW_CUR_POS
+   * (Linux 5.6), the same release that added IORING_REGISTER_PROBE and the
+   * openat and statx operations.  Don't bother with anything older.
+   */
+  if (!(params.features & UV__IORING_FEAT_RW_CUR_POS))
+    return -1;
+
+  if (uv__iou_probe(iou))
+    return -1;
+
+  iou->sqlen = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  iou->cqlen = params.cq_off.cqes +
+               params.cq_entries * sizeof(struct uv__io_uring_cqe);
+  iou->sqeslen = params.sq_entries * sizeof(struct uv__io_uring_sqe);
+
+  if (params.features & UV__IORING_FEAT_SINGLE_MMAP) {
+    if (iou->cqlen > iou->sqlen)
+      iou->sqlen = iou->cqlen;
+    iou->cqlen = iou->sqlen;
+  }
+
+  sq = mmap(NULL,
+            iou->sqlen,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            fd,
+            UV__IORING_OFF_SQ_RING);
+  if (sq == MAP_FAILED)
+    return -1;
+  iou->sq = sq;
+
+  cq = sq;
+  if (!(params.features & UV__IORING_FEAT_SINGLE_MMAP)) {
+    cq = mmap(NULL,
+              iou->cqlen,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              fd,
+              UV__IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED)
+      return -1;
+  }
+  iou->cq = cq;
+
+  sqes = mmap(NULL,
+              iou->sqeslen,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              fd,
+              UV__IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+    return -1;
+  iou->sqes = sqes;
+
+  iou->sqhead = (uint32_t*) ((char*) sq + params.sq_off.head);
+  iou->sqtail = (uint32_t*) ((char*) sq + params.sq_off.tail);
+  iou->sqarray = (uint32_t*) ((char*) sq + params.sq_off.array);
+  iou->sqmask = *(uint32_t*) ((char*) sq + params.sq_off.ring_mask);
+  iou->sqentries = *(uint32_t*) ((char*) sq + params.sq_off.ring_entries);
+
+  iou->cqhead = (uint32_t*) ((char*) cq + params.cq_off.head);
+  iou->cqtail = (uint32_t*) ((char*) cq + params.cq_off.tail);
+  iou->cqmask = *(uint32_t*) ((char*) cq + params.cq_off.ring_mask);
+  iou->cqentries = *(uint32_t*) ((char*) cq + params.cq_off.ring_entries);
+  iou->cqes = (struct uv__io_uring_cqe*) ((char*) cq + params.cq_off.cqes);
+  iou->tail = *iou->sqtail;
+
+  /* Submission queue entries map one-to-one to array slots. */
+  for (i = 0; i < iou->sqentries; i++)
+    iou->sqarray[i] = i;
+
+  uv__io_init(&iou->watcher, uv__iou_reap, fd);
+  uv__io_start(loop, &iou->watcher, UV__POLLIN);
+
+  return 0;
+}
+
+
+static struct uv__iou* uv__iou_get(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  iou = uv__iou_lookup(loop);
+  if (iou != NULL || !uv__iou_enabled)
+    return iou;
+
+  iou = calloc(1, sizeof(*iou));
+  if (iou == NULL)
+    return NULL;
+
+  iou->loop = loop;
+  iou->fd = -1;
+
+  if (uv__iou_setup(loop, iou)) {
+    /* Unsupported.  Keep the (empty) struct around so subsequent requests
+     * go straight to the threadpool.
+     */
+    uv__iou_unmap(iou);
+    if (iou->fd != -1)
+      uv__close(iou->fd);
+    iou->fd = -1;
+  }
+
+  uv_mutex_lock(&uv__iou_mutex);
+  iou->next = uv__iou_list;
+  uv__iou_list = iou;
+  uv_mutex_unlock(&uv__iou_mutex);
+
+  return iou;
+}
+
+
+static int uv__iou_full(struct uv__iou* iou) {
+  uint32_t head;
+
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+  return iou->tail - head == iou->sqentries;
+}
+
+
+struct uv__io_uring_sqe* uv__iou_get_sqe(uv_loop_t* loop, int opcode) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__iou* iou;
+
+  iou = uv__iou_get(loop);
+  if (iou == NULL || iou->fd == -1)
+    return NULL;
+
+  if (opcode < 0 || opcode >= (int) ARRAY_SIZE(iou->ops) || !iou->ops[opcode])
+    return NULL;
+
+  /* Never have more requests in flight than the completion queue can hold,
+   * the kernel would have to drop or buffer completions.
+   */
+  if (iou->inflight >= iou->cqentries)
+    return NULL;
+
+  if (uv__iou_full(iou))
+    uv__iou_submit(iou);
+
+  if (uv__iou_full(iou))
+    return NULL;
+
+  sqe = &iou->sqes[iou->tail & iou->sqmask];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+
+  iou->tail++;
+  iou->inflight++;
+
+  return sqe;
+}
+
+
+/* Hands the queued entries to the kernel.  The ring has no SQPOLL thread,
+ * so entries that io_uring_enter() didn't consume, because it failed with
+ * EAGAIN, EBUSY or ENOMEM, or only took some of them, are still ours.  They
+ * are taken back and go to the threadpool: leaving them in the ring could
+ * hang the loop, nothing would wake it up to retry.
+ */
+static void uv__iou_submit(struct uv__iou* iou) {
+  struct uv__io_uring_sqe* sqe;
+  uint32_t pending;
+  uint32_t head;
+  int r;
+
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+  pending = iou->tail - head;
+  if (pending == 0)
+    return;
+
+  /* Publish the new entries before telling the kernel about them. */
+  __atomic_store_n(iou->sqtail, iou->tail, __ATOMIC_RELEASE);
+
+  do
+    r = uv__io_uring_enter(iou->fd, pending, 0, 0);
+  while (r == -1 && errno == EINTR);
+
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+  if (head == iou->tail)
+    return;
+
+  pending = iou->tail;
+  iou->tail = head;
+  __atomic_store_n(iou->sqtail, head, __ATOMIC_RELEASE);
+
+  for (; head != pending; head++) {
+    sqe = &iou->sqes[head & iou->sqmask];
+    iou->inflight--;
+    uv__fs_iou_done((uv_fs_t*) (uintptr_t) sqe->user_data, -EAGAIN);
+  }
+}
+
+
+void uv__iou_flush(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  iou = uv__iou_lookup(loop);
+  if (iou == NULL || iou->fd == -1)
+    return;
+
+  uv__iou_submit(iou);
+}
+
+
+static void uv__iou_reap(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
+  struct uv__io_uring_cqe cqe;
+  struct uv__iou* iou;
+  uint32_t head;
+  uint32_t tail;
+
+  iou = container_of(w, struct uv__iou, watcher);
+
+  for (;;) {
+    head = *iou->cqhead;
+    tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+    if (head == tail)
+      break;
+
+    /* Copy the entry and release the slot before running the callback, the
+     * callback may start new requests.
+     */
+    cqe = iou->cqes[head & iou->cqmask];
+    __atomic_store_n(iou->cqhead, head + 1, __ATOMIC_RELEASE);
+    iou->inflight--;
+
+    uv__fs_iou_done((uv_fs_t*) (uintptr_t) cqe.user_data, cqe.res);
+  }
+
+  uv__iou_submit(iou);
+}
+
+
+void uv__iou_delete(uv_loop_t* loop) {
+  struct uv__iou** p;
+  struct uv__iou* iou;
+
+  uv_once(&uv__iou_once, uv__iou_init_once);
+  if (!uv__iou_enabled)
+    return;
+
+  uv_mutex_lock(&uv__iou_mutex);
+  p = uv__iou_find(loop);
+  iou = *p;
+  if (iou != NULL)
+    *p = iou->next;
+  uv_mutex_unlock(&uv__iou_mutex);
+
+  if (iou == NULL)
+    return;
+
+  if (iou->fd != -1) {
+    uv__io_stop(loop, &iou->watcher, UV__POLLIN);
+    uv__iou_unmap(iou);
+    uv__close(iou->fd);
+  }
+
+  free(iou);
+}
@@ -107,7 +107,9 @@ void uv__fs_poll_close(uv_fs_poll_t* handle);
 int uv__getaddrinfo_translate_error(int sys_err);    /* EAI_* error. */
 
 void uv__work_submit(uv_loop_t* loop,
+                     uv_req_t* req,
                      struct uv__work *w,
+                     uv_threadpool_class_t cls,
                      void (*work)(struct uv__work *w),
                      void (*done)(struct uv__work *w, int status));
 
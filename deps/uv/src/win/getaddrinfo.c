@@ -344,7 +344,9 @@ int uv_getaddrinfo(uv_loop_t* loop,
 
   if (getaddrinfo_cb) {
     uv__work_submit(loop,
+                    (uv_req_t*) req,
                     &req->work_req,
+                    UV_THREADPOOL_DNS,
                     uv__getaddrinfo_work,
                     uv__getaddrinfo_done);
     return 0;
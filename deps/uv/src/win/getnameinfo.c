@@ -139,7 +139,9 @@ int uv_getnameinfo(uv_loop_t* loop,
 
   if (getnameinfo_cb) {
     uv__work_submit(loop,
+                    (uv_req_t*) req,
                     &req->work_req,
+                    UV_THREADPOOL_DNS,
                     uv__getnameinfo_work,
                     uv__getnameinfo_done);
     return 0;
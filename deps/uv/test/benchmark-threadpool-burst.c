@@ -0,0 +1,141 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_BURSTS 20
+#define BURST_SIZE 200
+#define BURST_INTERVAL 50  /* ms */
+#define SLOW_EVERY 4  /* One in this many requests blocks like a cold read. */
+#define SLOW_TIME 5  /* ms */
+
+struct burst_req {
+  uv_work_t req;
+  uint64_t start;
+  int slow;
+};
+
+static struct burst_req reqs[NUM_BURSTS * BURST_SIZE];
+static uint64_t latencies[NUM_BURSTS * BURST_SIZE];
+static unsigned int num_queued;
+static unsigned int num_done;
+static uv_timer_t timer_handle;
+
+
+static void work_cb(uv_work_t* req) {
+  struct burst_req* r = container_of(req, struct burst_req, req);
+  uint64_t until;
+
+  if (r->slow) {
+    uv_sleep(SLOW_TIME);
+    return;
+  }
+
+  /* About 20 us of work, like a stat() from the page cache. */
+  until = uv_hrtime() + 20000;
+  while (uv_hrtime() < until)
+    ;  /* Spin. */
+}
+
+
+static void after_work_cb(uv_work_t* req, int status) {
+  struct burst_req* r = container_of(req, struct burst_req, req);
+
+  ASSERT(status == 0);
+  latencies[num_done++] = uv_hrtime() - r->start;
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  struct burst_req* r;
+  unsigned int i;
+
+  for (i = 0; i < BURST_SIZE; i++) {
+    r = reqs + num_queued;
+    r->slow = num_queued % SLOW_EVERY == 0;
+    r->start = uv_hrtime();
+    ASSERT(0 == uv_queue_work(handle->loop, &r->req, work_cb, after_work_cb));
+    num_queued++;
+  }
+
+  if (num_queued == ARRAY_SIZE(reqs))
+    uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static int compare_latencies(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*) a;
+  uint64_t y = *(const uint64_t*) b;
+  return x < y ? -1 : x > y;
+}
+
+
+static double percentile(double p) {
+  return latencies[(size_t) (p * (ARRAY_SIZE(latencies) - 1))] / 1e6;
+}
+
+
+static int run_bursts(const char* name) {
+  uv_loop_t* loop;
+  uint64_t start_time;
+  double duration;
+
+  loop = uv_default_loop();
+  start_time = uv_hrtime();
+
+  ASSERT(0 == uv_timer_init(loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 0, BURST_INTERVAL));
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(num_done == ARRAY_SIZE(reqs));
+
+  duration = (uv_hrtime() - start_time) / 1e9;
+  qsort(latencies, ARRAY_SIZE(latencies), sizeof(latencies[0]),
+        compare_latencies);
+
+  printf("%s: %u requests in %.2f seconds, latency p50 %.2f ms, "
+         "p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+         name,
+         (unsigned int) ARRAY_SIZE(reqs),
+         duration,
+         percentile(0.50),
+         percentile(0.90),
+         percentile(0.99),
+         percentile(1.00));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+BENCHMARK_IMPL(threadpool_burst_fixed) {
+  ASSERT(0 == uv_threadpool_set_size(4, 4, 0, 0));
+  return run_bursts("threadpool_burst_fixed");
+}
+
+
+BENCHMARK_IMPL(threadpool_burst_elastic) {
+  ASSERT(0 == uv_threadpool_set_size(4, 64, 1, 1000));
+  return run_bursts("threadpool_burst_elastic");
+}
@@ -0,0 +1,204 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Runs the requests that have an io_uring implementation back to back with
+ * UV_USE_IO_URING=1.  On kernels without io_uring support they take the
+ * threadpool path, the results must be the same either way.
+ */
+
+#ifdef __linux__
+
+static uv_loop_t loop;
+static uv_fs_t req;
+static uv_file file;
+static uv_stat_t sync_stat;
+static char buf[32];
+static uv_buf_t iov[2];
+static int step;
+
+static void next(uv_fs_t* req);
+
+
+static void start(int fs_type) {
+  int r;
+
+  step = fs_type;
+  switch (fs_type) {
+  case UV_FS_OPEN:
+    r = uv_fs_open(&loop, &req, "test_file", O_RDWR | O_CREAT | O_TRUNC,
+                   S_IWUSR | S_IRUSR, next);
+    break;
+  case UV_FS_WRITE:
+    iov[0] = uv_buf_init("hello ", 6);
+    iov[1] = uv_buf_init("io_uring\n", 9);
+    r = uv_fs_write(&loop, &req, file, iov, 2, 0, next);
+    break;
+  case UV_FS_FSYNC:
+    r = uv_fs_fsync(&loop, &req, file, next);
+    break;
+  case UV_FS_FDATASYNC:
+    r = uv_fs_fdatasync(&loop, &req, file, next);
+    break;
+  case UV_FS_READ:
+    /* Offset -1 reads from the current position, which is still zero. */
+    memset(buf, 0, sizeof(buf));
+    iov[0] = uv_buf_init(buf, 6);
+    iov[1] = uv_buf_init(buf + 6, sizeof(buf) - 6);
+    r = uv_fs_read(&loop, &req, file, iov, 2, -1, next);
+    break;
+  case UV_FS_FSTAT:
+    r = uv_fs_fstat(&loop, &req, file, next);
+    break;
+  case UV_FS_STAT:
+    r = uv_fs_stat(&loop, &req, "test_file", next);
+    break;
+  case UV_FS_LSTAT:
+    r = uv_fs_lstat(&loop, &req, "test_file", next);
+    break;
+  default:
+    r = uv_fs_close(&loop, &req, file, next);
+    break;
+  }
+  ASSERT(r == 0);
+}
+
+
+static void check_stat(const uv_stat_t* s) {
+  ASSERT(s->st_dev == sync_stat.st_dev);
+  ASSERT(s->st_ino == sync_stat.st_ino);
+  ASSERT(s->st_mode == sync_stat.st_mode);
+  ASSERT(s->st_nlink == sync_stat.st_nlink);
+  ASSERT(s->st_uid == sync_stat.st_uid);
+  ASSERT(s->st_gid == sync_stat.st_gid);
+  ASSERT(s->st_size == 15);
+  ASSERT(s->st_blksize == sync_stat.st_blksize);
+  ASSERT(s->st_mtim.tv_sec == sync_stat.st_mtim.tv_sec);
+  ASSERT(s->st_mtim.tv_nsec == sync_stat.st_mtim.tv_nsec);
+  ASSERT(s->st_ctim.tv_sec == sync_stat.st_ctim.tv_sec);
+  ASSERT(s->st_ctim.tv_nsec == sync_stat.st_ctim.tv_nsec);
+}
+
+
+static void next(uv_fs_t* r) {
+  uv_fs_t sync_req;
+
+  ASSERT(r == &req);
+  ASSERT(req.fs_type == step);
+
+  switch (step) {
+  case UV_FS_OPEN:
+    ASSERT(req.result >= 0);
+    file = req.result;
+    uv_fs_req_cleanup(&req);
+    start(UV_FS_WRITE);
+    break;
+  case UV_FS_WRITE:
+    ASSERT(req.result == 15);
+    uv_fs_req_cleanup(&req);
+    start(UV_FS_FSYNC);
+    break;
+  case UV_FS_FSYNC:
+    ASSERT(req.result == 0);
+    uv_fs_req_cleanup(&req);
+    start(UV_FS_FDATASYNC);
+    break;
+  case UV_FS_FDATASYNC:
+    ASSERT(req.result == 0);
+    uv_fs_req_cleanup(&req);
+    start(UV_FS_READ);
+    break;
+  case UV_FS_READ:
+    ASSERT(req.result == 15);
+    ASSERT(strcmp(buf, "hello io_uring\n") == 0);
+    uv_fs_req_cleanup(&req);
+    ASSERT(0 == uv_fs_fstat(&loop, &sync_req, file, NULL));
+    sync_stat = sync_req.statbuf;
+    uv_fs_req_cleanup(&sync_req);
+    start(UV_FS_FSTAT);
+    break;
+  case UV_FS_FSTAT:
+  case UV_FS_STAT:
+  case UV_FS_LSTAT:
+    ASSERT(req.result == 0);
+    ASSERT(req.ptr == &req.statbuf);
+    check_stat(&req.statbuf);
+    uv_fs_req_cleanup(&req);
+    start(step == UV_FS_FSTAT ? UV_FS_STAT :
+          step == UV_FS_STAT ? UV_FS_LSTAT :
+          UV_FS_CLOSE);
+    break;
+  default:
+    ASSERT(req.result == 0);
+    uv_fs_req_cleanup(&req);
+    step = -1;
+    break;
+  }
+}
+
+
+static void error_cb(uv_fs_t* req) {
+  ASSERT(req->result == UV_ENOENT);
+  ASSERT(req->ptr == NULL);
+  uv_fs_req_cleanup(req);
+  step++;
+}
+
+#endif  /* __linux__ */
+
+
+TEST_IMPL(fs_io_uring) {
+#ifdef __linux__
+  uv_fs_t reqs[3];
+
+  ASSERT(0 == setenv("UV_USE_IO_URING", "1", 1));
+  unlink("test_file");
+
+  ASSERT(0 == uv_loop_init(&loop));
+  start(UV_FS_OPEN);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(step == -1);
+
+  /* Errors are reported like they are for the threadpool. */
+  step = 0;
+  ASSERT(0 == uv_fs_open(&loop, &reqs[0], "no_such_file", O_RDONLY, 0,
+                         error_cb));
+  ASSERT(0 == uv_fs_stat(&loop, &reqs[1], "no_such_file", error_cb));
+  ASSERT(0 == uv_fs_lstat(&loop, &reqs[2], "no_such_file", error_cb));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(step == 3);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  unlink("test_file");
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#else
+  RETURN_SKIP("io_uring is Linux only.");
+#endif
+}
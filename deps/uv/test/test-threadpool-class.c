@@ -0,0 +1,210 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+
+static uv_mutex_t mutex;
+static int running;
+static int max_running;
+static int after_work_cb_count;
+
+static uv_sem_t started;
+static uv_sem_t release;
+static uv_work_t* order[2];
+static int order_count;
+
+
+/* Same as what the threadpool does with UV_THREADPOOL_SIZE. */
+static unsigned int threadpool_size(void) {
+  const char* val;
+  int size;
+
+  val = getenv("UV_THREADPOOL_SIZE");
+  size = val != NULL ? atoi(val) : 4;
+  if (size < 1)
+    size = 1;
+  if (size > 128)
+    size = 128;
+  return size;
+}
+
+
+static void after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  after_work_cb_count++;
+}
+
+
+static void limited_work_cb(uv_work_t* req) {
+  uv_mutex_lock(&mutex);
+  if (++running > max_running)
+    max_running = running;
+  uv_mutex_unlock(&mutex);
+
+  uv_sleep(5);
+
+  uv_mutex_lock(&mutex);
+  running--;
+  uv_mutex_unlock(&mutex);
+}
+
+
+static void blocking_work_cb(uv_work_t* req) {
+  uv_sem_post(&started);
+  uv_sem_wait(&release);
+}
+
+
+static void ordered_work_cb(uv_work_t* req) {
+  uv_mutex_lock(&mutex);
+  ASSERT(order_count < (int) ARRAY_SIZE(order));
+  order[order_count++] = req;
+  uv_mutex_unlock(&mutex);
+}
+
+
+TEST_IMPL(threadpool_class_einval) {
+  uv_threadpool_stats_t stats;
+  uv_work_t req;
+
+  ASSERT(UV_EINVAL == uv_queue_work_class(uv_default_loop(),
+                                          &req,
+                                          UV_THREADPOOL_CLASS_MAX,
+                                          limited_work_cb,
+                                          after_work_cb));
+  ASSERT(UV_EINVAL == uv_threadpool_set_class(UV_THREADPOOL_CLASS_MAX, 1, 0));
+  ASSERT(UV_EINVAL == uv_threadpool_get_stats(UV_THREADPOOL_CLASS_MAX,
+                                              &stats));
+
+  ASSERT(0 == uv_threadpool_get_stats(UV_THREADPOOL_USER, &stats));
+  ASSERT(stats.limit == 0);
+  ASSERT(stats.priority == 0);
+  ASSERT(stats.queued == 0);
+  ASSERT(stats.running == 0);
+  ASSERT(stats.completed == 0);
+  ASSERT(stats.concurrency == threadpool_size());
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_class_limit) {
+  uv_threadpool_stats_t stats;
+  uv_work_t reqs[8];
+  unsigned int i;
+
+  ASSERT(0 == uv_mutex_init(&mutex));
+  ASSERT(0 == uv_threadpool_set_class(UV_THREADPOOL_USER, 1, 0));
+
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    ASSERT(0 == uv_queue_work(uv_default_loop(),
+                              reqs + i,
+                              limited_work_cb,
+                              after_work_cb));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(after_work_cb_count == (int) ARRAY_SIZE(reqs));
+  ASSERT(max_running == 1);
+
+  ASSERT(0 == uv_threadpool_get_stats(UV_THREADPOOL_USER, &stats));
+  ASSERT(stats.limit == 1);
+  ASSERT(stats.concurrency == 1);
+  ASSERT(stats.queued == 0);
+  ASSERT(stats.running == 0);
+  ASSERT(stats.completed == ARRAY_SIZE(reqs));
+  /* The last request waited for all of the others to finish. */
+  ASSERT(stats.max_wait_time >= 5 * 1000000);
+  ASSERT(stats.wait_time >= stats.max_wait_time);
+
+  uv_mutex_destroy(&mutex);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_class_priority) {
+  uv_work_t blockers[128];
+  uv_work_t low;
+  uv_work_t high;
+  unsigned int nthreads;
+  unsigned int i;
+
+  ASSERT(0 == uv_mutex_init(&mutex));
+  ASSERT(0 == uv_sem_init(&started, 0));
+  ASSERT(0 == uv_sem_init(&release, 0));
+
+  /* Keep all of the threads busy so the next requests have to queue up. */
+  nthreads = threadpool_size();
+  for (i = 0; i < nthreads; i++) {
+    ASSERT(0 == uv_queue_work_class(uv_default_loop(),
+                                    blockers + i,
+                                    UV_THREADPOOL_CPU,
+                                    blocking_work_cb,
+                                    after_work_cb));
+  }
+  for (i = 0; i < nthreads; i++)
+    uv_sem_wait(&started);
+
+  ASSERT(0 == uv_threadpool_set_class(UV_THREADPOOL_FS, 0, 1));
+  ASSERT(0 == uv_queue_work_class(uv_default_loop(),
+                                  &low,
+                                  UV_THREADPOOL_USER,
+                                  ordered_work_cb,
+                                  after_work_cb));
+  ASSERT(0 == uv_queue_work_class(uv_default_loop(),
+                                  &high,
+                                  UV_THREADPOOL_FS,
+                                  ordered_work_cb,
+                                  after_work_cb));
+
+  /* A single thread runs both, the one with the higher priority goes first
+   * even though it was queued last.
+   */
+  uv_sem_post(&release);
+  for (;;) {
+    uv_mutex_lock(&mutex);
+    i = order_count;
+    uv_mutex_unlock(&mutex);
+    if (i == 2)
+      break;
+    uv_sleep(1);
+  }
+  ASSERT(order[0] == &high);
+  ASSERT(order[1] == &low);
+
+  for (i = 1; i < nthreads; i++)
+    uv_sem_post(&release);
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(after_work_cb_count == (int) nthreads + 2);
+
+  uv_sem_destroy(&started);
+  uv_sem_destroy(&release);
+  uv_mutex_destroy(&mutex);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
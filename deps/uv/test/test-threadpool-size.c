@@ -0,0 +1,85 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#define NUM_REQS 8
+
+static uv_sem_t started;
+static uv_sem_t release;
+static int after_work_cb_count;
+
+
+static void blocking_work_cb(uv_work_t* req) {
+  uv_sem_post(&started);
+  uv_sem_wait(&release);
+}
+
+
+static void after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  after_work_cb_count++;
+}
+
+
+TEST_IMPL(threadpool_set_size_einval) {
+  ASSERT(UV_EINVAL == uv_threadpool_set_size(0, 4, 0, 0));
+  ASSERT(UV_EINVAL == uv_threadpool_set_size(2, 1, 0, 0));
+  ASSERT(UV_EINVAL == uv_threadpool_set_size(1, 129, 0, 0));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_set_size_grow) {
+  uv_work_t reqs[NUM_REQS];
+  unsigned int i;
+
+  ASSERT(0 == uv_sem_init(&started, 0));
+  ASSERT(0 == uv_sem_init(&release, 0));
+
+  /* Shrink to a single thread, then allow the pool to grow again. */
+  ASSERT(0 == uv_threadpool_set_size(1, 1, 0, 0));
+  ASSERT(0 == uv_threadpool_set_size(1, NUM_REQS, 0, 1000));
+
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    ASSERT(0 == uv_queue_work(uv_default_loop(),
+                              reqs + i,
+                              blocking_work_cb,
+                              after_work_cb));
+
+  /* All of them only run at the same time when the pool grew. */
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    uv_sem_wait(&started);
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    uv_sem_post(&release);
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(after_work_cb_count == NUM_REQS);
+
+  uv_sem_destroy(&started);
+  uv_sem_destroy(&release);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -199,6 +199,7 @@
           'sources': [
             'src/unix/linux-core.c',
             'src/unix/linux-inotify.c',
+            'src/unix/linux-iouring.c',
             'src/unix/linux-syscalls.c',
             'src/unix/linux-syscalls.h',
           ],
@@ -210,6 +211,7 @@
           'sources': [
             'src/unix/linux-core.c',
             'src/unix/linux-inotify.c',
+            'src/unix/linux-iouring.c',
             'src/unix/linux-syscalls.c',
             'src/unix/linux-syscalls.h',
             'src/unix/pthread-fixes.c',
@@ -298,6 +300,7 @@
         'test/test-emfile.c',
         'test/test-fail-always.c',
         'test/test-fs.c',
+        'test/test-fs-io-uring.c',
         'test/test-fs-event.c',
         'test/test-get-currentexe.c',
         'test/test-get-memory.c',
@@ -371,6 +374,8 @@
         'test/test-tcp-write-queue-order.c',
         'test/test-threadpool.c',
         'test/test-threadpool-cancel.c',
+        'test/test-threadpool-class.c',
+        'test/test-threadpool-size.c',
         'test/test-thread-equal.c',
         'test/test-mutexes.c',
         'test/test-thread.c',
@@ -452,6 +457,7 @@
         'test/benchmark-sizes.c',
         'test/benchmark-spawn.c',
         'test/benchmark-thread.c',
+        'test/benchmark-threadpool-burst.c',
         'test/benchmark-tcp-write-batch.c',
         'test/benchmark-udp-pummel.c',
         'test/dns-server.c',
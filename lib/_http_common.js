@@ -20,12 +20,10 @@ const kOnHeaders = HTTPParser.kOnHeaders | 0;
 const kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
 const kOnBody = HTTPParser.kOnBody | 0;
 const kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+const kOnMessages = HTTPParser.kOnMessages | 0;
 
-// Only called in the slow case where slow means
-// that the request headers were either fragmented
-// across multiple TCP packets or too large to be
-// processed in a single run. This method is also
-// called to process trailing HTTP headers.
+// Only called to process trailing HTTP headers, the headers of the message
+// itself are all passed to parserOnHeadersComplete().
 function parserOnHeaders(headers, url) {
   // Once we exceeded headers limit - stop collecting them
   if (this.maxHeaderPairs <= 0 ||
@@ -140,6 +138,44 @@ function parserOnMessageComplete() {
   readStart(parser.socket);
 }
 
+// Request parsers call this once per execute() with the events of all the
+// messages in the buffer, in the order the parser saw them:
+//   kOnHeadersComplete, <the arguments of parserOnHeadersComplete()>
+//   kOnBody, start, len
+//   kOnMessageComplete, trailers
+function parserOnMessages(events, b) {
+  var parser = this;
+  var i = 0;
+  while (i < events.length) {
+    switch (events[i]) {
+      case kOnHeadersComplete:
+        parserOnHeadersComplete.call(parser,
+                                     events[i + 1], events[i + 2],
+                                     events[i + 3], events[i + 4],
+                                     events[i + 5], events[i + 6],
+                                     events[i + 7], events[i + 8],
+                                     events[i + 9]);
+        i += 10;
+        break;
+
+      case kOnBody:
+        parserOnBody.call(parser, b, events[i + 1], events[i + 2]);
+        i += 3;
+        break;
+
+      case kOnMessageComplete:
+        if (events[i + 1] !== undefined)
+          parserOnHeaders.call(parser, events[i + 1], '');
+        parserOnMessageComplete.call(parser);
+        i += 2;
+        break;
+
+      default:
+        throw new Error('Unknown parser event: ' + events[i]);
+    }
+  }
+}
+
 
 var parsers = new FreeList('parsers', 1000, function() {
   var parser = new HTTPParser(HTTPParser.REQUEST);
@@ -156,6 +192,7 @@ var parsers = new FreeList('parsers', 1000, function() {
   parser[kOnHeadersComplete] = parserOnHeadersComplete;
   parser[kOnBody] = parserOnBody;
   parser[kOnMessageComplete] = parserOnMessageComplete;
+  parser[kOnMessages] = parserOnMessages;
 
   return parser;
 });
@@ -2,6 +2,10 @@
 
 const util = require('util');
 const Stream = require('stream');
+const HTTPParser = process.binding('http_parser').HTTPParser;
+
+// Maps the common header names the parser interns to their lowercase form.
+const lowercaseHeaders = HTTPParser.knownHeaders;
 
 function readStart(socket) {
   if (socket && !socket._paused && socket.readable)
@@ -126,7 +130,7 @@ IncomingMessage.prototype._addHeaderLines = function(headers, n) {
 // and drop the second. Extended header fields (those beginning with 'x-') are
 // always joined.
 IncomingMessage.prototype._addHeaderLine = function(field, value, dest) {
-  field = field.toLowerCase();
+  field = lowercaseHeaders[field] || field.toLowerCase();
   switch (field) {
     // Array headers:
     case 'set-cookie':
@@ -6,17 +6,21 @@ const timers = require('timers');
 const util = require('util');
 const common = require('_http_common');
 
+const binding = process.binding('http_parser');
+
 const CRLF = common.CRLF;
-const chunkExpression = common.chunkExpression;
 const debug = common.debug;
 
-const connectionExpression = /^Connection$/i;
-const transferEncodingExpression = /^Transfer-Encoding$/i;
-const closeExpression = /close/i;
-const contentLengthExpression = /^Content-Length$/i;
-const dateExpression = /^Date$/i;
-const expectExpression = /^Expect$/i;
-const trailerExpression = /^Trailer$/i;
+const formatHeaders = binding.formatHeaders;
+const kSentConnection = binding.kSentConnection;
+const kConnectionClose = binding.kConnectionClose;
+const kConnectionKeepAlive = binding.kConnectionKeepAlive;
+const kSentTransferEncoding = binding.kSentTransferEncoding;
+const kChunked = binding.kChunked;
+const kSentContentLength = binding.kSentContentLength;
+const kSentDate = binding.kSentDate;
+const kSentExpect = binding.kSentExpect;
+const kSentTrailer = binding.kSentTrailer;
 
 const automaticHeaders = {
   connection: true,
@@ -130,7 +134,8 @@ OutgoingMessage.prototype._writeRaw = function(data, encoding, callback) {
     encoding = null;
   }
 
-  if (data.length === 0) {
+  // Empty buffers tagged by net._sendFileChunk() still have to go out.
+  if (data.length === 0 && !data._sendFile) {
     if (typeof callback === 'function')
       process.nextTick(callback);
     return true;
@@ -181,15 +186,7 @@ OutgoingMessage.prototype._buffer = function(data, encoding, callback) {
 OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
   // firstLine in the case of request is: 'GET /index.html HTTP/1.1\r\n'
   // in the case of response it is: 'HTTP/1.1 200 OK\r\n'
-  var state = {
-    sentConnectionHeader: false,
-    sentContentLengthHeader: false,
-    sentTransferEncodingHeader: false,
-    sentDateHeader: false,
-    sentExpect: false,
-    sentTrailer: false,
-    messageHeader: firstLine
-  };
+  var list = [];
 
   if (headers) {
     var keys = Object.keys(headers);
@@ -208,17 +205,30 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
 
       if (Array.isArray(value)) {
         for (var j = 0; j < value.length; j++) {
-          storeHeader(this, state, field, value[j]);
+          list.push('' + field, '' + value[j]);
         }
       } else {
-        storeHeader(this, state, field, value);
+        list.push('' + field, '' + value);
       }
     }
   }
 
+  // Writes the header lines and strips CR and LF from the values to protect
+  // against response splitting.
+  var result = formatHeaders('' + firstLine, list);
+  var messageHeader = result[0];
+  var flags = result[1];
+
+  if (flags & kConnectionClose)
+    this._last = true;
+  if (flags & kConnectionKeepAlive)
+    this.shouldKeepAlive = true;
+  if (flags & kChunked)
+    this.chunkedEncoding = true;
+
   // Date header
-  if (this.sendDate === true && state.sentDateHeader === false) {
-    state.messageHeader += 'Date: ' + utcDate() + CRLF;
+  if (this.sendDate === true && (flags & kSentDate) === 0) {
+    messageHeader += 'Date: ' + utcDate() + CRLF;
   }
 
   // Force the connection to close when the response is a 204 No Content or
@@ -245,34 +255,32 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
   if (this._removedHeader.connection) {
     this._last = true;
     this.shouldKeepAlive = false;
-  } else if (state.sentConnectionHeader === false) {
+  } else if ((flags & kSentConnection) === 0) {
     var shouldSendKeepAlive = this.shouldKeepAlive &&
-        (state.sentContentLengthHeader ||
+        ((flags & kSentContentLength) !== 0 ||
          this.useChunkedEncodingByDefault ||
          this.agent);
     if (shouldSendKeepAlive) {
-      state.messageHeader += 'Connection: keep-alive\r\n';
+      messageHeader += 'Connection: keep-alive\r\n';
     } else {
       this._last = true;
-      state.messageHeader += 'Connection: close\r\n';
+      messageHeader += 'Connection: close\r\n';
     }
   }
 
-  if (state.sentContentLengthHeader === false &&
-      state.sentTransferEncodingHeader === false) {
+  if ((flags & (kSentContentLength | kSentTransferEncoding)) === 0) {
     if (!this._hasBody) {
       // Make sure we don't end the 0\r\n\r\n at the end of the message.
       this.chunkedEncoding = false;
     } else if (!this.useChunkedEncodingByDefault) {
       this._last = true;
     } else {
-      if (!state.sentTrailer &&
+      if ((flags & kSentTrailer) === 0 &&
           !this._removedHeader['content-length'] &&
           typeof this._contentLength === 'number') {
-        state.messageHeader += 'Content-Length: ' + this._contentLength +
-                               '\r\n';
+        messageHeader += 'Content-Length: ' + this._contentLength + '\r\n';
       } else if (!this._removedHeader['transfer-encoding']) {
-        state.messageHeader += 'Transfer-Encoding: chunked\r\n';
+        messageHeader += 'Transfer-Encoding: chunked\r\n';
         this.chunkedEncoding = true;
       } else {
         // We should only be able to get here if both Content-Length and
@@ -283,44 +291,14 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
     }
   }
 
-  this._header = state.messageHeader + CRLF;
+  this._header = messageHeader + CRLF;
   this._headerSent = false;
 
   // wait until the first body chunk, or close(), is sent to flush,
   // UNLESS we're sending Expect: 100-continue.
-  if (state.sentExpect) this._send('');
+  if (flags & kSentExpect) this._send('');
 };
 
-function storeHeader(self, state, field, value) {
-  // Protect against response splitting. The if statement is there to
-  // minimize the performance impact in the common case.
-  if (/[\r\n]/.test(value))
-    value = value.replace(/[\r\n]+[ \t]*/g, '');
-
-  state.messageHeader += field + ': ' + value + CRLF;
-
-  if (connectionExpression.test(field)) {
-    state.sentConnectionHeader = true;
-    if (closeExpression.test(value)) {
-      self._last = true;
-    } else {
-      self.shouldKeepAlive = true;
-    }
-
-  } else if (transferEncodingExpression.test(field)) {
-    state.sentTransferEncodingHeader = true;
-    if (chunkExpression.test(value)) self.chunkedEncoding = true;
-
-  } else if (contentLengthExpression.test(field)) {
-    state.sentContentLengthHeader = true;
-  } else if (dateExpression.test(field)) {
-    state.sentDateHeader = true;
-  } else if (expectExpression.test(field)) {
-    state.sentExpect = true;
-  } else if (trailerExpression.test(field)) {
-    state.sentTrailer = true;
-  }
-}
 
 
 OutgoingMessage.prototype.setHeader = function(name, value) {
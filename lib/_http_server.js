@@ -151,6 +151,39 @@ ServerResponse.prototype._implicitHeader = function() {
   this.writeHead(this.statusCode);
 };
 
+// Sends |length| bytes of the file |fd|, starting at |offset|, as the body of
+// the response and ends it.  Sets Content-Length unless the headers have been
+// written already.
+ServerResponse.prototype.sendFile = function(fd, offset, length, callback) {
+  var chunk = net._sendFileChunk(fd, offset, length);
+
+  if (this.finished)
+    return false;
+
+  if (!this._header) {
+    if (this._hasBody) {
+      this._contentLength = length;
+    } else if (this.getHeader('content-length') === undefined) {
+      // A HEAD response has no body but still describes the one of a GET
+      this.setHeader('Content-Length', length);
+    }
+    this._implicitHeader();
+  }
+
+  if (this._hasBody && length > 0) {
+    if (this.chunkedEncoding) {
+      this._send(length.toString(16) + CRLF, 'binary', null);
+      this._send(chunk, null, null);
+      this._send(CRLF, 'binary', null);
+    } else {
+      this._send(chunk, null, null);
+    }
+  }
+
+  return this.end(callback);
+};
+
+
 ServerResponse.prototype.writeHead = function(statusCode, reason, obj) {
   var headers;
 
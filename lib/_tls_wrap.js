@@ -92,6 +92,14 @@ function loadSNI(self, servername, cb) {
   if (!servername || !self._SNICallback)
     return cb(null);
 
+  // The names from server.addContext() are picked by the servername
+  // callback of OpenSSL, only ask JS about the others
+  if (self.server) {
+    var ctx = self.server._sharedCreds.context.getSNIContext(servername);
+    if (ctx)
+      return cb(null, ctx);
+  }
+
   var once = false;
   self._SNICallback(servername, function(err, context) {
     if (once)
@@ -331,6 +339,11 @@ TLSSocket.prototype._init = function(socket, wrap) {
   if (requestCert || rejectUnauthorized)
     ssl.setVerifyMode(requestCert, rejectUnauthorized);
 
+  if (options.asyncCrypto)
+    ssl.enableAsyncCrypto();
+  if (options.dynamicRecordSizing)
+    ssl.enableDynamicRecordSizing();
+
   if (options.isServer) {
     ssl.onhandshakestart = onhandshakestart.bind(this);
     ssl.onhandshakedone = onhandshakedone.bind(this);
@@ -681,6 +694,11 @@ function Server(/* [options], listener */) {
     sharedCreds.context.setTicketKeys(self.ticketKeys);
   }
 
+  if (self.sharedSessionCache) {
+    sharedCreds.context.enableSharedSessionCache(self.sharedSessionCache.path,
+                                                 self.sharedSessionCache.size);
+  }
+
   // constructor call
   net.Server.call(this, function(raw_socket) {
     var socket = new TLSSocket(raw_socket, {
@@ -691,7 +709,9 @@ function Server(/* [options], listener */) {
       rejectUnauthorized: self.rejectUnauthorized,
       handshakeTimeout: timeout,
       NPNProtocols: self.NPNProtocols,
-      SNICallback: options.SNICallback || SNICallback
+      SNICallback: options.SNICallback || SNICallback,
+      asyncCrypto: self.asyncCrypto,
+      dynamicRecordSizing: self.dynamicRecordSizing
     });
 
     socket.on('secure', function() {
@@ -787,6 +807,19 @@ Server.prototype.setOptions = function(options) {
     this.honorCipherOrder = true;
   if (secureOptions) this.secureOptions = secureOptions;
   if (options.NPNProtocols) tls.convertNPNProtocols(options.NPNProtocols, this);
+  this.asyncCrypto = !!options.asyncCrypto;
+  this.dynamicRecordSizing = !!options.dynamicRecordSizing;
+  if (options.sharedSessionCache) {
+    var cache = options.sharedSessionCache;
+    if (typeof cache === 'string')
+      cache = { path: cache };
+    if (typeof cache.path !== 'string')
+      throw new TypeError('sharedSessionCache.path must be a string');
+    this.sharedSessionCache = {
+      path: cache.path,
+      size: cache.size >>> 0 || 4096
+    };
+  }
   if (options.sessionIdContext) {
     this.sessionIdContext = options.sessionIdContext;
   } else {
@@ -802,11 +835,18 @@ Server.prototype.addContext = function(servername, context) {
     throw new Error('Servername is required parameter for Server.addContext');
   }
 
+  var secureContext = tls.createSecureContext(context).context;
+
+  // Exact names and "*.domain" wildcards are looked up natively, without
+  // calling into JS during the handshake
+  if (this._sharedCreds.context.addSNIContext(servername, secureContext))
+    return;
+
   var re = new RegExp('^' +
                       servername.replace(/([\.^$+?\-\\[\]{}])/g, '\\$1')
                                 .replace(/\*/g, '[^\.]*') +
                       '$');
-  this._contexts.push([re, tls.createSecureContext(context).context]);
+  this._contexts.push([re, secureContext]);
 };
 
 function SNICallback(servername, callback) {
@@ -881,7 +921,9 @@ exports.connect = function(/* [port, host], options, cb */) {
     rejectUnauthorized: options.rejectUnauthorized,
     session: options.session,
     NPNProtocols: NPN.NPNProtocols,
-    requestOCSP: options.requestOCSP
+    requestOCSP: options.requestOCSP,
+    asyncCrypto: options.asyncCrypto,
+    dynamicRecordSizing: options.dynamicRecordSizing
   });
 
   if (cb)
@@ -10,6 +10,7 @@ const kMaxLength = smalloc.kMaxLength;
 
 exports.Buffer = Buffer;
 exports.SlowBuffer = SlowBuffer;
+exports.BufferSearcher = BufferSearcher;
 exports.INSPECT_MAX_BYTES = 50;
 
 
@@ -396,6 +397,59 @@ Buffer.prototype.indexOf = function indexOf(val, byteOffset) {
 };
 
 
+// A needle that is compiled once and can be searched for in many buffers,
+// or across the chunks of a stream.
+function BufferSearcher(needle, encoding) {
+  if (!(this instanceof BufferSearcher))
+    return new BufferSearcher(needle, encoding);
+
+  if (typeof needle === 'string')
+    needle = new Buffer(needle, encoding);
+  else if (!(needle instanceof Buffer))
+    throw new TypeError('needle must be a string or Buffer');
+
+  if (needle.length === 0)
+    throw new RangeError('needle must not be empty');
+
+  this._handle = new binding.BufferSearcher(needle);
+}
+
+
+BufferSearcher.prototype.search = function search(buf, byteOffset) {
+  if (!(buf instanceof Buffer))
+    throw new TypeError('Argument must be a Buffer');
+
+  if (byteOffset > 0x7fffffff)
+    byteOffset = 0x7fffffff;
+  else if (byteOffset < -0x80000000)
+    byteOffset = -0x80000000;
+  byteOffset >>= 0;
+
+  return this._handle.search(buf, byteOffset);
+};
+
+
+BufferSearcher.prototype.searchAll = function searchAll(buf) {
+  if (!(buf instanceof Buffer))
+    throw new TypeError('Argument must be a Buffer');
+
+  return this._handle.searchAll(buf);
+};
+
+
+BufferSearcher.prototype.push = function push(chunk) {
+  if (!(chunk instanceof Buffer))
+    throw new TypeError('Argument must be a Buffer');
+
+  return this._handle.push(chunk);
+};
+
+
+BufferSearcher.prototype.reset = function reset() {
+  this._handle.reset();
+};
+
+
 Buffer.prototype.fill = function fill(val, start, end) {
   start = start >> 0;
   end = (end === undefined) ? this.length : end >> 0;
@@ -105,6 +105,38 @@ Hash.prototype.digest = function(outputEncoding) {
 };
 
 
+exports.hash = function(algorithm, data, outputEncoding) {
+  outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
+  return binding.hash(algorithm, data, outputEncoding);
+};
+
+
+exports.hashMany = function(algorithm, inputs, outputEncoding, callback) {
+  if (typeof outputEncoding === 'function') {
+    callback = outputEncoding;
+    outputEncoding = undefined;
+  }
+
+  if (typeof callback !== 'function')
+    throw new Error('No callback provided to hashMany');
+  if (!Array.isArray(inputs))
+    throw new TypeError('inputs must be an array');
+
+  outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
+
+  if (inputs.length === 0) {
+    process.nextTick(function() {
+      callback(null, []);
+    });
+    return;
+  }
+
+  // The binding holds on to the buffers until they are hashed, a copy of
+  // the array can't be changed in the meantime
+  binding.hashMany(algorithm, inputs.slice(), outputEncoding, callback);
+};
+
+
 exports.createHmac = exports.Hmac = Hmac;
 
 function Hmac(hmac, key, options) {
@@ -161,6 +193,9 @@ Cipher.prototype._flush = function(callback) {
 };
 
 Cipher.prototype.update = function(data, inputEncoding, outputEncoding) {
+  if (inputEncoding instanceof Buffer)
+    return updateInto(this._handle, data, inputEncoding, outputEncoding);
+
   inputEncoding = inputEncoding || exports.DEFAULT_ENCODING;
   outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
 
@@ -175,6 +210,23 @@ Cipher.prototype.update = function(data, inputEncoding, outputEncoding) {
 };
 
 
+// update(input, output[, outputOffset]) writes into output, which must be
+// large enough for all of the input and a block of buffered data
+function updateInto(handle, input, output, outputOffset) {
+  if (!(input instanceof Buffer))
+    throw new TypeError('input must be a buffer when writing into output');
+
+  if (outputOffset === undefined)
+    outputOffset = 0;
+  else if (typeof outputOffset !== 'number' ||
+           outputOffset !== (outputOffset >>> 0) ||
+           outputOffset > output.length)
+    throw new RangeError('outputOffset is out of bounds');
+
+  return handle.updateInto(input, output, outputOffset);
+}
+
+
 Cipher.prototype.final = function(outputEncoding) {
   outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
   var ret = this._handle.final();
@@ -298,15 +350,29 @@ Sign.prototype._write = function(chunk, encoding, callback) {
 
 Sign.prototype.update = Hash.prototype.update;
 
-Sign.prototype.sign = function(options, encoding) {
+Sign.prototype.sign = function(options, encoding, callback) {
   if (!options)
     throw new Error('No key provided to sign');
 
+  if (typeof encoding === 'function') {
+    callback = encoding;
+    encoding = null;
+  }
+
   var key = options.key || options;
   var passphrase = options.passphrase || null;
+  encoding = encoding || exports.DEFAULT_ENCODING;
+
+  if (typeof callback === 'function') {
+    this._handle.sign(toBuf(key),
+                      null,
+                      passphrase,
+                      encodeResult(encoding, callback));
+    return;
+  }
+
   var ret = this._handle.sign(toBuf(key), null, passphrase);
 
-  encoding = encoding || exports.DEFAULT_ENCODING;
   if (encoding && encoding !== 'buffer')
     ret = ret.toString(encoding);
 
@@ -331,26 +397,39 @@ util.inherits(Verify, stream.Writable);
 Verify.prototype._write = Sign.prototype._write;
 Verify.prototype.update = Sign.prototype.update;
 
-Verify.prototype.verify = function(object, signature, sigEncoding) {
+Verify.prototype.verify = function(object, signature, sigEncoding, callback) {
+  if (typeof sigEncoding === 'function') {
+    callback = sigEncoding;
+    sigEncoding = null;
+  }
+
   sigEncoding = sigEncoding || exports.DEFAULT_ENCODING;
+  if (typeof callback === 'function') {
+    this._handle.verify(toBuf(object),
+                        toBuf(signature, sigEncoding),
+                        null,
+                        callback);
+    return;
+  }
+
   return this._handle.verify(toBuf(object), toBuf(signature, sigEncoding));
 };
 
 function rsaPublic(method, defaultPadding) {
-  return function(options, buffer) {
+  return function(options, buffer, callback) {
     var key = options.key || options;
     var padding = options.padding || defaultPadding;
     var passphrase = options.passphrase || null;
-    return method(toBuf(key), buffer, padding, passphrase);
+    return method(toBuf(key), buffer, padding, passphrase, callback);
   };
 }
 
 function rsaPrivate(method, defaultPadding) {
-  return function(options, buffer) {
+  return function(options, buffer, callback) {
     var key = options.key || options;
     var passphrase = options.passphrase || null;
     var padding = options.padding || defaultPadding;
-    return method(toBuf(key), buffer, padding, passphrase);
+    return method(toBuf(key), buffer, padding, passphrase, callback);
   };
 }
 
@@ -424,9 +503,19 @@ DiffieHellmanGroup.prototype.generateKeys =
     DiffieHellman.prototype.generateKeys =
     dhGenerateKeys;
 
-function dhGenerateKeys(encoding) {
-  var keys = this._handle.generateKeys();
+function dhGenerateKeys(encoding, callback) {
+  if (typeof encoding === 'function') {
+    callback = encoding;
+    encoding = null;
+  }
+
   encoding = encoding || exports.DEFAULT_ENCODING;
+  if (typeof callback === 'function') {
+    this._handle.generateKeys(encodeResult(encoding, callback));
+    return;
+  }
+
+  var keys = this._handle.generateKeys();
   if (encoding && encoding !== 'buffer')
     keys = keys.toString(encoding);
   return keys;
@@ -437,9 +526,23 @@ DiffieHellmanGroup.prototype.computeSecret =
     DiffieHellman.prototype.computeSecret =
     dhComputeSecret;
 
-function dhComputeSecret(key, inEnc, outEnc) {
+function dhComputeSecret(key, inEnc, outEnc, callback) {
+  if (typeof inEnc === 'function') {
+    callback = inEnc;
+    inEnc = null;
+  } else if (typeof outEnc === 'function') {
+    callback = outEnc;
+    outEnc = null;
+  }
+
   inEnc = inEnc || exports.DEFAULT_ENCODING;
   outEnc = outEnc || exports.DEFAULT_ENCODING;
+  if (typeof callback === 'function') {
+    this._handle.computeSecret(toBuf(key, inEnc),
+                               encodeResult(outEnc, callback));
+    return;
+  }
+
   var ret = this._handle.computeSecret(toBuf(key, inEnc));
   if (outEnc && outEnc !== 'buffer')
     ret = ret.toString(outEnc);
@@ -447,6 +550,18 @@ function dhComputeSecret(key, inEnc, outEnc) {
 }
 
 
+// Wraps the callback of an asynchronous operation to encode its result
+function encodeResult(encoding, callback) {
+  if (!encoding || encoding === 'buffer')
+    return callback;
+  return function(er, ret) {
+    if (ret)
+      ret = ret.toString(encoding);
+    callback(er, ret);
+  };
+}
+
+
 DiffieHellmanGroup.prototype.getPrime =
     DiffieHellman.prototype.getPrime =
     dhGetPrime;
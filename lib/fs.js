@@ -165,6 +165,92 @@ fs.Stats.prototype.isSocket = function() {
   return this._checkModeProperty(constants.S_IFSOCK);
 };
 
+// Fields in a Float64Array filled in by the binding, in the order of the
+// arguments of the fs.Stats constructor.
+var kStatsFields = ['dev', 'mode', 'nlink', 'uid', 'gid', 'rdev', 'blksize',
+                    'ino', 'size', 'blocks', 'atime', 'mtime', 'ctime',
+                    'birthtime'];
+var kStatsFieldCount = kStatsFields.length;
+
+function checkStatsValues(values, count) {
+  if (!(values instanceof Float64Array))
+    throw new TypeError('values must be a Float64Array');
+  if (values.length < count * kStatsFieldCount)
+    throw new RangeError('values is too short');
+}
+
+// A Stats object that reads its fields from a Float64Array when they are
+// accessed, so that nothing is allocated for the fields that are never
+// looked at.  The Date objects are created once, on first access.
+//
+// Unlike on other Stats objects the fields are accessors on the prototype,
+// not own properties, so Object.keys(), util._extend() and deepEqual() don't
+// see them until they are assigned; toJSON() returns a plain copy.  The
+// state is kept under a symbol so that it doesn't show up either.
+var kLazyState = Symbol('LazyStats state');
+
+function LazyStats(values, index) {
+  this[kLazyState] = {
+    values: values,
+    offset: index * kStatsFieldCount,
+    atime: undefined,
+    mtime: undefined,
+    ctime: undefined,
+    birthtime: undefined
+  };
+}
+util.inherits(LazyStats, fs.Stats);
+
+function defineLazyStatsField(name, i) {
+  var get;
+  if (i >= 10) {
+    get = function() {
+      var lazy = this[kLazyState];
+      if (lazy[name] === undefined)
+        lazy[name] = new Date(lazy.values[lazy.offset + i]);
+      return lazy[name];
+    };
+  } else if (isWindows && (name === 'blksize' || name === 'blocks')) {
+    get = function() {
+      return undefined;
+    };
+  } else {
+    get = function() {
+      var lazy = this[kLazyState];
+      return lazy.values[lazy.offset + i];
+    };
+  }
+
+  Object.defineProperty(LazyStats.prototype, name, {
+    configurable: true,
+    enumerable: true,
+    get: get,
+    set: function(value) {
+      // Assigned values stick, like they do on other Stats objects
+      Object.defineProperty(this, name, {
+        configurable: true, enumerable: true, writable: true, value: value
+      });
+    }
+  });
+}
+kStatsFields.forEach(defineLazyStatsField);
+
+LazyStats.prototype.toJSON = function() {
+  var result = {};
+  for (var i = 0; i < kStatsFieldCount; i++)
+    result[kStatsFields[i]] = this[kStatsFields[i]];
+  return result;
+};
+
+// Show the fields, not the backing array
+LazyStats.prototype.inspect = LazyStats.prototype.toJSON;
+
+fs.Stats.fromValues = function(values, index) {
+  index = index >>> 0;
+  checkStatsValues(values, index + 1);
+  return new LazyStats(values, index);
+};
+
 // Don't allow mode to accidentally be overwritten.
 ['F_OK', 'R_OK', 'W_OK', 'X_OK'].forEach(function(key) {
   Object.defineProperty(fs, key, {
@@ -794,17 +880,25 @@ fs.mkdirSync = function(path, mode) {
                        modeNum(mode, 0o777));
 };
 
-fs.readdir = function(path, callback) {
+fs.readdir = function(path, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = undefined;
+  }
+  var withTypes = !!(options && options.types);
   callback = makeCallback(callback);
   if (!nullCheck(path, callback)) return;
   var req = new FSReqWrap();
   req.oncomplete = callback;
-  binding.readdir(pathModule._makeLong(path), req);
+  binding.readdir(pathModule._makeLong(path), req, withTypes);
 };
 
-fs.readdirSync = function(path) {
+fs.readdirSync = function(path, options) {
   nullCheck(path);
-  return binding.readdir(pathModule._makeLong(path));
+  if (!(options && options.types))
+    return binding.readdir(pathModule._makeLong(path));
+  var result = binding.readdir(pathModule._makeLong(path), undefined, true);
+  return { names: result[0], types: result[1] };
 };
 
 fs.fstat = function(fd, callback) {
@@ -829,18 +923,55 @@ fs.stat = function(path, callback) {
   binding.stat(pathModule._makeLong(path), req);
 };
 
-fs.fstatSync = function(fd) {
-  return binding.fstat(fd);
+function statMany(paths, lstat, callback) {
+  callback = makeCallback(callback);
+  if (!Array.isArray(paths))
+    throw new TypeError('paths must be an array');
+
+  if (paths.length === 0) {
+    process.nextTick(function() {
+      callback(null, new Float64Array(0), []);
+    });
+    return;
+  }
+
+  if (isWindows)
+    paths = paths.map(pathModule._makeLong);
+  binding.statMany(paths, lstat, callback);
+}
+
+fs.statMany = function(paths, callback) {
+  statMany(paths, false, callback);
+};
+
+fs.lstatMany = function(paths, callback) {
+  statMany(paths, true, callback);
 };
 
-fs.lstatSync = function(path) {
+fs.fstatSync = function(fd, values) {
+  if (values === undefined)
+    return binding.fstat(fd);
+  checkStatsValues(values, 1);
+  binding.fstat(fd, undefined, values);
+  return values;
+};
+
+fs.lstatSync = function(path, values) {
   nullCheck(path);
-  return binding.lstat(pathModule._makeLong(path));
+  if (values === undefined)
+    return binding.lstat(pathModule._makeLong(path));
+  checkStatsValues(values, 1);
+  binding.lstat(pathModule._makeLong(path), undefined, values);
+  return values;
 };
 
-fs.statSync = function(path) {
+fs.statSync = function(path, values) {
   nullCheck(path);
-  return binding.stat(pathModule._makeLong(path));
+  if (values === undefined)
+    return binding.stat(pathModule._makeLong(path));
+  checkStatsValues(values, 1);
+  binding.stat(pathModule._makeLong(path), undefined, values);
+  return values;
 };
 
 fs.readlink = function(path, callback) {
@@ -1261,23 +1392,50 @@ fs.watch = function(filename) {
 
 // Stat Change Watchers
 
+// A plain Stats object, with its own fields, for the entry at |index|.
+function statsFromValues(values, index) {
+  var o = index * kStatsFieldCount;
+  return new fs.Stats(values[o],
+                      values[o + 1],
+                      values[o + 2],
+                      values[o + 3],
+                      values[o + 4],
+                      values[o + 5],
+                      isWindows ? undefined : values[o + 6],  // blksize
+                      values[o + 7],
+                      values[o + 8],
+                      isWindows ? undefined : values[o + 9],  // blocks
+                      values[o + 10],
+                      values[o + 11],
+                      values[o + 12],
+                      values[o + 13]);
+}
+
 function StatWatcher() {
   EventEmitter.call(this);
 
   var self = this;
-  this._handle = new binding.StatWatcher();
+  // The binding writes the current stats followed by the previous ones into
+  // this array on every change.
+  var values = new Float64Array(2 * kStatsFieldCount);
+  this._handle = new binding.StatWatcher(values);
 
   // uv_fs_poll is a little more powerful than ev_stat but we curb it for
   // the sake of backwards compatibility
   var oldStatus = -1;
 
-  this._handle.onchange = function(current, previous, newStatus) {
+  this._handle.onchange = function(newStatus) {
     if (oldStatus === -1 &&
         newStatus === -1 &&
-        current.nlink === previous.nlink) return;
+        values[2] === values[kStatsFieldCount + 2]) return;  // nlink
 
     oldStatus = newStatus;
-    self.emit('change', current, previous);
+    if (EventEmitter.listenerCount(self, 'change') === 0) return;
+    // The next change overwrites |values|, so the listeners get plain Stats
+    // objects with their own fields rather than views of the array.
+    self.emit('change',
+              statsFromValues(values, 0),
+              statsFromValues(values, 1));
   };
 
   this._handle.onstop = function() {
@@ -13,6 +13,7 @@ const TCPConnectWrap = process.binding('tcp_wrap').TCPConnectWrap;
 const PipeConnectWrap = process.binding('pipe_wrap').PipeConnectWrap;
 const ShutdownWrap = process.binding('stream_wrap').ShutdownWrap;
 const WriteWrap = process.binding('stream_wrap').WriteWrap;
+const SendFileWrap = process.binding('stream_wrap').SendFileWrap;
 
 
 var cluster;
@@ -628,6 +629,9 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
   this._pendingData = null;
   this._pendingEncoding = '';
 
+  if (writev ? hasSendFileChunk(data) : data._sendFile)
+    return writeWithFiles(this, writev ? data : [{ chunk: data }], cb);
+
   this._unrefTimer();
 
   if (!this._handle) {
@@ -687,6 +691,155 @@ Socket.prototype._write = function(data, encoding, cb) {
   this._writeGeneric(false, data, encoding, cb);
 };
 
+
+// Queues |length| bytes of the file |fd|, starting at |offset|, behind the
+// data written so far.  Plain TCP handles hand the range to sendfile(2),
+// other sockets (pipes, TLS) read it in chunks and write it out.
+Socket.prototype.sendFile = function(fd, offset, length, cb) {
+  return this.write(sendFileChunk(fd, offset, length), cb);
+};
+
+
+// The write queue only carries buffers, so a file range travels through it
+// as an empty buffer tagged with the range.  _writeGeneric() picks it out.
+function sendFileChunk(fd, offset, length) {
+  if (typeof fd !== 'number' || fd < 0 || (fd | 0) !== fd)
+    throw new TypeError('fd must be a file descriptor');
+  if (!isNonNegativeInteger(offset))
+    throw new TypeError('offset must be a non-negative integer');
+  if (!isNonNegativeInteger(length))
+    throw new TypeError('length must be a non-negative integer');
+
+  var chunk = new Buffer(0);
+  chunk._sendFile = { fd: fd, offset: offset, length: length };
+  return chunk;
+}
+exports._sendFileChunk = sendFileChunk;
+
+
+function isNonNegativeInteger(n) {
+  return typeof n === 'number' && n >= 0 && isFinite(n) &&
+         Math.floor(n) === n;
+}
+
+
+function hasSendFileChunk(entries) {
+  for (var i = 0; i < entries.length; i++) {
+    if (entries[i].chunk._sendFile)
+      return true;
+  }
+  return false;
+}
+
+
+// Writes |entries| in order: runs of ordinary chunks go out in one writev,
+// file ranges one at a time.
+function writeWithFiles(self, entries, cb) {
+  var index = 0;
+  next();
+
+  function next(err) {
+    if (err)
+      return cb(err);
+    if (index === entries.length)
+      return cb();
+
+    var file = entries[index].chunk._sendFile;
+    if (file) {
+      index++;
+      return sendFile(self, file, next);
+    }
+
+    var end = index;
+    while (end < entries.length && !entries[end].chunk._sendFile)
+      end++;
+    var batch = entries.slice(index, end);
+    index = end;
+    self._writeGeneric(true, batch, '', next);
+  }
+}
+
+
+function sendFile(self, file, cb) {
+  self._unrefTimer();
+
+  if (!self._handle) {
+    self._destroy(new Error('This socket is closed.'), cb);
+    return;
+  }
+
+  if (file.length === 0)
+    return cb();
+
+  if (typeof self._handle.sendFile !== 'function')
+    return sendFileByCopy(self, file, cb);
+
+  var req = new SendFileWrap();
+  req.oncomplete = afterSendFile;
+  req.handle = self._handle;
+  req.cb = cb;
+  var err = self._handle.sendFile(req, file.fd, file.offset, file.length);
+  if (err)
+    self._destroy(errnoException(err, 'sendfile'), cb);
+}
+
+
+function afterSendFile(status, req) {
+  var self = req.handle.owner;
+  debug('afterSendFile', status);
+
+  // callback may come after call to destroy.
+  if (self.destroyed)
+    return;
+
+  self._bytesDispatched += req.bytes;
+
+  if (status < 0) {
+    self._destroy(errnoException(status, 'sendfile'), req.cb);
+    return;
+  }
+
+  self._unrefTimer();
+  req.cb.call(self);
+}
+
+
+// Fallback for handles without sendfile support: a pread/write loop.
+const kSendFileChunkSize = 64 * 1024;
+
+function sendFileByCopy(self, file, cb) {
+  var fs = require('fs');
+  var offset = file.offset;
+  var remaining = file.length;
+  var buffer;
+  read();
+
+  function read() {
+    if (remaining === 0)
+      return cb();
+    var size = Math.min(remaining, kSendFileChunkSize);
+    buffer = new Buffer(size);
+    fs.read(file.fd, buffer, 0, size, offset, onread);
+  }
+
+  function onread(err, bytesRead) {
+    if (!err && bytesRead === 0)
+      err = errnoException(uv.UV_EOF, 'sendfile');
+    if (err)
+      return self._destroy(err, cb);
+
+    offset += bytesRead;
+    remaining -= bytesRead;
+    self._writeGeneric(false, buffer.slice(0, bytesRead), 'buffer', onwrite);
+  }
+
+  function onwrite(err) {
+    if (err)
+      return cb(err);
+    read();
+  }
+}
+
 function createWriteReq(req, handle, data, encoding) {
   switch (encoding) {
     case 'binary':
@@ -97,6 +97,31 @@ exports.createUnzip = function(o) {
 };
 
 
+// Checksums.
+// strings are checksummed as utf8, `initial` continues a previous checksum.
+exports.crc32 = function(data, initial) {
+  return checksum(binding.crc32, data, initial, 0);
+};
+
+exports.adler32 = function(data, initial) {
+  return checksum(binding.adler32, data, initial, 1);
+};
+
+function checksum(fn, data, initial, defaultInitial) {
+  if (typeof data === 'string')
+    data = new Buffer(data, 'utf8');
+  else if (!(data instanceof Buffer))
+    throw new TypeError('data must be a string or buffer');
+
+  if (initial === undefined)
+    initial = defaultInitial;
+  else if (typeof initial !== 'number')
+    throw new TypeError('initial must be a number');
+
+  return fn(data, initial >>> 0);
+}
+
+
 // Convenience methods.
 // compress/decompress a string or buffer in one step.
 exports.deflate = function(buffer, opts, callback) {
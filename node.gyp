@@ -96,6 +96,7 @@
       'sources': [
         'src/debug-agent.cc',
         'src/async-wrap.cc',
+        'src/chunk_pool.cc',
         'src/fs_event_wrap.cc',
         'src/cares_wrap.cc',
         'src/handle_wrap.cc',
@@ -104,6 +105,7 @@
         'src/node_buffer.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
+        'src/node_cpu_features.cc',
         'src/node_file.cc',
         'src/node_http_parser.cc',
         'src/node_javascript.cc',
@@ -113,12 +115,16 @@
         'src/node_stat_watcher.cc',
         'src/node_watchdog.cc',
         'src/node_zlib.cc',
+        'src/node_zlib_simd.cc',
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/smalloc.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
+        'src/string_bytes_simd.cc',
+        'src/string_search.cc',
         'src/stream_base.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
@@ -132,6 +138,7 @@
         'src/async-wrap-inl.h',
         'src/base-object.h',
         'src/base-object-inl.h',
+        'src/chunk_pool.h',
         'src/debug-agent.h',
         'src/env.h',
         'src/env-inl.h',
@@ -140,6 +147,7 @@
         'src/node.h',
         'src/node_buffer.h',
         'src/node_constants.h',
+        'src/node_cpu_features.h',
         'src/node_file.h',
         'src/node_http_parser.h',
         'src/node_internals.h',
@@ -150,6 +158,7 @@
         'src/node_wrap.h',
         'src/node_i18n.h',
         'src/pipe_wrap.h',
+        'src/slab_allocator.h',
         'src/smalloc.h',
         'src/tty_wrap.h',
         'src/tcp_wrap.h',
@@ -157,6 +166,9 @@
         'src/req-wrap.h',
         'src/req-wrap-inl.h',
         'src/string_bytes.h',
+        'src/string_bytes_simd.h',
+        'src/node_zlib_simd.h',
+        'src/string_search.h',
         'src/stream_base.h',
         'src/stream_base-inl.h',
         'src/stream_wrap.h',
@@ -200,9 +212,13 @@
             'src/node_crypto.cc',
             'src/node_crypto_bio.cc',
             'src/node_crypto_clienthello.cc',
+            'src/node_crypto_session_cache.cc',
+            'src/node_crypto_sni_map.cc',
             'src/node_crypto.h',
             'src/node_crypto_bio.h',
             'src/node_crypto_clienthello.h',
+            'src/node_crypto_session_cache.h',
+            'src/node_crypto_sni_map.h',
             'src/tls_wrap.cc',
             'src/tls_wrap.h'
           ],
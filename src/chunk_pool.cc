@@ -0,0 +1,44 @@
+#include "chunk_pool.h"
+#include "util.h"
+#include "util-inl.h"
+
+namespace node {
+
+ChunkPool::ChunkPool() : free_(nullptr), free_count_(0) {
+}
+
+
+ChunkPool::~ChunkPool() {
+  while (free_ != nullptr) {
+    FreeChunk* next = free_->next;
+    delete[] reinterpret_cast<char*>(free_);
+    free_ = next;
+  }
+  free_count_ = 0;
+}
+
+
+char* ChunkPool::Allocate() {
+  if (free_ == nullptr)
+    return new char[kChunkSize];
+
+  FreeChunk* chunk = free_;
+  free_ = chunk->next;
+  free_count_--;
+  return reinterpret_cast<char*>(chunk);
+}
+
+
+void ChunkPool::Release(char* chunk) {
+  if (free_count_ == kMaxFreeChunks) {
+    delete[] chunk;
+    return;
+  }
+
+  FreeChunk* free_chunk = reinterpret_cast<FreeChunk*>(chunk);
+  free_chunk->next = free_;
+  free_ = free_chunk;
+  free_count_++;
+}
+
+}  // namespace node
@@ -0,0 +1,45 @@
+#ifndef SRC_CHUNK_POOL_H_
+#define SRC_CHUNK_POOL_H_
+
+#include "util.h"
+
+#include <stddef.h>
+
+namespace node {
+
+// Freelist of fixed size memory chunks, used for the buffers of the TLS BIOs.
+//
+// A busy TLS connection allocates and frees a chunk for about every 16 kB
+// that goes through it, and every new connection starts with a fresh set of
+// them.  Released chunks are kept around, up to kMaxFreeChunks of them, and
+// handed out again by the next Allocate() of any connection in the same
+// environment.
+//
+// Not thread safe, only to be used from the thread that owns the environment.
+class ChunkPool {
+ public:
+  static const size_t kChunkSize = 16384;
+  static const size_t kMaxFreeChunks = 256;
+
+  ChunkPool();
+  ~ChunkPool();
+
+  // Returns kChunkSize bytes of uninitialized memory
+  char* Allocate();
+  // |chunk| must be the result of a call to Allocate()
+  void Release(char* chunk);
+
+ private:
+  struct FreeChunk {
+    FreeChunk* next;
+  };
+
+  FreeChunk* free_;
+  size_t free_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChunkPool);
+};
+
+}  // namespace node
+
+#endif  // SRC_CHUNK_POOL_H_
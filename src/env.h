@@ -2,9 +2,12 @@
 #define SRC_ENV_H_
 
 #include "ares.h"
+#include "chunk_pool.h"
 #include "debug-agent.h"
 #include "handle_wrap.h"
+#include "node_http_parser.h"
 #include "req-wrap.h"
+#include "slab_allocator.h"
 #include "tree.h"
 #include "util.h"
 #include "uv.h"
@@ -470,6 +473,18 @@ class Environment {
     return &debugger_agent_;
   }
 
+  inline SlabAllocator* read_slab_allocator() {
+    return &read_slab_allocator_;
+  }
+
+  inline HttpHeaderNames* http_header_names() {
+    return &http_header_names_;
+  }
+
+  inline ChunkPool* bio_chunk_pool() {
+    return &bio_chunk_pool_;
+  }
+
   typedef ListHead<HandleWrap, &HandleWrap::handle_wrap_queue_> HandleWrapQueue;
   typedef ListHead<ReqWrap<uv_req_t>, &ReqWrap<uv_req_t>::req_wrap_queue_>
           ReqWrapQueue;
@@ -505,6 +520,9 @@ class Environment {
   bool using_asyncwrap_;
   bool printed_error_;
   debugger::Agent debugger_agent_;
+  SlabAllocator read_slab_allocator_;
+  HttpHeaderNames http_header_names_;
+  ChunkPool bio_chunk_pool_;
 
   HandleWrapQueue handle_wrap_queue_;
   ReqWrapQueue req_wrap_queue_;
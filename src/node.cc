@@ -1949,6 +1949,68 @@ void MemoryUsage(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Same order as uv_threadpool_class_t
+static const char* const threadpool_class_names[] = {
+  "fs",
+  "cpu",
+  "dns",
+  "user"
+};
+
+
+void GetThreadpoolStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  static_assert(ARRAY_SIZE(threadpool_class_names) == UV_THREADPOOL_CLASS_MAX,
+                "threadpool_class_names doesn't match uv_threadpool_class_t");
+
+  Local<Object> result = Object::New(isolate);
+  for (int i = 0; i < UV_THREADPOOL_CLASS_MAX; i++) {
+    uv_threadpool_stats_t stats;
+    int err = uv_threadpool_get_stats(static_cast<uv_threadpool_class_t>(i),
+                                      &stats);
+    CHECK_EQ(err, 0);
+
+    // Wait times are reported in milliseconds, like the rest of the timers
+    Local<Object> info = Object::New(isolate);
+    info->Set(FIXED_ONE_BYTE_STRING(isolate, "concurrency"),
+              Integer::NewFromUnsigned(isolate, stats.limit));
+    info->Set(FIXED_ONE_BYTE_STRING(isolate, "priority"),
+              Integer::New(isolate, stats.priority));
+    info->Set(FIXED_ONE_BYTE_STRING(isolate, "queued"),
+              Integer::NewFromUnsigned(isolate, stats.queued));
+    info->Set(FIXED_ONE_BYTE_STRING(isolate, "running"),
+              Integer::NewFromUnsigned(isolate, stats.running));
+    info->Set(FIXED_ONE_BYTE_STRING(isolate, "completed"),
+              Number::New(isolate, static_cast<double>(stats.completed)));
+    info->Set(FIXED_ONE_BYTE_STRING(isolate, "waitTime"),
+              Number::New(isolate, stats.wait_time / 1e6));
+    info->Set(FIXED_ONE_BYTE_STRING(isolate, "maxWaitTime"),
+              Number::New(isolate, stats.max_wait_time / 1e6));
+
+    result->Set(OneByteString(isolate, threadpool_class_names[i]), info);
+  }
+
+  args.GetReturnValue().Set(result);
+}
+
+
+// args: class index, concurrency (0 for no limit), priority
+void SetThreadpoolClass(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsInt32());
+
+  uv_threadpool_class_t cls =
+      static_cast<uv_threadpool_class_t>(args[0]->Uint32Value());
+  int err = uv_threadpool_set_class(cls,
+                                    args[1]->Uint32Value(),
+                                    args[2]->Int32Value());
+  CHECK_EQ(err, 0);
+}
+
+
 void Kill(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2843,6 +2905,9 @@ void SetupProcessObject(Environment* env,
   env->SetMethod(process, "uptime", Uptime);
   env->SetMethod(process, "memoryUsage", MemoryUsage);
 
+  env->SetMethod(process, "getThreadpoolStats", GetThreadpoolStats);
+  env->SetMethod(process, "_setThreadpoolClass", SetThreadpoolClass);
+
   env->SetMethod(process, "binding", Binding);
   env->SetMethod(process, "_linkedBinding", LinkedBinding);
 
@@ -3005,6 +3070,8 @@ static void PrintHelp() {
          "  --throw-deprecation  throw an exception anytime a deprecated "
          "function is used\n"
          "  --trace-deprecation  show stack traces on deprecations\n"
+         "  --read-slab-size=n   size in bytes of the slabs that socket reads\n"
+         "                       are sliced from, 0 to disable\n"
          "  --v8-options         print v8 command line options\n"
 #if defined(NODE_HAVE_I18N_SUPPORT)
          "  --icu-data-dir=dir   set ICU data load path to dir\n"
@@ -3130,6 +3197,8 @@ static void ParseArgs(int* argc,
     } else if (strcmp(arg, "--abort-on-uncaught-exception") == 0 ||
                strcmp(arg, "--abort_on_uncaught_exception") == 0) {
       abort_on_uncaught_exception = true;
+    } else if (strncmp(arg, "--read-slab-size=", 17) == 0) {
+      SlabAllocator::slab_size = strtoul(arg + 17, nullptr, 10);
     } else if (strcmp(arg, "--v8-options") == 0) {
       new_v8_argv[new_v8_argc] = "--help";
       new_v8_argc += 1;
@@ -35,6 +35,7 @@
     startup.processStdio();
     startup.processKillAndExit();
     startup.processSignalHandlers();
+    startup.processThreadpool();
 
     // Do not initialize channel in debugger agent, it deletes env variable
     // and the main thread won't see it.
@@ -734,6 +735,36 @@
   };
 
 
+  startup.processThreadpool = function() {
+    // Same order as uv_threadpool_class_t
+    var classes = ['fs', 'cpu', 'dns', 'user'];
+
+    process.setThreadpoolClass = function(name, options) {
+      var index = classes.indexOf(name);
+      if (index === -1)
+        throw new TypeError('Unknown threadpool class: ' + name);
+      if (options === null || typeof options !== 'object')
+        throw new TypeError('options must be an object');
+
+      var current = process.getThreadpoolStats()[name];
+      var concurrency = current.concurrency;
+      var priority = current.priority;
+
+      if (options.concurrency !== undefined) {
+        concurrency = options.concurrency;
+        if (concurrency !== concurrency >>> 0)
+          throw new TypeError('concurrency must be an unsigned integer');
+      }
+      if (options.priority !== undefined) {
+        priority = options.priority;
+        if (priority !== (priority | 0))
+          throw new TypeError('priority must be an integer');
+      }
+
+      process._setThreadpoolClass(index, concurrency, priority);
+    };
+  };
+
   startup.processChannel = function() {
     // If we were spawned with env NODE_CHANNEL_FD then load that up and
     // start parsing data from that stream.
@@ -1,11 +1,16 @@
 #include "node.h"
 #include "node_buffer.h"
 
+#include "base-object.h"
+#include "base-object-inl.h"
 #include "env.h"
 #include "env-inl.h"
 #include "smalloc.h"
 #include "string_bytes.h"
+#include "string_search.h"
 #include "v8-profiler.h"
+#include "util.h"
+#include "util-inl.h"
 #include "v8.h"
 
 #include <string.h>
@@ -38,6 +43,7 @@
 namespace node {
 namespace Buffer {
 
+using v8::Array;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Function;
@@ -45,6 +51,7 @@ using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
+using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::Number;
@@ -593,14 +600,8 @@ int32_t IndexOf(const char* haystack,
                 const char* needle,
                 size_t n_length) {
   CHECK_GE(h_length, n_length);
-  // TODO(trevnorris): Implement Boyer-Moore string search algorithm.
-  for (size_t i = 0; i < h_length - n_length + 1; i++) {
-    if (haystack[i] == needle[0]) {
-      if (memcmp(haystack + i, needle, n_length) == 0)
-        return i;
-    }
-  }
-  return -1;
+  size_t r = StringSearch::Find(haystack, h_length, needle, n_length);
+  return r == StringSearch::kNotFound ? -1 : static_cast<int32_t>(r);
 }
 
 
@@ -701,6 +702,211 @@ void IndexOfNumber(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Holds a compiled needle so that repeated searches for the same delimiter
+// do not have to re-encode it or rebuild the skip table on every call.
+// Besides one-shot search() and searchAll(), push() scans a stream chunk by
+// chunk and reports matches that straddle chunk boundaries as negative
+// offsets, so callers never have to concatenate buffers.
+class BufferSearcher : public BaseObject {
+ public:
+  static void Initialize(Environment* env, Handle<Object> target) {
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "BufferSearcher"));
+
+    env->SetProtoMethod(t, "search", Search);
+    env->SetProtoMethod(t, "searchAll", SearchAll);
+    env->SetProtoMethod(t, "push", Push);
+    env->SetProtoMethod(t, "reset", Reset);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "BufferSearcher"),
+                t->GetFunction());
+  }
+
+  ~BufferSearcher() override {
+    delete[] needle_;
+    delete[] tail_;
+  }
+
+ private:
+  BufferSearcher(Environment* env,
+                 Local<Object> wrap,
+                 const char* needle,
+                 size_t needle_length)
+      : BaseObject(env, wrap),
+        needle_(Copy(needle, needle_length)),
+        search_(needle_, needle_length),
+        tail_(new char[needle_length]),
+        tail_length_(0),
+        stream_offset_(0),
+        next_start_(0) {
+    MakeWeak<BufferSearcher>(this);
+  }
+
+  static char* Copy(const char* data, size_t length) {
+    char* copy = new char[length];
+    memcpy(copy, data, length);
+    return copy;
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args.IsConstructCall());
+    CHECK(HasInstance(args[0]));
+
+    Local<Object> needle = args[0].As<Object>();
+    size_t needle_length = Length(needle);
+    if (needle_length == 0)
+      return env->ThrowRangeError("needle must not be empty");
+
+    new BufferSearcher(env, args.This(), Data(needle), needle_length);
+  }
+
+  // search(buffer, offset)
+  static void Search(const FunctionCallbackInfo<Value>& args) {
+    BufferSearcher* searcher = Unwrap<BufferSearcher>(args.Holder());
+    CHECK(HasInstance(args[0]));
+    ASSERT(args[1]->IsNumber());
+
+    ARGS_THIS(args[0].As<Object>());
+    int32_t offset_i32 = args[1]->Int32Value();
+    size_t offset;
+
+    if (offset_i32 < 0) {
+      if (offset_i32 + static_cast<int32_t>(obj_length) < 0)
+        offset = 0;
+      else
+        offset = obj_length + offset_i32;
+    } else {
+      offset = static_cast<size_t>(offset_i32);
+    }
+
+    size_t r = searcher->search_.Search(obj_data, obj_length, offset);
+    args.GetReturnValue().Set(
+        r == StringSearch::kNotFound ? -1 : static_cast<int32_t>(r));
+  }
+
+  // searchAll(buffer), returns the offsets of all non-overlapping matches.
+  static void SearchAll(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    BufferSearcher* searcher = Unwrap<BufferSearcher>(args.Holder());
+    CHECK(HasInstance(args[0]));
+
+    ARGS_THIS(args[0].As<Object>());
+    Local<Array> matches = Array::New(env->isolate());
+    searcher->SearchChunk(env, obj_data, obj_length, 0, matches);
+    args.GetReturnValue().Set(matches);
+  }
+
+  // push(chunk), returns the offsets of the matches that end in this chunk.
+  // A match that started in an earlier chunk has a negative offset.
+  static void Push(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    BufferSearcher* searcher = Unwrap<BufferSearcher>(args.Holder());
+    CHECK(HasInstance(args[0]));
+
+    ARGS_THIS(args[0].As<Object>());
+    Local<Array> matches = Array::New(env->isolate());
+    searcher->PushChunk(env, obj_data, obj_length, matches);
+    args.GetReturnValue().Set(matches);
+  }
+
+  static void Reset(const FunctionCallbackInfo<Value>& args) {
+    BufferSearcher* searcher = Unwrap<BufferSearcher>(args.Holder());
+    searcher->tail_length_ = 0;
+    searcher->stream_offset_ = 0;
+    searcher->next_start_ = 0;
+  }
+
+  // Appends the offsets of the non-overlapping matches in |data| starting at
+  // |start| to |matches|, returns the offset just past the last match.
+  size_t SearchChunk(Environment* env,
+                     const char* data,
+                     size_t length,
+                     size_t start,
+                     Local<Array> matches) {
+    const size_t needle_length = search_.needle_length();
+    uint32_t index = matches->Length();
+    size_t end = start;
+
+    for (;;) {
+      size_t r = search_.Search(data, length, start);
+      if (r == StringSearch::kNotFound)
+        break;
+      matches->Set(index++, Integer::New(env->isolate(), r));
+      start = r + needle_length;
+      end = start;
+    }
+
+    return end;
+  }
+
+  void PushChunk(Environment* env,
+                 const char* data,
+                 size_t length,
+                 Local<Array> matches) {
+    const size_t needle_length = search_.needle_length();
+    const uint64_t tail_start = stream_offset_ - tail_length_;
+
+    // Look for a match that begins in the saved tail of the previous chunks
+    // and ends in this one.  The window is at most 2 * (needle_length - 1)
+    // bytes, and since matches do not overlap there can be at most one.
+    if (tail_length_ > 0 && next_start_ < stream_offset_) {
+      const size_t head_length = MIN(needle_length - 1, length);
+      const size_t window_length = tail_length_ + head_length;
+      char stack_window[256];
+      char* window = stack_window;
+      if (window_length > sizeof(stack_window))
+        window = new char[window_length];
+      memcpy(window, tail_, tail_length_);
+      memcpy(window + tail_length_, data, head_length);
+
+      size_t window_start = 0;
+      if (next_start_ > tail_start)
+        window_start = static_cast<size_t>(next_start_ - tail_start);
+      size_t r = search_.Search(window, window_length, window_start);
+      if (r != StringSearch::kNotFound) {
+        int32_t offset = static_cast<int32_t>(r) -
+                         static_cast<int32_t>(tail_length_);
+        matches->Set(0, Integer::New(env->isolate(), offset));
+        next_start_ = tail_start + r + needle_length;
+      }
+
+      if (window != stack_window)
+        delete[] window;
+    }
+
+    size_t start = 0;
+    if (next_start_ > stream_offset_)
+      start = static_cast<size_t>(next_start_ - stream_offset_);
+    size_t end = SearchChunk(env, data, length, start, matches);
+    if (end > start)
+      next_start_ = stream_offset_ + end;
+
+    // Keep the last needle_length - 1 bytes of the stream around for the
+    // next chunk.
+    const size_t keep = needle_length - 1;
+    if (length >= keep) {
+      memcpy(tail_, data + length - keep, keep);
+      tail_length_ = keep;
+    } else {
+      const size_t old_keep = MIN(tail_length_, keep - length);
+      memmove(tail_, tail_ + tail_length_ - old_keep, old_keep);
+      memcpy(tail_ + old_keep, data, length);
+      tail_length_ = old_keep + length;
+    }
+    stream_offset_ += length;
+  }
+
+  char* needle_;
+  StringSearch search_;
+  char* tail_;
+  size_t tail_length_;
+  uint64_t stream_offset_;  // Total number of bytes pushed so far.
+  uint64_t next_start_;  // First stream offset a new match may start at.
+};
+
+
 // pass Buffer object to load prototype methods
 void SetupBufferJS(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -762,6 +968,8 @@ void Initialize(Handle<Object> target,
   env->SetMethod(target, "writeDoubleLE", WriteDoubleLE);
   env->SetMethod(target, "writeFloatBE", WriteFloatBE);
   env->SetMethod(target, "writeFloatLE", WriteFloatLE);
+
+  BufferSearcher::Initialize(env, target);
 }
 
 
@@ -0,0 +1,103 @@
+#include "node_cpu_features.h"
+#include "uv.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+# define NODE_CPU_FEATURES_X86 1
+# include <cpuid.h>
+// __builtin_cpu_supports() appeared in GCC 4.8 and clang 3.8
+# if defined(__clang__)
+#  if __clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 8)
+#   define NODE_HAVE_BUILTIN_CPU_SUPPORTS 1
+#  endif
+# elif __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8)
+#  define NODE_HAVE_BUILTIN_CPU_SUPPORTS 1
+# endif
+#endif
+
+namespace node {
+
+#if defined(NODE_CPU_FEATURES_X86)
+
+#if defined(NODE_HAVE_BUILTIN_CPU_SUPPORTS)
+
+static unsigned int DetectCpuFeatures() {
+  unsigned int features = 0;
+
+  // Also checks that the OS saves the AVX registers
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    features |= kCpuSSE2;
+  if (__builtin_cpu_supports("ssse3"))
+    features |= kCpuSSSE3;
+  if (__builtin_cpu_supports("sse4.1"))
+    features |= kCpuSSE41;
+  if (__builtin_cpu_supports("avx2"))
+    features |= kCpuAVX2;
+
+  // Older compilers have no __builtin_cpu_supports() name for PCLMULQDQ
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) != 0)
+    features |= kCpuPCLMUL;
+
+  return features;
+}
+
+#else
+
+static unsigned int DetectCpuFeatures() {
+  unsigned int features = 0;
+  unsigned int eax, ebx, ecx, edx;
+
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return 0;
+  if (edx & (1 << 26))
+    features |= kCpuSSE2;
+  if (ecx & (1 << 9))
+    features |= kCpuSSSE3;
+  if (ecx & (1 << 19))
+    features |= kCpuSSE41;
+  if (ecx & (1 << 1))
+    features |= kCpuPCLMUL;
+
+  // AVX2 also needs the OS to save the YMM registers: OSXSAVE, AVX and
+  // XCR0 bits 1 and 2
+  const unsigned int osxsave_avx = (1 << 27) | (1 << 28);
+  if ((ecx & osxsave_avx) == osxsave_avx && __get_cpuid_max(0, nullptr) >= 7) {
+    unsigned int xcr0_lo, xcr0_hi;
+    // xgetbv, spelled out for assemblers that don't know it
+    __asm__ volatile(".byte 0x0f, 0x01, 0xd0"
+                     : "=a" (xcr0_lo), "=d" (xcr0_hi)
+                     : "c" (0));
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    if ((xcr0_lo & 6) == 6 && (ebx & (1 << 5)) != 0)
+      features |= kCpuAVX2;
+  }
+
+  return features;
+}
+
+#endif  // defined(NODE_HAVE_BUILTIN_CPU_SUPPORTS)
+
+
+// The SIMD kernels ask from the threadpool as well as from the main thread
+static uv_once_t cpu_features_once = UV_ONCE_INIT;
+static unsigned int cpu_features;
+
+static void InitCpuFeatures() {
+  cpu_features = DetectCpuFeatures();
+}
+
+unsigned int CpuFeatures() {
+  uv_once(&cpu_features_once, InitCpuFeatures);
+  return cpu_features;
+}
+
+#else
+
+unsigned int CpuFeatures() {
+  return 0;
+}
+
+#endif  // defined(NODE_CPU_FEATURES_X86)
+
+}  // namespace node
@@ -0,0 +1,27 @@
+#ifndef SRC_NODE_CPU_FEATURES_H_
+#define SRC_NODE_CPU_FEATURES_H_
+
+// Runtime detection of the x86 instruction set extensions that the SIMD
+// kernels in string_bytes_simd.cc and node_zlib_simd.cc dispatch on.
+
+namespace node {
+
+enum CpuFeature {
+  kCpuSSE2 = 1 << 0,
+  kCpuSSSE3 = 1 << 1,
+  kCpuSSE41 = 1 << 2,
+  kCpuPCLMUL = 1 << 3,
+  kCpuAVX2 = 1 << 4
+};
+
+// Returns the CpuFeature bits that the CPU and the OS support, 0 on other
+// architectures.
+unsigned int CpuFeatures();
+
+inline bool CpuHasFeatures(unsigned int features) {
+  return (CpuFeatures() & features) == features;
+}
+
+}  // namespace node
+
+#endif  // SRC_NODE_CPU_FEATURES_H_
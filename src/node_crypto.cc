@@ -3,6 +3,8 @@
 #include "node_crypto.h"
 #include "node_crypto_bio.h"
 #include "node_crypto_groups.h"
+#include "node_crypto_session_cache.h"
+#include "node_internals.h"
 #include "tls_wrap.h"  // TLSWrap
 
 #include "async-wrap.h"
@@ -15,8 +17,14 @@
 #include "v8.h"
 
 #include <errno.h>
+#include <limits.h>  // INT_MAX
 #include <stdlib.h>
 #include <string.h>
+#ifdef _WIN32
+#include <io.h>  // _get_osfhandle
+#else
+#include <unistd.h>  // pread
+#endif
 
 #if defined(_MSC_VER)
 #define strcasecmp _stricmp
@@ -183,20 +191,101 @@ static int CryptoPemCallback(char *buf, int size, int rwflag, void *u) {
 }
 
 
-void ThrowCryptoError(Environment* env,
-                      unsigned long err,
-                      const char* default_message = nullptr) {
-  HandleScope scope(env->isolate());
+// Same as ThrowCryptoError() but returns the exception, e.g. to pass it to a
+// callback.  Only call with a valid HandleScope.
+Local<Value> CryptoException(Environment* env,
+                             unsigned long err,
+                             const char* default_message = nullptr) {
   if (err != 0 || default_message == nullptr) {
     char errmsg[128] = { 0 };
     ERR_error_string_n(err, errmsg, sizeof(errmsg));
-    env->ThrowError(errmsg);
-  } else {
-    env->ThrowError(default_message);
+    return Exception::Error(OneByteString(env->isolate(), errmsg));
   }
+  return Exception::Error(OneByteString(env->isolate(), default_message));
+}
+
+
+void ThrowCryptoError(Environment* env,
+                      unsigned long err,
+                      const char* default_message = nullptr) {
+  HandleScope scope(env->isolate());
+  env->isolate()->ThrowException(CryptoException(env, err, default_message));
 }
 
 
+// Base class of the requests that run the expensive part of a crypto
+// operation on the threadpool.  Subclasses copy or reference everything they
+// need in the constructor, DoWork() runs on a worker thread and must not
+// touch V8, AfterWork() runs on the loop thread and produces the arguments
+// of the callback.
+class CryptoJob : public AsyncWrap {
+ public:
+  CryptoJob(Environment* env, Local<Object> object)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO) {
+  }
+
+  ~CryptoJob() override {
+    persistent().Reset();
+  }
+
+  // Calls `callback` with (err, result) once the job is done, after which
+  // the job deletes itself
+  void Queue(Local<Value> callback) {
+    Local<Object> obj = object();
+    obj->Set(env()->ondone_string(), callback);
+    // XXX(trevnorris): This will need to go with the rest of domains.
+    if (env()->in_domain())
+      obj->Set(env()->domain_string(), env()->domain_array()->Get(0));
+    uv_queue_work_class(env()->event_loop(),
+                        &work_req_,
+                        UV_THREADPOOL_CPU,
+                        Work,
+                        After);
+  }
+
+ protected:
+  virtual void DoWork() = 0;
+  virtual void AfterWork(Local<Value> argv[2]) = 0;
+
+  // The inputs are copied, the JS values may change while the job runs.
+  // Free with delete[].
+  static char* Copy(const char* data, size_t len) {
+    char* copy = new char[len];
+    memcpy(copy, data, len);
+    return copy;
+  }
+
+  // nullptr stays nullptr
+  static char* CopyString(const char* str) {
+    if (str == nullptr)
+      return nullptr;
+    return Copy(str, strlen(str) + 1);
+  }
+
+ private:
+  static void Work(uv_work_t* work_req) {
+    CryptoJob* job = ContainerOf(&CryptoJob::work_req_, work_req);
+    job->DoWork();
+    // The error queue is per thread, leave nothing behind on the worker
+    ERR_clear_error();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    CryptoJob* job = ContainerOf(&CryptoJob::work_req_, work_req);
+    Environment* env = job->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[2];
+    job->AfterWork(argv);
+    job->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+    delete job;
+  }
+
+  uv_work_t work_req_;
+};
+
+
 // Ensure that OpenSSL has enough entropy (at least 256 bits) for its PRNG.
 // The entropy pool starts out empty and needs to fill up before the PRNG
 // can be used securely.  Once the pool is filled, it never dries up again;
@@ -260,10 +349,15 @@ void SecureContext::Initialize(Environment* env, Handle<Object> target) {
                       SecureContext::SetSessionIdContext);
   env->SetProtoMethod(t, "setSessionTimeout",
                       SecureContext::SetSessionTimeout);
+  env->SetProtoMethod(t,
+                      "enableSharedSessionCache",
+                      SecureContext::EnableSharedSessionCache);
   env->SetProtoMethod(t, "close", SecureContext::Close);
   env->SetProtoMethod(t, "loadPKCS12", SecureContext::LoadPKCS12);
   env->SetProtoMethod(t, "getTicketKeys", SecureContext::GetTicketKeys);
   env->SetProtoMethod(t, "setTicketKeys", SecureContext::SetTicketKeys);
+  env->SetProtoMethod(t, "addSNIContext", SecureContext::AddSNIContext);
+  env->SetProtoMethod(t, "getSNIContext", SecureContext::GetSNIContext);
   env->SetProtoMethod(t, "getCertificate", SecureContext::GetCertificate<true>);
   env->SetProtoMethod(t, "getIssuer", SecureContext::GetCertificate<false>);
 
@@ -820,6 +914,28 @@ void SecureContext::SetSessionTimeout(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void SecureContext::EnableSharedSessionCache(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
+
+  if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsUint32())
+    return env->ThrowTypeError("Bad arguments, expected path and size");
+
+  node::Utf8Value path(env->isolate(), args[0]);
+  int err;
+  const char* syscall;
+  SharedSessionCache* cache = SharedSessionCache::Open(*path,
+                                                       args[1]->Uint32Value(),
+                                                       &err,
+                                                       &syscall);
+  if (cache == nullptr)
+    return env->ThrowErrnoException(err, syscall, nullptr, *path);
+
+  SharedSessionCache::Attach(sc->ctx_, cache);
+}
+
+
 void SecureContext::Close(const FunctionCallbackInfo<Value>& args) {
   SecureContext* sc = Unwrap<SecureContext>(args.Holder());
   sc->FreeCTXMem();
@@ -932,6 +1048,46 @@ void SecureContext::SetTicketKeys(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// addSNIContext(servername, context) returns false when `servername` is a
+// pattern that the map can't hold
+void SecureContext::AddSNIContext(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
+
+  if (!args[0]->IsString())
+    return env->ThrowTypeError("Servername must be a string");
+  Local<FunctionTemplate> cons = env->secure_context_constructor_template();
+  if (!cons->HasInstance(args[1]))
+    return env->ThrowTypeError("Context must be a SecureContext");
+
+  node::Utf8Value servername(env->isolate(), args[0]);
+  if (!SNIMap::IsSupported(*servername, servername.length()))
+    return args.GetReturnValue().Set(false);
+
+  wrap->sni_map_.Add(env->isolate(),
+                     *servername,
+                     servername.length(),
+                     args[1].As<Object>());
+  args.GetReturnValue().Set(true);
+}
+
+
+void SecureContext::GetSNIContext(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
+
+  if (!args[0]->IsString())
+    return env->ThrowTypeError("Servername must be a string");
+
+  node::Utf8Value servername(env->isolate(), args[0]);
+  Local<Object> context = wrap->sni_map_.Lookup(env->isolate(),
+                                                *servername,
+                                                servername.length());
+  if (!context.IsEmpty())
+    args.GetReturnValue().Set(context);
+}
+
+
 void SecureContext::CtxGetter(Local<String> property,
                               const PropertyCallbackInfo<Value>& info) {
   HandleScope scope(info.GetIsolate());
@@ -1038,6 +1194,13 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
   SSL_SESSION* sess = w->next_sess_;
   w->next_sess_ = nullptr;
 
+  // Sessions created by the other processes that share the cache
+  if (sess == nullptr) {
+    SharedSessionCache* cache = SharedSessionCache::FromContext(s->session_ctx);
+    if (cache != nullptr)
+      sess = cache->Get(key, len);
+  }
+
   return sess;
 }
 
@@ -1049,6 +1212,10 @@ int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  SharedSessionCache* cache = SharedSessionCache::FromContext(s->session_ctx);
+  if (cache != nullptr)
+    cache->Add(sess);
+
   if (!w->session_callbacks_)
     return 0;
 
@@ -1313,6 +1480,7 @@ template <class Base>
 void SSLWrap<Base>::GetPeerCertificate(
     const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
   Environment* env = w->ssl_env();
 
   ClearErrorOnReturn clear_error_on_return;
@@ -1421,6 +1589,7 @@ void SSLWrap<Base>::GetSession(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
 
   SSL_SESSION* sess = SSL_get_session(w->ssl_);
   if (sess == nullptr)
@@ -1442,6 +1611,7 @@ void SSLWrap<Base>::SetSession(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
 
   if (args.Length() < 1 ||
       (!args[0]->IsString() && !Buffer::HasInstance(args[0]))) {
@@ -1503,6 +1673,7 @@ void SSLWrap<Base>::LoadSession(const FunctionCallbackInfo<Value>& args) {
 template <class Base>
 void SSLWrap<Base>::IsSessionReused(const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
   bool yes = SSL_session_reused(w->ssl_);
   args.GetReturnValue().Set(yes);
 }
@@ -1518,6 +1689,7 @@ void SSLWrap<Base>::EndParser(const FunctionCallbackInfo<Value>& args) {
 template <class Base>
 void SSLWrap<Base>::Renegotiate(const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
 
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence unused variable warning.
@@ -1530,6 +1702,7 @@ void SSLWrap<Base>::Renegotiate(const FunctionCallbackInfo<Value>& args) {
 template <class Base>
 void SSLWrap<Base>::Shutdown(const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
 
   int rv = SSL_shutdown(w->ssl_);
   args.GetReturnValue().Set(rv);
@@ -1539,6 +1712,7 @@ void SSLWrap<Base>::Shutdown(const FunctionCallbackInfo<Value>& args) {
 template <class Base>
 void SSLWrap<Base>::GetTLSTicket(const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
   Environment* env = w->ssl_env();
 
   SSL_SESSION* sess = SSL_get_session(w->ssl_);
@@ -1583,6 +1757,7 @@ void SSLWrap<Base>::RequestOCSP(
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
 
   SSL_set_tlsext_status_type(w->ssl_, TLSEXT_STATUSTYPE_ocsp);
 #endif  // NODE__HAVE_TLSEXT_STATUS_CB
@@ -1598,7 +1773,7 @@ void SSLWrap<Base>::SetMaxSendFragment(
 
   Base* w = Unwrap<Base>(args.Holder());
 
-  int rv = SSL_set_max_send_fragment(w->ssl_, args[0]->Int32Value());
+  int rv = w->SetSendFragment(args[0]->Int32Value());
   args.GetReturnValue().Set(rv);
 }
 #endif  // SSL_set_max_send_fragment
@@ -1607,6 +1782,7 @@ void SSLWrap<Base>::SetMaxSendFragment(
 template <class Base>
 void SSLWrap<Base>::IsInitFinished(const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
   bool yes = SSL_is_init_finished(w->ssl_);
   args.GetReturnValue().Set(yes);
 }
@@ -1615,6 +1791,7 @@ void SSLWrap<Base>::IsInitFinished(const FunctionCallbackInfo<Value>& args) {
 template <class Base>
 void SSLWrap<Base>::VerifyError(const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
 
   // XXX(bnoordhuis) The UNABLE_TO_GET_ISSUER_CERT error when there is no
   // peer certificate is questionable but it's compatible with what was
@@ -1678,6 +1855,7 @@ void SSLWrap<Base>::VerifyError(const FunctionCallbackInfo<Value>& args) {
 template <class Base>
 void SSLWrap<Base>::GetCurrentCipher(const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
   Environment* env = w->ssl_env();
 
   OPENSSL_CONST SSL_CIPHER* c = SSL_get_current_cipher(w->ssl_);
@@ -1778,6 +1956,7 @@ template <class Base>
 void SSLWrap<Base>::GetNegotiatedProto(
     const FunctionCallbackInfo<Value>& args) {
   Base* w = Unwrap<Base>(args.Holder());
+  SSLLock lock(w);
 
   if (w->is_client()) {
     if (w->selected_npn_proto_.IsEmpty() == false) {
@@ -2026,6 +2205,13 @@ void Connection::SetShutdownFlags() {
 }
 
 
+#ifdef SSL_set_max_send_fragment
+int Connection::SetSendFragment(int size) {
+  return SSL_set_max_send_fragment(ssl_, size);
+}
+#endif  // SSL_set_max_send_fragment
+
+
 void Connection::NewSessionDoneCb() {
   HandleScope scope(env()->isolate());
 
@@ -2505,6 +2691,7 @@ void CipherBase::Initialize(Environment* env, Handle<Object> target) {
   env->SetProtoMethod(t, "init", Init);
   env->SetProtoMethod(t, "initiv", InitIv);
   env->SetProtoMethod(t, "update", Update);
+  env->SetProtoMethod(t, "updateInto", UpdateInto);
   env->SetProtoMethod(t, "final", Final);
   env->SetProtoMethod(t, "setAutoPadding", SetAutoPadding);
   env->SetProtoMethod(t, "getAuthTag", GetAuthTag);
@@ -2731,6 +2918,19 @@ bool CipherBase::Update(const char* data,
   if (!initialised_)
     return 0;
 
+  *out_len = len + EVP_CIPHER_CTX_block_size(&ctx_);
+  *out = new unsigned char[*out_len];
+  return Update(data, len, *out, out_len);
+}
+
+
+bool CipherBase::Update(const char* data,
+                        int len,
+                        unsigned char* out,
+                        int* out_len) {
+  if (!initialised_)
+    return 0;
+
   // on first update:
   if (kind_ == kDecipher && IsAuthenticatedMode() && auth_tag_ != nullptr) {
     EVP_CIPHER_CTX_ctrl(&ctx_,
@@ -2741,16 +2941,22 @@ bool CipherBase::Update(const char* data,
     auth_tag_ = nullptr;
   }
 
-  *out_len = len + EVP_CIPHER_CTX_block_size(&ctx_);
-  *out = new unsigned char[*out_len];
   return EVP_CipherUpdate(&ctx_,
-                          *out,
+                          out,
                           out_len,
                           reinterpret_cast<const unsigned char*>(data),
                           len);
 }
 
 
+size_t CipherBase::UpdateOutputSize(size_t len) const {
+  CHECK(initialised_);
+  // Block ciphers hold back up to a block, the decipher also the last one
+  size_t block_size = EVP_CIPHER_CTX_block_size(&ctx_);
+  return block_size > 1 ? len + block_size : len;
+}
+
+
 void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2789,6 +2995,63 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// updateInto(input, output, offset) writes into `output` and returns the
+// number of bytes written.  `output` may be `input` for stream ciphers.
+void CipherBase::UpdateInto(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CipherBase* cipher = Unwrap<CipherBase>(args.Holder());
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[1]);
+  CHECK(args[2]->IsUint32());
+
+  const char* in = Buffer::Data(args[0]);
+  size_t in_len = Buffer::Length(args[0]);
+  char* out = Buffer::Data(args[1]);
+  size_t out_len = Buffer::Length(args[1]);
+  size_t offset = args[2]->Uint32Value();
+  CHECK_LE(offset, out_len);
+
+  // The context is gone after final()
+  if (!cipher->initialised_) {
+    return ThrowCryptoError(env,
+                            ERR_get_error(),
+                            "Trying to add data in unsupported state");
+  }
+
+  // EVP_CipherUpdate() takes an int
+  if (in_len > INT_MAX)
+    return env->ThrowRangeError("Input buffer is too large");
+
+  size_t max_len = cipher->UpdateOutputSize(in_len);
+  if (out_len - offset < max_len)
+    return env->ThrowRangeError("Output buffer is too small");
+
+  // EVP_CipherUpdate() can only work in place when nothing is buffered:
+  // block ciphers first write out the block they held back, ahead of the
+  // input that has not been read yet.
+  char* out_start = out + offset;
+  bool in_place = out_start == in &&
+                  EVP_CIPHER_CTX_block_size(&cipher->ctx_) == 1;
+  if (!in_place && out_start < in + in_len && in < out_start + max_len)
+    return env->ThrowError("Output overlaps the input");
+
+  int written = 0;
+  bool r = cipher->Update(in,
+                          in_len,
+                          reinterpret_cast<unsigned char*>(out_start),
+                          &written);
+  if (!r) {
+    return ThrowCryptoError(env,
+                            ERR_get_error(),
+                            "Trying to add data in unsupported state");
+  }
+
+  args.GetReturnValue().Set(written);
+}
+
+
 bool CipherBase::SetAutoPadding(bool auto_padding) {
   if (!initialised_)
     return false;
@@ -3000,6 +3263,9 @@ void Hash::Initialize(Environment* env, v8::Handle<v8::Object> target) {
   env->SetProtoMethod(t, "digest", HashDigest);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Hash"), t->GetFunction());
+
+  env->SetMethod(target, "hash", OneShot);
+  env->SetMethod(target, "hashMany", HashMany);
 }
 
 
@@ -3019,9 +3285,34 @@ void Hash::New(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+const EVP_MD* Hash::GetDigest(const char* hash_type) {
+  // EVP_get_digestbyname() goes through OpenSSL's object name table, a few
+  // names usually cover all of the hashing of an application
+  static struct {
+    char name[32];
+    const EVP_MD* md;
+  } cache[8];
+  static size_t next;
+
+  for (size_t i = 0; i < ARRAY_SIZE(cache); i++) {
+    if (cache[i].md != nullptr && strcmp(cache[i].name, hash_type) == 0)
+      return cache[i].md;
+  }
+
+  const EVP_MD* md = EVP_get_digestbyname(hash_type);
+  if (md == nullptr || strlen(hash_type) >= sizeof(cache[0].name))
+    return md;
+
+  size_t i = next++ % ARRAY_SIZE(cache);
+  strcpy(cache[i].name, hash_type);  // NOLINT(runtime/printf)
+  cache[i].md = md;
+  return md;
+}
+
+
 bool Hash::HashInit(const char* hash_type) {
   CHECK_EQ(md_, nullptr);
-  md_ = EVP_get_digestbyname(hash_type);
+  md_ = GetDigest(hash_type);
   if (md_ == nullptr)
     return false;
   EVP_MD_CTX_init(&mdctx_);
@@ -3096,41 +3387,436 @@ void Hash::HashDigest(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void Hash::OneShot(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (args.Length() == 0 || !args[0]->IsString()) {
+    return env->ThrowError("Must give hashtype string as argument");
+  }
+
+  THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(args[1]);
+
+  const node::Utf8Value hash_type(env->isolate(), args[0]);
+  const EVP_MD* md = GetDigest(*hash_type);
+  if (md == nullptr) {
+    return env->ThrowError("Digest method not supported");
+  }
+
+  enum encoding encoding = BUFFER;
+  if (args[2]->IsString()) {
+    encoding = ParseEncoding(env->isolate(),
+                             args[2]->ToString(env->isolate()),
+                             BUFFER);
+  }
+
+  // Shared by all calls, EVP_DigestInit_ex() only reallocates the digest
+  // state when the algorithm changes.  Only used from the main thread.
+  static EVP_MD_CTX* mdctx = EVP_MD_CTX_create();
+
+  unsigned char md_value[EVP_MAX_MD_SIZE];
+  unsigned int md_len;
+
+  bool ok = EVP_DigestInit_ex(mdctx, md, nullptr);
+  if (ok && args[1]->IsString()) {
+    // Same as hash.update(data), strings are binary by default
+    StringBytes::InlineDecoder decoder;
+    if (!decoder.Decode(env,
+                        args[1].As<String>(),
+                        Undefined(env->isolate()),
+                        BINARY)) {
+      return;
+    }
+    ok = EVP_DigestUpdate(mdctx, decoder.out(), decoder.size());
+  } else if (ok) {
+    ok = EVP_DigestUpdate(mdctx,
+                          Buffer::Data(args[1]),
+                          Buffer::Length(args[1]));
+  }
+  if (ok)
+    ok = EVP_DigestFinal_ex(mdctx, md_value, &md_len);
+  if (!ok)
+    return ThrowCryptoError(env, ERR_get_error(), "Digest failed");
+
+  Local<Value> rc = StringBytes::Encode(env->isolate(),
+                                        reinterpret_cast<const char*>(md_value),
+                                        md_len,
+                                        encoding);
+  args.GetReturnValue().Set(rc);
+}
+
+
+// Digests a list of buffers and files on several threadpool threads at once.
+// The workers keep taking the next input until all of them are done, so a
+// few large inputs don't hold up the rest.  Buffers are digested by workers
+// of the CPU class, files by workers of the FS class because they mostly
+// wait for reads.  The callback receives all of the digests when the last
+// worker finishes.
+class HashManyJob : public AsyncWrap {
+ public:
+  struct Input {
+    const char* data;
+    size_t length;
+    uv_file fd;  // -1 for buffers
+  };
+
+  HashManyJob(Environment* env,
+              Local<Object> object,
+              const EVP_MD* md,
+              Input* inputs,
+              size_t count,
+              enum encoding encoding)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        md_(md),
+        inputs_(inputs),
+        count_(count),
+        encoding_(encoding),
+        digests_(new unsigned char[count * EVP_MAX_MD_SIZE]),
+        indexes_(new size_t[count]),
+        work_reqs_(nullptr),
+        buffer_workers_(0),
+        pending_(0),
+        failed_(false),
+        uv_error_(0),
+        ssl_error_(0) {
+    CHECK_EQ(uv_mutex_init(&mutex_), 0);
+
+    // Buffers go to the front of indexes_, files to the back
+    size_t buffers = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (inputs[i].fd == -1)
+        buffers++;
+    }
+    size_t next[2] = { 0, buffers };
+    for (size_t i = 0; i < count; i++)
+      indexes_[next[inputs[i].fd == -1 ? kBuffers : kFiles]++] = i;
+    queues_[kBuffers].next = 0;
+    queues_[kBuffers].end = buffers;
+    queues_[kFiles].next = buffers;
+    queues_[kFiles].end = count;
+  }
+
+  ~HashManyJob() override {
+    uv_mutex_destroy(&mutex_);
+    delete[] inputs_;
+    delete[] digests_;
+    delete[] indexes_;
+    delete[] work_reqs_;
+    persistent().Reset();
+  }
+
+  // Uses as many threads as the class can run at once, or one per input
+  void Queue(Local<Value> callback) {
+    Local<Object> obj = object();
+    obj->Set(env()->ondone_string(), callback);
+    // XXX(trevnorris): This will need to go with the rest of domains.
+    if (env()->in_domain())
+      obj->Set(env()->domain_string(), env()->domain_array()->Get(0));
+
+    buffer_workers_ = Workers(kBuffers, UV_THREADPOOL_CPU);
+    size_t file_workers = Workers(kFiles, UV_THREADPOOL_FS);
+    size_t workers = buffer_workers_ + file_workers;
+    CHECK_GT(workers, 0);
+
+    work_reqs_ = new uv_work_t[workers];
+    for (size_t i = 0; i < workers; i++) {
+      work_reqs_[i].data = this;
+      uv_queue_work_class(env()->event_loop(),
+                          &work_reqs_[i],
+                          i < buffer_workers_ ? UV_THREADPOOL_CPU :
+                                                UV_THREADPOOL_FS,
+                          Work,
+                          After);
+      pending_++;
+    }
+  }
+
+ private:
+  enum QueueType { kBuffers, kFiles };
+
+  // Range of indexes_ that the workers of one class take inputs from
+  struct InputQueue {
+    size_t next;
+    size_t end;
+  };
+
+  static const size_t kReadSize = 64 * 1024;
+  // Returned by Digest() when OpenSSL fails, libuv errors are negative
+  static const int kDigestFailed = 1;
+
+  size_t Workers(QueueType type, uv_threadpool_class_t cls) const {
+    size_t inputs = queues_[type].end - queues_[type].next;
+    size_t concurrency = ThreadpoolConcurrency(cls);
+    return inputs < concurrency ? inputs : concurrency;
+  }
+
+  static int ReadAt(uv_file fd, char* buf, size_t len, int64_t offset) {
+#ifdef _WIN32
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    if (handle == INVALID_HANDLE_VALUE)
+      return UV_EBADF;
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD nread;
+    if (ReadFile(handle, buf, len, &nread, &overlapped))
+      return nread;
+    switch (GetLastError()) {
+      case ERROR_HANDLE_EOF:
+        return 0;
+      case ERROR_ACCESS_DENIED:
+        return UV_EPERM;
+      case ERROR_INVALID_HANDLE:
+        return UV_EBADF;
+      default:
+        return UV_EIO;
+    }
+#else
+    ssize_t nread;
+    do {
+      nread = pread(fd, buf, len, offset);
+    } while (nread == -1 && errno == EINTR);
+    return nread == -1 ? -errno : nread;
+#endif
+  }
+
+  // Returns 0, kDigestFailed or a libuv error code from reading the file
+  int Digest(EVP_MD_CTX* mdctx, const Input& input, char** buf, size_t index) {
+    if (!EVP_DigestInit_ex(mdctx, md_, nullptr))
+      return kDigestFailed;
+
+    if (input.fd == -1) {
+      if (!EVP_DigestUpdate(mdctx, input.data, input.length))
+        return kDigestFailed;
+    } else {
+      // Reads from the start of the file, the file position doesn't move
+      if (*buf == nullptr)
+        *buf = new char[kReadSize];
+      int64_t offset = 0;
+      for (;;) {
+        int nread = ReadAt(input.fd, *buf, kReadSize, offset);
+        if (nread < 0)
+          return nread;
+        if (nread == 0)
+          break;
+        if (!EVP_DigestUpdate(mdctx, *buf, nread))
+          return kDigestFailed;
+        offset += nread;
+      }
+    }
+
+    unsigned char* md_value = digests_ + index * EVP_MAX_MD_SIZE;
+    if (!EVP_DigestFinal_ex(mdctx, md_value, nullptr))
+      return kDigestFailed;
+    return 0;
+  }
+
+  static void Work(uv_work_t* work_req) {
+    HashManyJob* job = static_cast<HashManyJob*>(work_req->data);
+    size_t worker = work_req - job->work_reqs_;
+    InputQueue* queue =
+        &job->queues_[worker < job->buffer_workers_ ? kBuffers : kFiles];
+    EVP_MD_CTX mdctx;
+    EVP_MD_CTX_init(&mdctx);
+    char* buf = nullptr;
+
+    for (;;) {
+      uv_mutex_lock(&job->mutex_);
+      bool done = job->failed_ || queue->next >= queue->end;
+      size_t index = done ? 0 : job->indexes_[queue->next++];
+      uv_mutex_unlock(&job->mutex_);
+      if (done)
+        break;
+
+      int err = job->Digest(&mdctx, job->inputs_[index], &buf, index);
+      if (err == 0)
+        continue;
+
+      uv_mutex_lock(&job->mutex_);
+      if (!job->failed_) {
+        job->failed_ = true;
+        job->uv_error_ = err;
+        if (err == kDigestFailed)
+          job->ssl_error_ = ERR_get_error();
+      }
+      uv_mutex_unlock(&job->mutex_);
+    }
+
+    delete[] buf;
+    EVP_MD_CTX_cleanup(&mdctx);
+    // The error queue is per thread, leave nothing behind on the worker
+    ERR_clear_error();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    HashManyJob* job = static_cast<HashManyJob*>(work_req->data);
+    if (--job->pending_ > 0)
+      return;
+
+    Environment* env = job->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[2];
+    job->AfterWork(argv);
+    job->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+    delete job;
+  }
+
+  void AfterWork(Local<Value> argv[2]) {
+    Isolate* isolate = env()->isolate();
+
+    if (failed_) {
+      if (uv_error_ == kDigestFailed)
+        argv[0] = CryptoException(env(), ssl_error_, "Digest failed");
+      else
+        argv[0] = UVException(isolate, uv_error_, "read");
+      argv[1] = Null(isolate);
+      return;
+    }
+
+    size_t md_len = EVP_MD_size(md_);
+    Local<Array> digests = Array::New(isolate, count_);
+    for (size_t i = 0; i < count_; i++) {
+      const char* md_value =
+          reinterpret_cast<const char*>(digests_ + i * EVP_MAX_MD_SIZE);
+      digests->Set(i, StringBytes::Encode(isolate, md_value, md_len,
+                                          encoding_));
+    }
+    argv[0] = Null(isolate);
+    argv[1] = digests;
+  }
+
+  const EVP_MD* md_;
+  Input* inputs_;
+  size_t count_;
+  enum encoding encoding_;
+  unsigned char* digests_;
+  size_t* indexes_;
+  uv_work_t* work_reqs_;
+  // The first buffer_workers_ of work_reqs_ digest buffers, the rest files
+  size_t buffer_workers_;
+  // Only touched on the main thread
+  size_t pending_;
+
+  // Shared between the workers
+  uv_mutex_t mutex_;
+  InputQueue queues_[2];
+  bool failed_;
+  int uv_error_;
+  unsigned long ssl_error_;  // NOLINT(runtime/int)
+};
+
+
+void Hash::HashMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsString()) {
+    return env->ThrowError("Must give hashtype string as argument");
+  }
+  if (!args[1]->IsArray()) {
+    return env->ThrowTypeError("Inputs must be an array");
+  }
+  CHECK(args[3]->IsFunction());
+
+  const node::Utf8Value hash_type(env->isolate(), args[0]);
+  const EVP_MD* md = GetDigest(*hash_type);
+  if (md == nullptr) {
+    return env->ThrowError("Digest method not supported");
+  }
+
+  enum encoding encoding = BUFFER;
+  if (args[2]->IsString()) {
+    encoding = ParseEncoding(env->isolate(),
+                             args[2]->ToString(env->isolate()),
+                             BUFFER);
+  }
+
+  Local<Array> inputs = args[1].As<Array>();
+  size_t count = inputs->Length();
+  if (count == 0) {
+    return env->ThrowError("Inputs must not be empty");
+  }
+
+  HashManyJob::Input* job_inputs = new HashManyJob::Input[count];
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> input = inputs->Get(i);
+    if (Buffer::HasInstance(input)) {
+      job_inputs[i].data = Buffer::Data(input);
+      job_inputs[i].length = Buffer::Length(input);
+      job_inputs[i].fd = -1;
+    } else if (input->IsInt32() && input->Int32Value() >= 0) {
+      job_inputs[i].data = nullptr;
+      job_inputs[i].length = 0;
+      job_inputs[i].fd = input->Int32Value();
+    } else {
+      delete[] job_inputs;
+      return env->ThrowTypeError("Inputs must be buffers or file descriptors");
+    }
+  }
+
+  // The buffers are hashed in place, the job keeps them alive until then
+  Local<Object> obj = Object::New(env->isolate());
+  obj->Set(env->buffer_string(), inputs);
+
+  HashManyJob* job =
+      new HashManyJob(env, obj, md, job_inputs, count, encoding);
+  job->Queue(args[3]);
+}
+
+
 void SignBase::CheckThrow(SignBase::Error error) {
+  if (error == kSignOk)
+    return;
+
   HandleScope scope(env()->isolate());
+  env()->isolate()->ThrowException(ToException(env(), error, ERR_get_error()));
+}
+
 
+Local<Value> SignBase::ToException(Environment* env,
+                                   SignBase::Error error,
+                                   unsigned long err) {
   switch (error) {
     case kSignUnknownDigest:
-      return env()->ThrowError("Unknown message digest");
+      return CryptoException(env, 0, "Unknown message digest");
 
     case kSignNotInitialised:
-      return env()->ThrowError("Not initialised");
+      return CryptoException(env, 0, "Not initialised");
 
     case kSignInit:
+      return CryptoException(env, err, "EVP_SignInit_ex failed");
+
     case kSignUpdate:
+      return CryptoException(env, err, "EVP_SignUpdate failed");
+
     case kSignPrivateKey:
+      return CryptoException(env, err, "PEM_read_bio_PrivateKey failed");
+
     case kSignPublicKey:
-      {
-        unsigned long err = ERR_get_error();
-        if (err)
-          return ThrowCryptoError(env(), err);
-        switch (error) {
-          case kSignInit:
-            return env()->ThrowError("EVP_SignInit_ex failed");
-          case kSignUpdate:
-            return env()->ThrowError("EVP_SignUpdate failed");
-          case kSignPrivateKey:
-            return env()->ThrowError("PEM_read_bio_PrivateKey failed");
-          case kSignPublicKey:
-            return env()->ThrowError("PEM_read_bio_PUBKEY failed");
-          default:
-            abort();
-        }
-      }
+      return CryptoException(env, err, "PEM_read_bio_PUBKEY failed");
 
     case kSignOk:
-      return;
+      break;
   }
+  abort();
+}
+
+
+SignBase::Error SignBase::MoveContext(EVP_MD_CTX* mdctx) {
+  if (!initialised_)
+    return kSignNotInitialised;
+
+  EVP_MD_CTX_init(mdctx);
+  bool ok = EVP_MD_CTX_copy_ex(mdctx, &mdctx_);
+  EVP_MD_CTX_cleanup(&mdctx_);
+  initialised_ = false;
+
+  if (!ok) {
+    EVP_MD_CTX_cleanup(mdctx);
+    return kSignInit;
+  }
+  return kSignOk;
 }
 
 
@@ -3223,6 +3909,17 @@ SignBase::Error Sign::SignFinal(const char* key_pem,
   if (!initialised_)
     return kSignNotInitialised;
 
+  initialised_ = false;
+  return SignFinal(&mdctx_, key_pem, key_pem_len, passphrase, sig, sig_len);
+}
+
+
+SignBase::Error Sign::SignFinal(EVP_MD_CTX* mdctx,
+                                const char* key_pem,
+                                int key_pem_len,
+                                const char* passphrase,
+                                unsigned char** sig,
+                                unsigned int *sig_len) {
   BIO* bp = nullptr;
   EVP_PKEY* pkey = nullptr;
   bool fatal = true;
@@ -3238,18 +3935,16 @@ SignBase::Error Sign::SignFinal(const char* key_pem,
   if (pkey == nullptr)
     goto exit;
 
-  if (EVP_SignFinal(&mdctx_, *sig, sig_len, pkey))
+  if (EVP_SignFinal(mdctx, *sig, sig_len, pkey))
     fatal = false;
 
-  initialised_ = false;
-
  exit:
   if (pkey != nullptr)
     EVP_PKEY_free(pkey);
   if (bp != nullptr)
     BIO_free_all(bp);
 
-  EVP_MD_CTX_cleanup(&mdctx_);
+  EVP_MD_CTX_cleanup(mdctx);
 
   if (fatal)
     return kSignPrivateKey;
@@ -3258,6 +3953,73 @@ SignBase::Error Sign::SignFinal(const char* key_pem,
 }
 
 
+class SignJob : public CryptoJob {
+ public:
+  SignJob(Environment* env,
+          Local<Object> object,
+          const char* key_pem,
+          int key_pem_len,
+          const char* passphrase)
+      : CryptoJob(env, object),
+        key_pem_(Copy(key_pem, key_pem_len)),
+        key_pem_len_(key_pem_len),
+        passphrase_(CopyString(passphrase)),
+        sig_(nullptr),
+        sig_len_(0),
+        error_(SignBase::kSignOk),
+        err_(0) {
+  }
+
+  ~SignJob() override {
+    delete[] key_pem_;
+    if (passphrase_ != nullptr) {
+      memset(passphrase_, 0, strlen(passphrase_));
+      delete[] passphrase_;
+    }
+    delete[] sig_;
+  }
+
+  // For SignBase::MoveContext(), Sign::SignFinal() cleans it up
+  inline EVP_MD_CTX* mdctx() {
+    return &mdctx_;
+  }
+
+ protected:
+  void DoWork() override {
+    sig_len_ = 8192;  // Maximum key size is 8192 bits
+    sig_ = new unsigned char[sig_len_];
+    error_ = Sign::SignFinal(&mdctx_,
+                             key_pem_,
+                             key_pem_len_,
+                             passphrase_,
+                             &sig_,
+                             &sig_len_);
+    if (error_ != SignBase::kSignOk)
+      err_ = ERR_get_error();
+  }
+
+  void AfterWork(Local<Value> argv[2]) override {
+    if (error_ != SignBase::kSignOk) {
+      argv[0] = SignBase::ToException(env(), error_, err_);
+      argv[1] = Null(env()->isolate());
+    } else {
+      argv[0] = Null(env()->isolate());
+      argv[1] = Buffer::New(env(), reinterpret_cast<char*>(sig_), sig_len_);
+    }
+  }
+
+ private:
+  EVP_MD_CTX mdctx_;
+  char* key_pem_;
+  int key_pem_len_;
+  char* passphrase_;
+  unsigned char* sig_;
+  unsigned int sig_len_;
+  SignBase::Error error_;
+  unsigned long err_;
+};
+
+
 void Sign::SignFinal(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -3280,6 +4042,23 @@ void Sign::SignFinal(const FunctionCallbackInfo<Value>& args) {
   size_t buf_len = Buffer::Length(args[0]);
   char* buf = Buffer::Data(args[0]);
 
+  // sign(key, encoding, passphrase, callback) signs on the threadpool and
+  // always passes a Buffer to the callback
+  if (args[3]->IsFunction()) {
+    SignJob* job = new SignJob(
+        env,
+        Object::New(env->isolate()),
+        buf,
+        buf_len,
+        len >= 3 && !args[2]->IsNull() ? *passphrase : nullptr);
+    Error err = sign->MoveContext(job->mdctx());
+    if (err != kSignOk) {
+      delete job;
+      return sign->CheckThrow(err);
+    }
+    return job->Queue(args[3]);
+  }
+
   md_len = 8192;  // Maximum key size is 8192 bits
   md_value = new unsigned char[md_len];
 
@@ -3395,6 +4174,17 @@ SignBase::Error Verify::VerifyFinal(const char* key_pem,
   if (!initialised_)
     return kSignNotInitialised;
 
+  initialised_ = false;
+  return VerifyFinal(&mdctx_, key_pem, key_pem_len, sig, siglen, verify_result);
+}
+
+
+SignBase::Error Verify::VerifyFinal(EVP_MD_CTX* mdctx,
+                                    const char* key_pem,
+                                    int key_pem_len,
+                                    const char* sig,
+                                    int siglen,
+                                    bool* verify_result) {
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence compiler warning.
 
@@ -3438,7 +4228,7 @@ SignBase::Error Verify::VerifyFinal(const char* key_pem,
   }
 
   fatal = false;
-  r = EVP_VerifyFinal(&mdctx_,
+  r = EVP_VerifyFinal(mdctx,
                       reinterpret_cast<const unsigned char*>(sig),
                       siglen,
                       pkey);
@@ -3451,8 +4241,7 @@ SignBase::Error Verify::VerifyFinal(const char* key_pem,
   if (x509 != nullptr)
     X509_free(x509);
 
-  EVP_MD_CTX_cleanup(&mdctx_);
-  initialised_ = false;
+  EVP_MD_CTX_cleanup(mdctx);
 
   if (fatal)
     return kSignPublicKey;
@@ -3462,6 +4251,68 @@ SignBase::Error Verify::VerifyFinal(const char* key_pem,
 }
 
 
+class VerifyJob : public CryptoJob {
+ public:
+  VerifyJob(Environment* env,
+            Local<Object> object,
+            const char* key_pem,
+            int key_pem_len,
+            const char* sig,
+            int siglen)
+      : CryptoJob(env, object),
+        key_pem_(Copy(key_pem, key_pem_len)),
+        key_pem_len_(key_pem_len),
+        sig_(Copy(sig, siglen)),
+        siglen_(siglen),
+        verify_result_(false),
+        error_(SignBase::kSignOk),
+        err_(0) {
+  }
+
+  ~VerifyJob() override {
+    delete[] key_pem_;
+    delete[] sig_;
+  }
+
+  // For SignBase::MoveContext(), Verify::VerifyFinal() cleans it up
+  inline EVP_MD_CTX* mdctx() {
+    return &mdctx_;
+  }
+
+ protected:
+  void DoWork() override {
+    error_ = Verify::VerifyFinal(&mdctx_,
+                                 key_pem_,
+                                 key_pem_len_,
+                                 sig_,
+                                 siglen_,
+                                 &verify_result_);
+    if (error_ != SignBase::kSignOk)
+      err_ = ERR_get_error();
+  }
+
+  void AfterWork(Local<Value> argv[2]) override {
+    if (error_ != SignBase::kSignOk) {
+      argv[0] = SignBase::ToException(env(), error_, err_);
+      argv[1] = Null(env()->isolate());
+    } else {
+      argv[0] = Null(env()->isolate());
+      argv[1] = Boolean::New(env()->isolate(), verify_result_);
+    }
+  }
+
+ private:
+  EVP_MD_CTX mdctx_;
+  char* key_pem_;
+  int key_pem_len_;
+  char* sig_;
+  int siglen_;
+  bool verify_result_;
+  SignBase::Error error_;
+  unsigned long err_;
+};
+
+
 void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -3497,6 +4348,24 @@ void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
     hbuf = Buffer::Data(args[1]);
   }
 
+  // verify(key, signature, encoding, callback) verifies on the threadpool
+  if (args[3]->IsFunction()) {
+    VerifyJob* job = new VerifyJob(env,
+                                   Object::New(env->isolate()),
+                                   kbuf,
+                                   klen,
+                                   hbuf,
+                                   hlen);
+    if (args[1]->IsString())
+      delete[] hbuf;
+    Error err = verify->MoveContext(job->mdctx());
+    if (err != kSignOk) {
+      delete job;
+      return verify->CheckThrow(err);
+    }
+    return job->Queue(args[3]);
+  }
+
   bool verify_result;
   Error err = verify->VerifyFinal(kbuf, klen, hbuf, hlen, &verify_result);
   if (args[1]->IsString())
@@ -3594,6 +4463,83 @@ bool PublicKeyCipher::Cipher(const char* key_pem,
 }
 
 
+template <PublicKeyCipher::Operation operation,
+          PublicKeyCipher::EVP_PKEY_cipher_init_t EVP_PKEY_cipher_init,
+          PublicKeyCipher::EVP_PKEY_cipher_t EVP_PKEY_cipher>
+class PublicKeyCipherJob : public CryptoJob {
+ public:
+  PublicKeyCipherJob(Environment* env,
+                     Local<Object> object,
+                     const char* key_pem,
+                     int key_pem_len,
+                     const char* passphrase,
+                     int padding,
+                     const char* data,
+                     int len)
+      : CryptoJob(env, object),
+        key_pem_(Copy(key_pem, key_pem_len)),
+        key_pem_len_(key_pem_len),
+        passphrase_(CopyString(passphrase)),
+        padding_(padding),
+        data_(Copy(data, len)),
+        len_(len),
+        out_(nullptr),
+        out_len_(0),
+        ok_(false),
+        err_(0) {
+  }
+
+  ~PublicKeyCipherJob() override {
+    delete[] key_pem_;
+    if (passphrase_ != nullptr) {
+      memset(passphrase_, 0, strlen(passphrase_));
+      delete[] passphrase_;
+    }
+    delete[] data_;
+    delete[] out_;
+  }
+
+ protected:
+  void DoWork() override {
+    ok_ = PublicKeyCipher::Cipher<operation,
+                                  EVP_PKEY_cipher_init,
+                                  EVP_PKEY_cipher>(
+        key_pem_,
+        key_pem_len_,
+        passphrase_,
+        padding_,
+        reinterpret_cast<const unsigned char*>(data_),
+        len_,
+        &out_,
+        &out_len_);
+    if (!ok_)
+      err_ = ERR_get_error();
+  }
+
+  void AfterWork(Local<Value> argv[2]) override {
+    if (!ok_) {
+      argv[0] = CryptoException(env(), err_);
+      argv[1] = Null(env()->isolate());
+    } else {
+      argv[0] = Null(env()->isolate());
+      argv[1] = Buffer::New(env(), reinterpret_cast<char*>(out_), out_len_);
+    }
+  }
+
+ private:
+  char* key_pem_;
+  int key_pem_len_;
+  char* passphrase_;
+  int padding_;
+  char* data_;
+  int len_;
+  unsigned char* out_;
+  size_t out_len_;
+  bool ok_;
+  unsigned long err_;
+};
+
+
 template <PublicKeyCipher::Operation operation,
           PublicKeyCipher::EVP_PKEY_cipher_init_t EVP_PKEY_cipher_init,
           PublicKeyCipher::EVP_PKEY_cipher_t EVP_PKEY_cipher>
@@ -3612,6 +4558,23 @@ void PublicKeyCipher::Cipher(const FunctionCallbackInfo<Value>& args) {
 
   String::Utf8Value passphrase(args[3]);
 
+  // The fifth argument is a callback for running on the threadpool
+  if (args[4]->IsFunction()) {
+    typedef PublicKeyCipherJob<operation,
+                               EVP_PKEY_cipher_init,
+                               EVP_PKEY_cipher> Job;
+    Job* job = new Job(
+        env,
+        Object::New(env->isolate()),
+        kbuf,
+        klen,
+        args.Length() >= 3 && !args[2]->IsNull() ? *passphrase : nullptr,
+        padding,
+        buf,
+        len);
+    return job->Queue(args[4]);
+  }
+
   unsigned char* out_value = nullptr;
   size_t out_len = 0;
 
@@ -3790,6 +4753,75 @@ void DiffieHellman::New(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Copies the parameters and the keys of `dh`.  Jobs work on a copy, the
+// object's keys can be replaced while they run.
+static DH* CopyDH(DH* dh) {
+  DH* copy = DHparams_dup(dh);
+  CHECK_NE(copy, nullptr);
+  if (dh->pub_key != nullptr) {
+    copy->pub_key = BN_dup(dh->pub_key);
+    CHECK_NE(copy->pub_key, nullptr);
+  }
+  if (dh->priv_key != nullptr) {
+    copy->priv_key = BN_dup(dh->priv_key);
+    CHECK_NE(copy->priv_key, nullptr);
+  }
+  return copy;
+}
+
+
+class DHGenerateKeysJob : public CryptoJob {
+ public:
+  // `object` keeps `diffieHellman` alive, which gets the new keys when the
+  // job is done
+  DHGenerateKeysJob(Environment* env,
+                    Local<Object> object,
+                    DiffieHellman* diffieHellman)
+      : CryptoJob(env, object),
+        diffieHellman_(diffieHellman),
+        dh_(CopyDH(diffieHellman->dh)),
+        ok_(false) {
+  }
+
+  ~DHGenerateKeysJob() override {
+    DH_free(dh_);
+  }
+
+ protected:
+  void DoWork() override {
+    ok_ = DH_generate_key(dh_);
+  }
+
+  void AfterWork(Local<Value> argv[2]) override {
+    if (!ok_) {
+      argv[0] = Exception::Error(
+          OneByteString(env()->isolate(), "Key generation failed"));
+      argv[1] = Null(env()->isolate());
+    } else {
+      Local<Object> pub_key =
+          Buffer::New(env(), BN_num_bytes(dh_->pub_key));
+      BN_bn2bin(dh_->pub_key,
+                reinterpret_cast<unsigned char*>(Buffer::Data(pub_key)));
+      argv[0] = Null(env()->isolate());
+      argv[1] = pub_key;
+
+      DH* dh = diffieHellman_->dh;
+      BN_free(dh->pub_key);
+      BN_free(dh->priv_key);
+      dh->pub_key = dh_->pub_key;
+      dh->priv_key = dh_->priv_key;
+      dh_->pub_key = nullptr;
+      dh_->priv_key = nullptr;
+    }
+  }
+
+ private:
+  DiffieHellman* diffieHellman_;
+  DH* dh_;
+  bool ok_;
+};
+
+
 void DiffieHellman::GenerateKeys(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -3799,6 +4831,14 @@ void DiffieHellman::GenerateKeys(const FunctionCallbackInfo<Value>& args) {
     return env->ThrowError("Not initialized");
   }
 
+  // generateKeys(callback) runs on the threadpool
+  if (args[0]->IsFunction()) {
+    Local<Object> obj = Object::New(env->isolate());
+    obj->Set(env->handle_string(), args.Holder());
+    DHGenerateKeysJob* job = new DHGenerateKeysJob(env, obj, diffieHellman);
+    return job->Queue(args[0]);
+  }
+
   if (!DH_generate_key(diffieHellman->dh)) {
     return env->ThrowError("Key generation failed");
   }
@@ -3895,60 +4935,34 @@ void DiffieHellman::GetPrivateKey(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-void DiffieHellman::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
+// Computes the secret into `data`, which has room for DH_size(dh) bytes.
+// Returns an error message on failure.  Does not touch V8.
+static const char* ComputeDHSecret(DH* dh, BIGNUM* key, char* data) {
+  int dataSize = DH_size(dh);
 
-  DiffieHellman* diffieHellman = Unwrap<DiffieHellman>(args.Holder());
-
-  if (!diffieHellman->initialised_) {
-    return env->ThrowError("Not initialized");
-  }
-
-  ClearErrorOnReturn clear_error_on_return;
-  (void) &clear_error_on_return;  // Silence compiler warning.
-  BIGNUM* key = nullptr;
-
-  if (args.Length() == 0) {
-    return env->ThrowError("First argument must be other party's public key");
-  } else {
-    THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
-    key = BN_bin2bn(
-        reinterpret_cast<unsigned char*>(Buffer::Data(args[0])),
-        Buffer::Length(args[0]),
-        0);
-  }
-
-  int dataSize = DH_size(diffieHellman->dh);
-  char* data = new char[dataSize];
-
-  int size = DH_compute_key(reinterpret_cast<unsigned char*>(data),
-                            key,
-                            diffieHellman->dh);
+  int size = DH_compute_key(reinterpret_cast<unsigned char*>(data), key, dh);
 
   if (size == -1) {
     int checkResult;
     int checked;
 
-    checked = DH_check_pub_key(diffieHellman->dh, key, &checkResult);
-    BN_free(key);
-    delete[] data;
+    checked = DH_check_pub_key(dh, key, &checkResult);
 
     if (!checked) {
-      return env->ThrowError("Invalid key");
+      return "Invalid key";
     } else if (checkResult) {
       if (checkResult & DH_CHECK_PUBKEY_TOO_SMALL) {
-        return env->ThrowError("Supplied key is too small");
+        return "Supplied key is too small";
       } else if (checkResult & DH_CHECK_PUBKEY_TOO_LARGE) {
-        return env->ThrowError("Supplied key is too large");
+        return "Supplied key is too large";
       } else {
-        return env->ThrowError("Invalid key");
+        return "Invalid key";
       }
     } else {
-      return env->ThrowError("Invalid key");
+      return "Invalid key";
     }
   }
 
-  BN_free(key);
   CHECK_GE(size, 0);
 
   // DH_size returns number of bytes in a prime number
@@ -3961,6 +4975,97 @@ void DiffieHellman::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
     memset(data, 0, dataSize - size);
   }
 
+  return nullptr;
+}
+
+
+class DHComputeSecretJob : public CryptoJob {
+ public:
+  // Copies `dh` and takes ownership of `key`
+  DHComputeSecretJob(Environment* env,
+                     Local<Object> object,
+                     DH* dh,
+                     BIGNUM* key)
+      : CryptoJob(env, object),
+        dh_(CopyDH(dh)),
+        key_(key),
+        data_(nullptr),
+        error_(nullptr) {
+  }
+
+  ~DHComputeSecretJob() override {
+    BN_free(key_);
+    DH_free(dh_);
+    delete[] data_;
+  }
+
+ protected:
+  void DoWork() override {
+    data_ = new char[DH_size(dh_)];
+    error_ = ComputeDHSecret(dh_, key_, data_);
+  }
+
+  void AfterWork(Local<Value> argv[2]) override {
+    if (error_ != nullptr) {
+      argv[0] = Exception::Error(OneByteString(env()->isolate(), error_));
+      argv[1] = Null(env()->isolate());
+    } else {
+      argv[0] = Null(env()->isolate());
+      argv[1] = Buffer::New(env(), data_, DH_size(dh_));
+    }
+  }
+
+ private:
+  DH* dh_;
+  BIGNUM* key_;
+  char* data_;
+  const char* error_;
+};
+
+
+void DiffieHellman::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  DiffieHellman* diffieHellman = Unwrap<DiffieHellman>(args.Holder());
+
+  if (!diffieHellman->initialised_) {
+    return env->ThrowError("Not initialized");
+  }
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+  BIGNUM* key = nullptr;
+
+  if (args.Length() == 0) {
+    return env->ThrowError("First argument must be other party's public key");
+  } else {
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[0]);
+    key = BN_bin2bn(
+        reinterpret_cast<unsigned char*>(Buffer::Data(args[0])),
+        Buffer::Length(args[0]),
+        0);
+  }
+
+  // computeSecret(key, callback) runs on the threadpool
+  if (args[1]->IsFunction()) {
+    DHComputeSecretJob* job =
+        new DHComputeSecretJob(env,
+                               Object::New(env->isolate()),
+                               diffieHellman->dh,
+                               key);
+    return job->Queue(args[1]);
+  }
+
+  int dataSize = DH_size(diffieHellman->dh);
+  char* data = new char[dataSize];
+
+  const char* error = ComputeDHSecret(diffieHellman->dh, key, data);
+  BN_free(key);
+  if (error != nullptr) {
+    delete[] data;
+    return env->ThrowError(error);
+  }
+
   args.GetReturnValue().Set(Encode(env->isolate(), data, dataSize, BUFFER));
   delete[] data;
 }
@@ -4106,6 +5211,58 @@ EC_POINT* ECDH::BufferToPoint(char* data, size_t len) {
 }
 
 
+class ECDHComputeSecretJob : public CryptoJob {
+ public:
+  // Copies `key`, the object's key can be replaced while the job runs, and
+  // takes ownership of `pub`
+  ECDHComputeSecretJob(Environment* env,
+                       Local<Object> object,
+                       EC_KEY* key,
+                       EC_POINT* pub,
+                       size_t out_len)
+      : CryptoJob(env, object),
+        key_(EC_KEY_dup(key)),
+        pub_(pub),
+        out_(nullptr),
+        out_len_(out_len),
+        ok_(false) {
+    CHECK_NE(key_, nullptr);
+  }
+
+  ~ECDHComputeSecretJob() override {
+    free(out_);
+    EC_POINT_free(pub_);
+    EC_KEY_free(key_);
+  }
+
+ protected:
+  void DoWork() override {
+    out_ = static_cast<char*>(malloc(out_len_));
+    CHECK_NE(out_, nullptr);
+    ok_ = ECDH_compute_key(out_, out_len_, pub_, key_, nullptr);
+  }
+
+  void AfterWork(Local<Value> argv[2]) override {
+    if (!ok_) {
+      argv[0] = Exception::Error(
+          OneByteString(env()->isolate(), "Failed to compute ECDH key"));
+      argv[1] = Null(env()->isolate());
+    } else {
+      argv[0] = Null(env()->isolate());
+      argv[1] = Buffer::Use(env(), out_, out_len_);
+      out_ = nullptr;
+    }
+  }
+
+ private:
+  EC_KEY* key_;
+  EC_POINT* pub_;
+  char* out_;
+  size_t out_len_;
+  bool ok_;
+};
+
+
 void ECDH::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -4121,6 +5278,18 @@ void ECDH::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
   // NOTE: field_size is in bits
   int field_size = EC_GROUP_get_degree(ecdh->group_);
   size_t out_len = (field_size + 7) / 8;
+
+  // computeSecret(key, callback) runs on the threadpool
+  if (args[1]->IsFunction()) {
+    ECDHComputeSecretJob* job =
+        new ECDHComputeSecretJob(env,
+                                 Object::New(env->isolate()),
+                                 ecdh->key_,
+                                 pub,
+                                 out_len);
+    return job->Queue(args[1]);
+  }
+
   char* out = static_cast<char*>(malloc(out_len));
   CHECK_NE(out, nullptr);
 
@@ -4479,10 +5648,11 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
     // XXX(trevnorris): This will need to go with the rest of domains.
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  EIO_PBKDF2,
-                  EIO_PBKDF2After);
+    uv_queue_work_class(env->event_loop(),
+                        req->work_req(),
+                        UV_THREADPOOL_CPU,
+                        EIO_PBKDF2,
+                        EIO_PBKDF2After);
   } else {
     Local<Value> argv[2];
     EIO_PBKDF2(req);
@@ -4634,10 +5804,11 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
     // XXX(trevnorris): This will need to go with the rest of domains.
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  RandomBytesWork,
-                  RandomBytesAfter);
+    uv_queue_work_class(env->event_loop(),
+                        req->work_req(),
+                        UV_THREADPOOL_CPU,
+                        RandomBytesWork,
+                        RandomBytesAfter);
     args.GetReturnValue().Set(obj);
   } else {
     Local<Value> argv[2];
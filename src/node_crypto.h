@@ -4,6 +4,7 @@
 #include "node.h"
 #include "node_crypto_clienthello.h"  // ClientHelloParser
 #include "node_crypto_clienthello-inl.h"
+#include "node_crypto_sni_map.h"
 
 #ifdef OPENSSL_NPN_NEGOTIATED
 #include "node_buffer.h"
@@ -60,6 +61,8 @@ class SecureContext : public BaseObject {
   SSL_CTX* ctx_;
   X509* cert_;
   X509* issuer_;
+  // Contexts for the SNI callback of servers that use this context
+  SNIMap sni_map_;
 
   static const int kMaxSessionSize = 10 * 1024;
 
@@ -80,10 +83,14 @@ class SecureContext : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetSessionTimeout(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableSharedSessionCache(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void LoadPKCS12(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void AddSNIContext(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetSNIContext(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CtxGetter(v8::Local<v8::String> property,
                         const v8::PropertyCallbackInfo<v8::Value>& info);
 
@@ -141,9 +148,11 @@ class SSLWrap {
         new_session_wait_(false) {
     ssl_ = SSL_new(sc->ctx_);
     CHECK_NE(ssl_, nullptr);
+    CHECK_EQ(0, uv_mutex_init(&ssl_mutex_));
   }
 
   virtual ~SSLWrap() {
+    uv_mutex_destroy(&ssl_mutex_);
     if (ssl_ != nullptr) {
       SSL_free(ssl_);
       ssl_ = nullptr;
@@ -169,6 +178,22 @@ class SSLWrap {
   inline bool is_waiting_new_session() const { return new_session_wait_; }
 
  protected:
+  // Held by the JS accessors of `ssl_` and by TLSWrap while it encrypts on
+  // the threadpool, so that the two never use `ssl_` at the same time.
+  class SSLLock {
+   public:
+    explicit SSLLock(SSLWrap* w) : mutex_(&w->ssl_mutex_) {
+      uv_mutex_lock(mutex_);
+    }
+    ~SSLLock() {
+      uv_mutex_unlock(mutex_);
+    }
+
+   private:
+    uv_mutex_t* const mutex_;
+    DISALLOW_COPY_AND_ASSIGN(SSLLock);
+  };
+
   static void InitNPN(SecureContext* sc);
   static void AddMethods(Environment* env, v8::Handle<v8::FunctionTemplate> t);
 
@@ -229,6 +254,7 @@ class SSLWrap {
   Kind kind_;
   SSL_SESSION* next_sess_;
   SSL* ssl_;
+  uv_mutex_t ssl_mutex_;
   bool session_callbacks_;
   bool new_session_wait_;
   ClientHelloParser hello_parser_;
@@ -260,6 +286,9 @@ class Connection : public SSLWrap<Connection>, public AsyncWrap {
 
   static void Initialize(Environment* env, v8::Handle<v8::Object> target);
   void NewSessionDoneCb();
+#ifdef SSL_set_max_send_fragment
+  int SetSendFragment(int size);
+#endif  // SSL_set_max_send_fragment
 
 #ifdef OPENSSL_NPN_NEGOTIATED
   v8::Persistent<v8::Object> npnProtos_;
@@ -362,6 +391,9 @@ class CipherBase : public BaseObject {
               const char* iv,
               int iv_len);
   bool Update(const char* data, int len, unsigned char** out, int* out_len);
+  // Writes into `out`, which has room for UpdateOutputSize(len) bytes
+  bool Update(const char* data, int len, unsigned char* out, int* out_len);
+  size_t UpdateOutputSize(size_t len) const;
   bool Final(unsigned char** out, int *out_len);
   bool SetAutoPadding(bool auto_padding);
 
@@ -374,6 +406,7 @@ class CipherBase : public BaseObject {
   static void Init(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void InitIv(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void UpdateInto(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Final(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAutoPadding(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -448,10 +481,19 @@ class Hash : public BaseObject {
   bool HashInit(const char* hash_type);
   bool HashUpdate(const char* data, int len);
 
+  // Same as EVP_get_digestbyname() but remembers the digests that were
+  // looked up recently.  Only call from the main thread.
+  static const EVP_MD* GetDigest(const char* hash_type);
+
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HashUpdate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HashDigest(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // hash(algorithm, data, encoding), digests `data` without creating an object
+  static void OneShot(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // hashMany(algorithm, inputs, encoding, callback), digests buffers and
+  // file descriptors on the threadpool
+  static void HashMany(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   Hash(Environment* env, v8::Local<v8::Object> wrap)
       : BaseObject(env, wrap),
@@ -490,6 +532,17 @@ class SignBase : public BaseObject {
     EVP_MD_CTX_cleanup(&mdctx_);
   }
 
+  // Hands the digest state over to `mdctx`, which has to be cleaned up by
+  // the caller, e.g. to finish the operation on the threadpool.  The object
+  // is not initialised anymore afterwards.
+  Error MoveContext(EVP_MD_CTX* mdctx);
+
+  // `err` is the OpenSSL error that came with `error`, or 0
+  static v8::Local<v8::Value> ToException(
+      Environment* env,
+      Error error,
+      unsigned long err);  // NOLINT(runtime/int)
+
  protected:
   void CheckThrow(Error error);
 
@@ -510,6 +563,13 @@ class Sign : public SignBase {
                   const char* passphrase,
                   unsigned char** sig,
                   unsigned int *sig_len);
+  // Cleans up `mdctx`, does not touch V8 or the object state
+  static Error SignFinal(EVP_MD_CTX* mdctx,
+                         const char* key_pem,
+                         int key_pem_len,
+                         const char* passphrase,
+                         unsigned char** sig,
+                         unsigned int *sig_len);
 
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -533,6 +593,13 @@ class Verify : public SignBase {
                     const char* sig,
                     int siglen,
                     bool* verify_result);
+  // Cleans up `mdctx`, does not touch V8 or the object state
+  static Error VerifyFinal(EVP_MD_CTX* mdctx,
+                           const char* key_pem,
+                           int key_pem_len,
+                           const char* sig,
+                           int siglen,
+                           bool* verify_result);
 
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -619,6 +686,8 @@ class DiffieHellman : public BaseObject {
   bool initialised_;
   int verifyError_;
   DH* dh;
+
+  friend class DHGenerateKeysJob;
 };
 
 class ECDH : public BaseObject {
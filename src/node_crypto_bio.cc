@@ -109,6 +109,17 @@ size_t NodeBIO::PeekMultiple(char** out, size_t* size, size_t* count) {
 }
 
 
+size_t NodeBIO::ChunkCount() const {
+  if (read_head_ == nullptr)
+    return 0;
+
+  size_t count = 1;
+  for (Buffer* pos = read_head_; pos != write_head_; pos = pos->next_)
+    count++;
+  return count;
+}
+
+
 int NodeBIO::Write(BIO* bio, const char* data, int len) {
   BIO_clear_retry_flags(bio);
 
@@ -46,6 +46,10 @@ class NodeBIO {
   // reading
   size_t PeekMultiple(char** out, size_t* size, size_t* count);
 
+  // Return number of internal data chunks that PeekMultiple() would return
+  // without a limit
+  size_t ChunkCount() const;
+
   // Find first appearance of `delim` in buffer or `limit` if `delim`
   // wasn't found.
   size_t IndexOf(char delim, size_t limit);
@@ -89,7 +93,7 @@ class NodeBIO {
 
   // Enough to handle the most of the client hellos
   static const size_t kInitialBufferLength = 1024;
-  static const size_t kThroughputBufferLength = 16384;
+  static const size_t kThroughputBufferLength = ChunkPool::kChunkSize;
 
   static const BIO_METHOD method;
 
@@ -100,19 +104,32 @@ class NodeBIO {
                                            write_pos_(0),
                                            len_(len),
                                            next_(nullptr) {
-      data_ = new char[len];
+      // Throughput sized buffers are recycled across connections.  Buffers
+      // without an environment may be allocated off the main thread and
+      // never come from the pool.
+      if (IsPooled())
+        data_ = env_->bio_chunk_pool()->Allocate();
+      else
+        data_ = new char[len];
       if (env_ != nullptr)
         env_->isolate()->AdjustAmountOfExternalAllocatedMemory(len);
     }
 
     ~Buffer() {
-      delete[] data_;
+      if (IsPooled())
+        env_->bio_chunk_pool()->Release(data_);
+      else
+        delete[] data_;
       if (env_ != nullptr) {
         const int64_t len = static_cast<int64_t>(len_);
         env_->isolate()->AdjustAmountOfExternalAllocatedMemory(-len);
       }
     }
 
+    inline bool IsPooled() const {
+      return env_ != nullptr && len_ == ChunkPool::kChunkSize;
+    }
+
     Environment* env_;
     size_t read_pos_;
     size_t write_pos_;
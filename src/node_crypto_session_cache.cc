@@ -0,0 +1,328 @@
+#include "node_crypto_session_cache.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
+namespace node {
+
+// "NSC1", a zero filled file is an empty cache and gets stamped on open
+static const uint32_t kMagic = 0x4e534331;
+
+struct SharedSessionCache::Header {
+  uint32_t magic;
+  uint32_t reserved[15];
+};
+
+struct SharedSessionCache::Entry {
+  uint64_t last_used;
+  int64_t expires;
+  uint32_t id_length;
+  // Zero for free entries
+  uint32_t session_length;
+  unsigned char id[SSL_MAX_SSL_SESSION_ID_LENGTH];
+  unsigned char session[kMaxSessionSize];
+};
+
+struct SharedSessionCache::Set {
+  // Pid of the process that holds the lock, zero when it's free
+  uint32_t lock;
+  uint32_t reserved;
+  uint64_t clock;
+  Entry entries[kWays];
+};
+
+int SharedSessionCache::ex_index_ = -1;
+
+
+#ifdef _WIN32
+// Open() always fails, there is nothing to lock
+void SharedSessionCache::Lock(Set* set) {
+}
+
+
+void SharedSessionCache::Unlock(Set* set) {
+}
+#else
+// The lock holds the pid of its owner.  A process that dies while holding
+// it, e.g. one that got SIGKILLed, would block every other process that
+// maps the file forever.  Waiters check the owner now and then and take the
+// lock over once it's gone.  The dead owner may have been halfway through
+// an entry so the set is emptied.
+void SharedSessionCache::Lock(Set* set) {
+  uint32_t self = static_cast<uint32_t>(getpid());
+  unsigned int spins = 0;
+
+  for (;;) {
+    uint32_t owner = __sync_val_compare_and_swap(&set->lock, 0, self);
+    if (owner == 0)
+      return;
+
+    // Check the owner every so often, kill() is a system call
+    if (++spins % 256 == 0 &&
+        kill(static_cast<pid_t>(owner), 0) == -1 &&
+        errno == ESRCH &&
+        __sync_bool_compare_and_swap(&set->lock, owner, self)) {
+      for (size_t i = 0; i < kWays; i++)
+        set->entries[i].session_length = 0;
+      return;
+    }
+
+    sched_yield();
+  }
+}
+
+
+void SharedSessionCache::Unlock(Set* set) {
+  __sync_lock_release(&set->lock);
+}
+#endif  // _WIN32
+
+
+SharedSessionCache::SharedSessionCache(Header* header,
+                                       size_t size,
+                                       size_t set_count)
+    : header_(header),
+      size_(size),
+      set_count_(set_count) {
+}
+
+
+SharedSessionCache::~SharedSessionCache() {
+#ifndef _WIN32
+  munmap(header_, size_);
+#endif  // !_WIN32
+  header_ = nullptr;
+}
+
+
+SharedSessionCache* SharedSessionCache::Open(const char* path,
+                                             size_t size,
+                                             int* err,
+                                             const char** syscall) {
+#ifdef _WIN32
+  *err = ENOSYS;
+  *syscall = "mmap";
+  return nullptr;
+#else
+  size_t set_count = (size + kWays - 1) / kWays;
+  if (set_count == 0)
+    set_count = 1;
+
+  int fd = open(path, O_RDWR | O_CREAT, 0600);
+  if (fd == -1) {
+    *err = errno;
+    *syscall = "open";
+    return nullptr;
+  }
+
+  // Whoever comes first picks the size, the rest use the existing file
+  struct stat s;
+  if (flock(fd, LOCK_EX) == -1) {
+    *syscall = "flock";
+  } else if (fstat(fd, &s) == -1) {
+    *syscall = "fstat";
+  } else if (s.st_size == 0 &&
+             ftruncate(fd, sizeof(Header) + set_count * sizeof(Set)) == -1) {
+    *syscall = "ftruncate";
+  } else if (fstat(fd, &s) == -1) {
+    *syscall = "fstat";
+  } else {
+    *syscall = nullptr;
+  }
+  *err = errno;
+  flock(fd, LOCK_UN);
+
+  if (*syscall != nullptr) {
+    close(fd);
+    return nullptr;
+  }
+
+  size_t file_size = static_cast<size_t>(s.st_size);
+  if (file_size < sizeof(Header) + sizeof(Set)) {
+    close(fd);
+    *err = EINVAL;
+    *syscall = "open";
+    return nullptr;
+  }
+
+  void* data = mmap(nullptr,
+                    file_size,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED,
+                    fd,
+                    0);
+  *err = errno;
+  close(fd);
+  if (data == MAP_FAILED) {
+    *syscall = "mmap";
+    return nullptr;
+  }
+
+  Header* header = static_cast<Header*>(data);
+  if (!__sync_bool_compare_and_swap(&header->magic, 0, kMagic) &&
+      header->magic != kMagic) {
+    munmap(data, file_size);
+    *err = EINVAL;
+    *syscall = "open";
+    return nullptr;
+  }
+
+  set_count = (file_size - sizeof(Header)) / sizeof(Set);
+  return new SharedSessionCache(header, file_size, set_count);
+#endif  // _WIN32
+}
+
+
+void SharedSessionCache::FreeCallback(void* parent,
+                                      void* ptr,
+                                      CRYPTO_EX_DATA* ad,
+                                      int idx,
+                                      long argl,  // NOLINT(runtime/int)
+                                      void* argp) {
+  delete static_cast<SharedSessionCache*>(ptr);
+}
+
+
+void SharedSessionCache::Attach(SSL_CTX* ctx, SharedSessionCache* cache) {
+  if (ex_index_ == -1) {
+    ex_index_ = SSL_CTX_get_ex_new_index(0,
+                                         nullptr,
+                                         nullptr,
+                                         nullptr,
+                                         FreeCallback);
+    CHECK_NE(ex_index_, -1);
+  }
+
+  delete FromContext(ctx);
+  SSL_CTX_set_ex_data(ctx, ex_index_, cache);
+}
+
+
+SharedSessionCache* SharedSessionCache::FromContext(SSL_CTX* ctx) {
+  if (ex_index_ == -1)
+    return nullptr;
+  return static_cast<SharedSessionCache*>(SSL_CTX_get_ex_data(ctx, ex_index_));
+}
+
+
+SharedSessionCache::Set* SharedSessionCache::SetFor(const unsigned char* id,
+                                                    unsigned int len) {
+  // FNV-1a, session ids are random anyway
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < len; i++) {
+    hash ^= id[i];
+    hash *= 16777619u;
+  }
+
+  Set* sets = reinterpret_cast<Set*>(header_ + 1);
+  return &sets[hash % set_count_];
+}
+
+
+void SharedSessionCache::Add(SSL_SESSION* sess) {
+  unsigned int id_length;
+  const unsigned char* id = SSL_SESSION_get_id(sess, &id_length);
+  if (id_length == 0 || id_length > SSL_MAX_SSL_SESSION_ID_LENGTH)
+    return;
+
+  int size = i2d_SSL_SESSION(sess, nullptr);
+  if (size <= 0 || static_cast<size_t>(size) > kMaxSessionSize)
+    return;
+
+  // Serialize outside of the lock
+  unsigned char session[kMaxSessionSize];
+  unsigned char* p = session;
+  i2d_SSL_SESSION(sess, &p);
+
+  int64_t now = time(nullptr);
+  int64_t expires = SSL_SESSION_get_time(sess) + SSL_SESSION_get_timeout(sess);
+  if (expires <= now)
+    return;
+
+  Set* set = SetFor(id, id_length);
+  Lock(set);
+
+  // Same session, a free or expired entry, or the least recently used one
+  Entry* victim = &set->entries[0];
+  for (size_t i = 0; i < kWays; i++) {
+    Entry* entry = &set->entries[i];
+    if (entry->session_length != 0 &&
+        entry->id_length == id_length &&
+        memcmp(entry->id, id, id_length) == 0) {
+      victim = entry;
+      break;
+    }
+    if (entry->session_length == 0 || entry->expires <= now) {
+      victim = entry;
+      continue;
+    }
+    if (victim->session_length != 0 &&
+        victim->expires > now &&
+        entry->last_used < victim->last_used) {
+      victim = entry;
+    }
+  }
+
+  victim->last_used = ++set->clock;
+  victim->expires = expires;
+  victim->id_length = id_length;
+  victim->session_length = size;
+  memcpy(victim->id, id, id_length);
+  memcpy(victim->session, session, size);
+
+  Unlock(set);
+}
+
+
+SSL_SESSION* SharedSessionCache::Get(const unsigned char* id, int len) {
+  if (len <= 0 || len > SSL_MAX_SSL_SESSION_ID_LENGTH)
+    return nullptr;
+
+  unsigned char session[kMaxSessionSize];
+  size_t size = 0;
+  int64_t now = time(nullptr);
+
+  Set* set = SetFor(id, len);
+  Lock(set);
+
+  for (size_t i = 0; i < kWays; i++) {
+    Entry* entry = &set->entries[i];
+    if (entry->session_length == 0 ||
+        entry->id_length != static_cast<uint32_t>(len) ||
+        memcmp(entry->id, id, len) != 0) {
+      continue;
+    }
+
+    if (entry->expires <= now) {
+      entry->session_length = 0;
+    } else {
+      entry->last_used = ++set->clock;
+      size = entry->session_length;
+      memcpy(session, entry->session, size);
+    }
+    break;
+  }
+
+  Unlock(set);
+
+  if (size == 0)
+    return nullptr;
+
+  const unsigned char* p = session;
+  return d2i_SSL_SESSION(nullptr, &p, size);
+}
+
+}  // namespace node
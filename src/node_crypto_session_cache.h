@@ -0,0 +1,78 @@
+#ifndef SRC_NODE_CRYPTO_SESSION_CACHE_H_
+#define SRC_NODE_CRYPTO_SESSION_CACHE_H_
+
+#include "util.h"
+
+#include <openssl/ssl.h>
+#include <stddef.h>  // size_t
+#include <stdint.h>
+
+namespace node {
+
+// TLS session cache that lives in a memory mapped file.  Every process that
+// maps the same file, e.g. the workers of a cluster, can resume the sessions
+// that the others have created.
+//
+// The file holds a set associative hash table: the session id picks a set
+// and the session is stored in one of its kWays entries, replacing an
+// expired entry or the least recently used one.  Each set is guarded by its
+// own spinlock, which is only held to copy an entry in or out.  The lock
+// records its owner's pid so that it can be taken over when the owner dies.
+class SharedSessionCache {
+ public:
+  // Number of entries in a set
+  static const size_t kWays = 8;
+
+  // Maximum size of a DER encoded session, larger ones are not shared
+  static const size_t kMaxSessionSize = 1992;
+
+  ~SharedSessionCache();
+
+  // Maps the cache file at `path`, creating it with room for about `size`
+  // sessions if it doesn't exist yet.  Returns nullptr on error, in which
+  // case `*err` is set to an errno value and `*syscall` to the failed call.
+  static SharedSessionCache* Open(const char* path,
+                                  size_t size,
+                                  int* err,
+                                  const char** syscall);
+
+  // Makes `ctx` use `cache` from its session callbacks.  The context takes
+  // ownership of the cache and frees it together with itself.
+  static void Attach(SSL_CTX* ctx, SharedSessionCache* cache);
+  static SharedSessionCache* FromContext(SSL_CTX* ctx);
+
+  void Add(SSL_SESSION* sess);
+
+  // Returns a new reference to the session or nullptr
+  SSL_SESSION* Get(const unsigned char* id, int len);
+
+ private:
+  struct Header;
+  struct Entry;
+  struct Set;
+
+  SharedSessionCache(Header* header, size_t size, size_t set_count);
+
+  Set* SetFor(const unsigned char* id, unsigned int len);
+  static void Lock(Set* set);
+  static void Unlock(Set* set);
+
+  static void FreeCallback(void* parent,
+                           void* ptr,
+                           CRYPTO_EX_DATA* ad,
+                           int idx,
+                           long argl,  // NOLINT(runtime/int)
+                           void* argp);
+
+  static int ex_index_;
+
+  Header* header_;
+  size_t size_;
+  size_t set_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedSessionCache);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_CRYPTO_SESSION_CACHE_H_
@@ -0,0 +1,178 @@
+#include "node_crypto_sni_map.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <string.h>
+
+namespace node {
+
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::Persistent;
+
+struct SNIMap::Entry {
+  Entry* next;
+  uint32_t hash;
+  bool wildcard;
+  size_t len;
+  // Lower case, wildcards without the leading "*."
+  char* name;
+  Persistent<Object> context;
+};
+
+
+static inline char ToLower(char c) {
+  return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+
+static bool EqualsLower(const char* lower, const char* name, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (lower[i] != ToLower(name[i]))
+      return false;
+  }
+  return true;
+}
+
+
+SNIMap::SNIMap() : buckets_(nullptr), bucket_count_(0), size_(0) {
+}
+
+
+SNIMap::~SNIMap() {
+  for (size_t i = 0; i < bucket_count_; i++) {
+    Entry* entry = buckets_[i];
+    while (entry != nullptr) {
+      Entry* next = entry->next;
+      entry->context.Reset();
+      delete[] entry->name;
+      delete entry;
+      entry = next;
+    }
+  }
+  delete[] buckets_;
+}
+
+
+bool SNIMap::IsSupported(const char* name, size_t len) {
+  if (len >= 2 && name[0] == '*' && name[1] == '.') {
+    name += 2;
+    len -= 2;
+  }
+  if (len == 0)
+    return false;
+  return memchr(name, '*', len) == nullptr;
+}
+
+
+// FNV-1a over the lower case name, wildcards hash differently than the exact
+// name of their parent domain
+uint32_t SNIMap::Hash(const char* name, size_t len, bool wildcard) {
+  uint32_t hash = wildcard ? 0x050c5d1f : 0x811c9dc5;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= static_cast<unsigned char>(ToLower(name[i]));
+    hash *= 0x01000193;
+  }
+  return hash;
+}
+
+
+SNIMap::Entry* SNIMap::Find(const char* name,
+                            size_t len,
+                            bool wildcard) const {
+  if (size_ == 0)
+    return nullptr;
+
+  uint32_t hash = Hash(name, len, wildcard);
+  Entry* entry = buckets_[hash & (bucket_count_ - 1)];
+  for (; entry != nullptr; entry = entry->next) {
+    if (entry->hash == hash &&
+        entry->wildcard == wildcard &&
+        entry->len == len &&
+        EqualsLower(entry->name, name, len)) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+
+void SNIMap::Grow() {
+  size_t bucket_count = bucket_count_ == 0 ? 64 : bucket_count_ * 2;
+  Entry** buckets = new Entry*[bucket_count]();
+
+  for (size_t i = 0; i < bucket_count_; i++) {
+    Entry* entry = buckets_[i];
+    while (entry != nullptr) {
+      Entry* next = entry->next;
+      Entry** bucket = &buckets[entry->hash & (bucket_count - 1)];
+      entry->next = *bucket;
+      *bucket = entry;
+      entry = next;
+    }
+  }
+
+  delete[] buckets_;
+  buckets_ = buckets;
+  bucket_count_ = bucket_count;
+}
+
+
+void SNIMap::Add(Isolate* isolate,
+                 const char* name,
+                 size_t len,
+                 Local<Object> context) {
+  CHECK(IsSupported(name, len));
+
+  bool wildcard = name[0] == '*';
+  if (wildcard) {
+    name += 2;
+    len -= 2;
+  }
+
+  Entry* entry = Find(name, len, wildcard);
+  if (entry != nullptr) {
+    entry->context.Reset(isolate, context);
+    return;
+  }
+
+  // Keep the load factor at or below one
+  if (size_ == bucket_count_)
+    Grow();
+
+  entry = new Entry;
+  entry->hash = Hash(name, len, wildcard);
+  entry->wildcard = wildcard;
+  entry->len = len;
+  entry->name = new char[len];
+  for (size_t i = 0; i < len; i++)
+    entry->name[i] = ToLower(name[i]);
+  entry->context.Reset(isolate, context);
+
+  Entry** bucket = &buckets_[entry->hash & (bucket_count_ - 1)];
+  entry->next = *bucket;
+  *bucket = entry;
+  size_++;
+}
+
+
+Local<Object> SNIMap::Lookup(Isolate* isolate,
+                             const char* servername,
+                             size_t len) const {
+  Entry* entry = Find(servername, len, false);
+  if (entry == nullptr) {
+    // "*.example.com" matches "www.example.com" but not "example.com"
+    const char* dot = static_cast<const char*>(memchr(servername, '.', len));
+    if (dot != nullptr && dot != servername) {
+      size_t offset = dot + 1 - servername;
+      entry = Find(dot + 1, len - offset, true);
+    }
+  }
+
+  if (entry == nullptr)
+    return Local<Object>();
+  return PersistentToLocal(isolate, entry->context);
+}
+
+}  // namespace node
@@ -0,0 +1,57 @@
+#ifndef SRC_NODE_CRYPTO_SNI_MAP_H_
+#define SRC_NODE_CRYPTO_SNI_MAP_H_
+
+#include "v8.h"
+
+#include <stddef.h>  // size_t
+#include <stdint.h>
+
+namespace node {
+
+// Maps server names to SecureContext objects, so that the SNI callback of a
+// server can pick a context without calling into JS.
+//
+// A name is either exact, "www.example.com", or a wildcard for a single
+// label, "*.example.com".  Both kinds live in one hash table, a wildcard is
+// stored under its parent domain with a flag set.  A lookup tries the exact
+// name first and then the wildcard of its parent.  Names are compared case
+// insensitively.
+class SNIMap {
+ public:
+  SNIMap();
+  ~SNIMap();
+
+  // Whether `name` is an exact name or a wildcard that Add() understands
+  static bool IsSupported(const char* name, size_t len);
+
+  // Maps `name` to `context`, replacing an earlier entry for the same name.
+  // `name` must be supported.
+  void Add(v8::Isolate* isolate,
+           const char* name,
+           size_t len,
+           v8::Local<v8::Object> context);
+
+  // Returns an empty handle when nothing matches `servername`
+  v8::Local<v8::Object> Lookup(v8::Isolate* isolate,
+                               const char* servername,
+                               size_t len) const;
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  struct Entry;
+
+  static uint32_t Hash(const char* name, size_t len, bool wildcard);
+  Entry* Find(const char* name, size_t len, bool wildcard) const;
+  void Grow();
+
+  Entry** buckets_;
+  size_t bucket_count_;
+  size_t size_;
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_CRYPTO_SNI_MAP_H_
@@ -18,6 +18,8 @@
 #include <errno.h>
 #include <limits.h>
 
+#include <limits>
+
 #if defined(__MINGW32__) || defined(_MSC_VER)
 # include <io.h>
 #endif
@@ -25,15 +27,19 @@
 namespace node {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
+using v8::Null;
 using v8::Number;
 using v8::Object;
 using v8::String;
@@ -127,6 +133,45 @@ static inline bool IsInt64(double x) {
 }
 
 
+// Appends the names of the entries of a finished scandir request to |names|,
+// and their types to |types| unless it is empty.  Returns 0 or a libuv error.
+static int ReadDirEntries(Environment* env,
+                          uv_fs_t* req,
+                          Local<Array> names,
+                          Local<Array> types) {
+  Isolate* isolate = env->isolate();
+  // Indexed by uv_dirent_type_t
+  static const char* const kTypeNames[] = {
+    "unknown", "file", "directory", "symlink", "fifo", "socket", "char", "block"
+  };
+  Local<String> type_names[ARRAY_SIZE(kTypeNames)];
+  if (!types.IsEmpty()) {
+    for (size_t i = 0; i < ARRAY_SIZE(kTypeNames); i++)
+      type_names[i] = OneByteString(isolate, kTypeNames[i]);
+  }
+
+  for (int i = 0; ; i++) {
+    uv_dirent_t ent;
+
+    int r = uv_fs_scandir_next(req, &ent);
+    if (r == UV_EOF)
+      break;
+    if (r != 0)
+      return r;
+
+    names->Set(i, String::NewFromUtf8(isolate, ent.name));
+    if (!types.IsEmpty()) {
+      size_t type = ent.type;
+      if (type >= ARRAY_SIZE(type_names))
+        type = UV_DIRENT_UNKNOWN;
+      types->Set(i, type_names[type]);
+    }
+  }
+
+  return 0;
+}
+
+
 static void After(uv_fs_t *req) {
   FSReqWrap* req_wrap = static_cast<FSReqWrap*>(req->data);
   CHECK_EQ(&req_wrap->req_, req);
@@ -211,28 +256,14 @@ static void After(uv_fs_t *req) {
 
       case UV_FS_SCANDIR:
         {
-          int r;
           Local<Array> names = Array::New(env->isolate(), 0);
-
-          for (int i = 0; ; i++) {
-            uv_dirent_t ent;
-
-            r = uv_fs_scandir_next(req, &ent);
-            if (r == UV_EOF)
-              break;
-            if (r != 0) {
-              argv[0] = UVException(r,
-                                    nullptr,
-                                    req_wrap->syscall(),
-                                    static_cast<const char*>(req->path));
-              break;
-            }
-
-            Local<String> name = String::NewFromUtf8(env->isolate(),
-                                                     ent.name);
-            names->Set(i, name);
+          int r = ReadDirEntries(env, req, names, Local<Array>());
+          if (r != 0) {
+            argv[0] = UVException(r,
+                                  nullptr,
+                                  req_wrap->syscall(),
+                                  static_cast<const char*>(req->path));
           }
-
           argv[1] = names;
         }
         break;
@@ -432,6 +463,58 @@ Local<Value> BuildStatsObject(Environment* env, const uv_stat_t* s) {
   return handle_scope.Escape(stats);
 }
 
+void FillStatsArray(double* fields, const uv_stat_t* s) {
+  fields[0] = static_cast<double>(s->st_dev);
+  fields[1] = static_cast<double>(s->st_mode);
+  fields[2] = static_cast<double>(s->st_nlink);
+  fields[3] = static_cast<double>(s->st_uid);
+  fields[4] = static_cast<double>(s->st_gid);
+  fields[5] = static_cast<double>(s->st_rdev);
+#if defined(__POSIX__)
+  fields[6] = static_cast<double>(s->st_blksize);
+#else
+  fields[6] = std::numeric_limits<double>::quiet_NaN();
+#endif
+  fields[7] = static_cast<double>(s->st_ino);
+  fields[8] = static_cast<double>(s->st_size);
+#if defined(__POSIX__)
+  fields[9] = static_cast<double>(s->st_blocks);
+#else
+  fields[9] = std::numeric_limits<double>::quiet_NaN();
+#endif
+  // Milliseconds, rounded the same way as in BuildStatsObject()
+#define X(index, name)                                                        \
+  fields[index] = (static_cast<double>(s->st_##name.tv_sec) * 1000) +         \
+                  (static_cast<double>(s->st_##name.tv_nsec / 1000000));      \
+
+  X(10, atim)
+  X(11, mtim)
+  X(12, ctim)
+  X(13, birthtim)
+#undef X
+}
+
+double* Float64ArrayData(Local<Float64Array> array) {
+  array->Buffer();
+  void* data = array->GetIndexedPropertiesExternalArrayData();
+  CHECK_NE(data, nullptr);
+  return static_cast<double*>(data);
+}
+
+// Fills in the Float64Array that the caller passed as the third argument,
+// or returns a new fs.Stats object when there is none.
+static void SetStatsResult(Environment* env,
+                           const FunctionCallbackInfo<Value>& args,
+                           const uv_stat_t* s) {
+  if (args[2]->IsFloat64Array()) {
+    Local<Float64Array> values = args[2].As<Float64Array>();
+    CHECK_GE(values->Length(), kStatsFieldCount);
+    FillStatsArray(Float64ArrayData(values), s);
+  } else {
+    args.GetReturnValue().Set(BuildStatsObject(env, s));
+  }
+}
+
 static void Stat(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -446,8 +529,7 @@ static void Stat(const FunctionCallbackInfo<Value>& args) {
     ASYNC_CALL(stat, args[1], *path)
   } else {
     SYNC_CALL(stat, *path, *path)
-    args.GetReturnValue().Set(
-        BuildStatsObject(env, static_cast<const uv_stat_t*>(SYNC_REQ.ptr)));
+    SetStatsResult(env, args, static_cast<const uv_stat_t*>(SYNC_REQ.ptr));
   }
 }
 
@@ -465,8 +547,7 @@ static void LStat(const FunctionCallbackInfo<Value>& args) {
     ASYNC_CALL(lstat, args[1], *path)
   } else {
     SYNC_CALL(lstat, *path, *path)
-    args.GetReturnValue().Set(
-        BuildStatsObject(env, static_cast<const uv_stat_t*>(SYNC_REQ.ptr)));
+    SetStatsResult(env, args, static_cast<const uv_stat_t*>(SYNC_REQ.ptr));
   }
 }
 
@@ -483,11 +564,283 @@ static void FStat(const FunctionCallbackInfo<Value>& args) {
     ASYNC_CALL(fstat, args[1], fd)
   } else {
     SYNC_CALL(fstat, 0, fd)
-    args.GetReturnValue().Set(
-        BuildStatsObject(env, static_cast<const uv_stat_t*>(SYNC_REQ.ptr)));
+    SetStatsResult(env, args, static_cast<const uv_stat_t*>(SYNC_REQ.ptr));
+  }
+}
+
+#if defined(__POSIX__)
+// stat() or lstat() into a uv_stat_t, filled in the way uv_fs_stat() and
+// uv_fs_lstat() do it.  Returns 0 or a negative errno.  The uv_fs_*() calls
+// need a loop even when they are synchronous, this doesn't.
+static int StatPath(const char* path, bool lstat, uv_stat_t* s) {
+  struct stat st;
+  if ((lstat ? ::lstat(path, &st) : ::stat(path, &st)) != 0)
+    return -errno;
+
+  memset(s, 0, sizeof(*s));
+  s->st_dev = st.st_dev;
+  s->st_mode = st.st_mode;
+  s->st_nlink = st.st_nlink;
+  s->st_uid = st.st_uid;
+  s->st_gid = st.st_gid;
+  s->st_rdev = st.st_rdev;
+  s->st_ino = st.st_ino;
+  s->st_size = st.st_size;
+  s->st_blksize = st.st_blksize;
+  s->st_blocks = st.st_blocks;
+#if defined(__APPLE__)
+  s->st_atim.tv_sec = st.st_atimespec.tv_sec;
+  s->st_atim.tv_nsec = st.st_atimespec.tv_nsec;
+  s->st_mtim.tv_sec = st.st_mtimespec.tv_sec;
+  s->st_mtim.tv_nsec = st.st_mtimespec.tv_nsec;
+  s->st_ctim.tv_sec = st.st_ctimespec.tv_sec;
+  s->st_ctim.tv_nsec = st.st_ctimespec.tv_nsec;
+  s->st_birthtim.tv_sec = st.st_birthtimespec.tv_sec;
+  s->st_birthtim.tv_nsec = st.st_birthtimespec.tv_nsec;
+#elif !defined(_AIX)
+  s->st_atim.tv_sec = st.st_atim.tv_sec;
+  s->st_atim.tv_nsec = st.st_atim.tv_nsec;
+  s->st_mtim.tv_sec = st.st_mtim.tv_sec;
+  s->st_mtim.tv_nsec = st.st_mtim.tv_nsec;
+  s->st_ctim.tv_sec = st.st_ctim.tv_sec;
+  s->st_ctim.tv_nsec = st.st_ctim.tv_nsec;
+# if defined(__DragonFly__) || defined(__FreeBSD__) || \
+     defined(__OpenBSD__) || defined(__NetBSD__)
+  s->st_birthtim.tv_sec = st.st_birthtim.tv_sec;
+  s->st_birthtim.tv_nsec = st.st_birthtim.tv_nsec;
+# else
+  s->st_birthtim = s->st_ctim;
+# endif
+#else
+  s->st_atim.tv_sec = st.st_atime;
+  s->st_mtim.tv_sec = st.st_mtime;
+  s->st_ctim.tv_sec = st.st_ctime;
+  s->st_birthtim.tv_sec = st.st_ctime;
+#endif
+  return 0;
+}
+#endif  // defined(__POSIX__)
+
+
+// Runs stat() or lstat() for a list of paths on the threadpool.  A few work
+// requests share the list, each takes a batch of paths at a time.  The
+// results go straight into the Float64Array that is passed to the callback.
+class StatManyJob : public AsyncWrap {
+ public:
+  StatManyJob(Environment* env,
+              Local<Object> object,
+              bool lstat,
+              char* paths,
+              size_t* offsets,
+              int* errors,
+              size_t count,
+              double* fields)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_FSREQWRAP),
+        lstat_(lstat),
+        paths_(paths),
+        offsets_(offsets),
+        errors_(errors),
+        count_(count),
+        fields_(fields),
+        work_reqs_(nullptr),
+        pending_(0),
+        next_(0) {
+    CHECK_EQ(uv_mutex_init(&mutex_), 0);
+  }
+
+  ~StatManyJob() override {
+    uv_mutex_destroy(&mutex_);
+    delete[] paths_;
+    delete[] offsets_;
+    delete[] errors_;
+    delete[] work_reqs_;
+    persistent().Reset();
+  }
+
+  void Queue(Local<Value> callback) {
+    Local<Object> obj = object();
+    obj->Set(env()->ondone_string(), callback);
+    // XXX(trevnorris): This will need to go with the rest of domains.
+    if (env()->in_domain())
+      obj->Set(env()->domain_string(), env()->domain_array()->Get(0));
+
+    size_t workers = (count_ + kBatchSize - 1) / kBatchSize;
+    workers = MIN(workers, ThreadpoolConcurrency(UV_THREADPOOL_FS));
+    CHECK_GT(workers, 0);
+
+    work_reqs_ = new uv_work_t[workers];
+    for (size_t i = 0; i < workers; i++) {
+      work_reqs_[i].data = this;
+      uv_queue_work_class(env()->event_loop(),
+                          &work_reqs_[i],
+                          UV_THREADPOOL_FS,
+                          Work,
+                          After);
+      pending_++;
+    }
+  }
+
+ private:
+  static const size_t kBatchSize = 64;
+
+  const char* path(size_t index) const { return paths_ + offsets_[index]; }
+
+  int Stat(size_t index) {
+#if defined(__POSIX__)
+    uv_stat_t s;
+    int err = StatPath(path(index), lstat_, &s);
+    if (err == 0)
+      FillStatsArray(fields_ + index * kStatsFieldCount, &s);
+    return err;
+#else
+    // The synchronous calls only keep the loop in the request on Windows,
+    // they don't touch it, so the one of the environment is fine here.
+    uv_loop_t* loop = env()->event_loop();
+    uv_fs_t req;
+    int err;
+    if (lstat_)
+      err = uv_fs_lstat(loop, &req, path(index), nullptr);
+    else
+      err = uv_fs_stat(loop, &req, path(index), nullptr);
+    if (err == 0) {
+      FillStatsArray(fields_ + index * kStatsFieldCount,
+                     static_cast<const uv_stat_t*>(req.ptr));
+    }
+    uv_fs_req_cleanup(&req);
+    return err;
+#endif
+  }
+
+  static void Work(uv_work_t* work_req) {
+    StatManyJob* job = static_cast<StatManyJob*>(work_req->data);
+
+    for (;;) {
+      uv_mutex_lock(&job->mutex_);
+      size_t start = job->next_;
+      if (start < job->count_)
+        job->next_ = MIN(start + kBatchSize, job->count_);
+      size_t end = job->next_;
+      uv_mutex_unlock(&job->mutex_);
+      if (start >= end)
+        break;
+
+      for (size_t i = start; i < end; i++) {
+        // Set up front for paths that can't be valid
+        if (job->errors_[i] == 0)
+          job->errors_[i] = job->Stat(i);
+      }
+    }
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    StatManyJob* job = static_cast<StatManyJob*>(work_req->data);
+    if (--job->pending_ > 0)
+      return;
+
+    Environment* env = job->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[3];
+    job->AfterWork(argv);
+    job->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+    delete job;
+  }
+
+  void AfterWork(Local<Value> argv[3]) {
+    Isolate* isolate = env()->isolate();
+    const char* syscall = lstat_ ? "lstat" : "stat";
+
+    Local<Array> errors = Array::New(isolate, count_);
+    for (size_t i = 0; i < count_; i++) {
+      if (errors_[i] == 0) {
+        errors->Set(i, Null(isolate));
+      } else {
+        errors->Set(i, UVException(isolate,
+                                   errors_[i],
+                                   syscall,
+                                   nullptr,
+                                   path(i)));
+      }
+    }
+
+    argv[0] = Null(isolate);
+    argv[1] = object()->Get(env()->buffer_string());
+    argv[2] = errors;
+  }
+
+  const bool lstat_;
+  char* paths_;
+  size_t* offsets_;
+  int* errors_;
+  size_t count_;
+  double* fields_;
+  uv_work_t* work_reqs_;
+  // Only touched on the main thread
+  size_t pending_;
+
+  // Shared between the workers
+  uv_mutex_t mutex_;
+  size_t next_;
+};
+
+
+static void StatMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsArray())
+    return TYPE_ERROR("paths must be an array");
+  CHECK(args[2]->IsFunction());
+
+  Local<Array> paths = args[0].As<Array>();
+  size_t count = paths->Length();
+  CHECK_GT(count, 0);
+
+  // Copy the paths into one block, they are read on the threadpool
+  size_t* offsets = new size_t[count];
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> path = paths->Get(i);
+    if (!path->IsString()) {
+      delete[] offsets;
+      return TYPE_ERROR("paths must be strings");
+    }
+    offsets[i] = total;
+    total += path.As<String>()->Utf8Length() + 1;
+  }
+
+  char* data = new char[total];
+  int* errors = new int[count];
+  for (size_t i = 0; i < count; i++) {
+    Local<String> path = paths->Get(i).As<String>();
+    size_t length = path->WriteUtf8(data + offsets[i]);
+    // Counts the terminating nul, fewer means the path has a nul byte in it
+    errors[i] = (length == strlen(data + offsets[i]) + 1) ? 0 : UV_ENOENT;
   }
+
+  const size_t length = count * kStatsFieldCount;
+  double* fields_data = nullptr;
+  Local<ArrayBuffer> ab =
+      ArrayBuffer::New(env->isolate(), length * sizeof(*fields_data));
+  Local<Float64Array> fields = Float64Array::New(ab, 0, length);
+  fields_data = Float64ArrayData(fields);
+
+  // The job keeps the array alive until the workers are done with it
+  Local<Object> obj = Object::New(env->isolate());
+  obj->Set(env->buffer_string(), fields);
+
+  StatManyJob* job = new StatManyJob(env,
+                                     obj,
+                                     args[1]->IsTrue(),
+                                     data,
+                                     offsets,
+                                     errors,
+                                     count,
+                                     fields_data);
+  job->Queue(args[2]);
 }
 
+
 static void Symlink(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -700,6 +1053,47 @@ static void MKDir(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Same as After() for UV_FS_SCANDIR but passes the entry types as well.
+static void AfterReadDirWithTypes(uv_fs_t* req) {
+  FSReqWrap* req_wrap = static_cast<FSReqWrap*>(req->data);
+  CHECK_EQ(&req_wrap->req_, req);
+  req_wrap->ReleaseEarly();  // Free memory that's no longer used now.
+
+  Environment* env = req_wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  int argc = 1;
+  Local<Value> argv[3];
+  int err = req->result;
+
+  if (err >= 0) {
+    Local<Array> names = Array::New(env->isolate(), 0);
+    Local<Array> types = Array::New(env->isolate(), 0);
+    err = ReadDirEntries(env, req, names, types);
+    if (err == 0) {
+      argc = 3;
+      argv[0] = Null(env->isolate());
+      argv[1] = names;
+      argv[2] = types;
+    }
+  }
+
+  if (err < 0) {
+    argv[0] = UVException(env->isolate(),
+                          err,
+                          req_wrap->syscall(),
+                          nullptr,
+                          req->path,
+                          req_wrap->data());
+  }
+
+  req_wrap->MakeCallback(env->oncomplete_string(), argc, argv);
+
+  uv_fs_req_cleanup(&req_wrap->req_);
+  req_wrap->Dispose();
+}
+
 static void ReadDir(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -709,31 +1103,47 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
     return TYPE_ERROR("path must be a string");
 
   node::Utf8Value path(env->isolate(), args[0]);
-
-  if (args[1]->IsObject()) {
+  const bool with_types = args[2]->IsTrue();
+
+  if (args[1]->IsObject() && with_types) {
+    FSReqWrap* req_wrap =
+        FSReqWrap::New(env, args[1].As<Object>(), "scandir");
+    int err = uv_fs_scandir(env->event_loop(),
+                            &req_wrap->req_,
+                            *path,
+                            0 /*flags*/,
+                            AfterReadDirWithTypes);
+    req_wrap->Dispatched();
+    if (err < 0) {
+      uv_fs_t* uv_req = &req_wrap->req_;
+      uv_req->result = err;
+      uv_req->path = nullptr;
+      AfterReadDirWithTypes(uv_req);
+    }
+    args.GetReturnValue().Set(req_wrap->persistent());
+  } else if (args[1]->IsObject()) {
     ASYNC_CALL(scandir, args[1], *path, 0 /*flags*/)
   } else {
     SYNC_CALL(scandir, *path, *path, 0 /*flags*/)
 
     CHECK_GE(SYNC_REQ.result, 0);
-    int r;
     Local<Array> names = Array::New(env->isolate(), 0);
-
-    for (int i = 0; ; i++) {
-      uv_dirent_t ent;
-
-      r = uv_fs_scandir_next(&SYNC_REQ, &ent);
-      if (r == UV_EOF)
-        break;
-      if (r != 0)
-        return env->ThrowUVException(r, "readdir", "", *path);
-
-      Local<String> name = String::NewFromUtf8(env->isolate(),
-                                               ent.name);
-      names->Set(i, name);
+    Local<Array> types;
+    if (with_types)
+      types = Array::New(env->isolate(), 0);
+
+    int r = ReadDirEntries(env, &SYNC_REQ, names, types);
+    if (r != 0)
+      return env->ThrowUVException(r, "readdir", "", *path);
+
+    if (with_types) {
+      Local<Array> result = Array::New(env->isolate(), 2);
+      result->Set(0, names);
+      result->Set(1, types);
+      args.GetReturnValue().Set(result);
+    } else {
+      args.GetReturnValue().Set(names);
     }
-
-    args.GetReturnValue().Set(names);
   }
 }
 
@@ -1141,6 +1551,7 @@ void InitFs(Handle<Object> target,
   env->SetMethod(target, "stat", Stat);
   env->SetMethod(target, "lstat", LStat);
   env->SetMethod(target, "fstat", FStat);
+  env->SetMethod(target, "statMany", StatMany);
   env->SetMethod(target, "link", Link);
   env->SetMethod(target, "symlink", Symlink);
   env->SetMethod(target, "readlink", ReadLink);
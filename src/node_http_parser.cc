@@ -43,8 +43,11 @@ using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
+using v8::Null;
 using v8::Object;
+using v8::Persistent;
 using v8::String;
 using v8::Uint32;
 using v8::Undefined;
@@ -54,6 +57,77 @@ const uint32_t kOnHeaders = 0;
 const uint32_t kOnHeadersComplete = 1;
 const uint32_t kOnBody = 2;
 const uint32_t kOnMessageComplete = 3;
+const uint32_t kOnMessages = 4;
+
+struct KnownHeader {
+  const char* name;
+  const char* lowercase;
+  size_t size;
+};
+
+static const KnownHeader known_headers[] = {
+#define V(name, lowercase) { name, lowercase, sizeof(name) - 1 },
+  NODE_HTTP_KNOWN_HEADERS(V)
+#undef V
+};
+
+
+HttpHeaderNames::HttpHeaderNames() {
+}
+
+
+HttpHeaderNames::~HttpHeaderNames() {
+  for (int i = 0; i < kCount; i++) {
+    names_[i].Reset();
+    lowercase_names_[i].Reset();
+  }
+}
+
+
+Local<String> HttpHeaderNames::Lookup(Isolate* isolate,
+                                      const char* str,
+                                      size_t size) {
+  for (int i = 0; i < kCount; i++) {
+    const KnownHeader& header = known_headers[i];
+    if (header.size != size)
+      continue;
+    if (memcmp(str, header.name, size) == 0)
+      return Get(isolate, i, false);
+    if (memcmp(str, header.lowercase, size) == 0)
+      return Get(isolate, i, true);
+  }
+  return Local<String>();
+}
+
+
+Local<Object> HttpHeaderNames::CreateLowercaseMap(Isolate* isolate) {
+  Local<Object> map = Object::New(isolate);
+  map->SetPrototype(Null(isolate));
+  for (int i = 0; i < kCount; i++) {
+    Local<String> lowercase = Get(isolate, i, true);
+    map->Set(Get(isolate, i, false), lowercase);
+    map->Set(lowercase, lowercase);
+  }
+  return map;
+}
+
+
+Local<String> HttpHeaderNames::Get(Isolate* isolate,
+                                   int index,
+                                   bool lowercase) {
+  Persistent<String>& handle =
+      lowercase ? lowercase_names_[index] : names_[index];
+  if (handle.IsEmpty()) {
+    const KnownHeader& header = known_headers[index];
+    const char* str = lowercase ? header.lowercase : header.name;
+    handle.Reset(isolate,
+                 String::NewFromOneByte(isolate,
+                                        reinterpret_cast<const uint8_t*>(str),
+                                        String::kInternalizedString,
+                                        header.size));
+  }
+  return PersistentToLocal(isolate, handle);
+}
 
 
 #define HTTP_CB(name)                                                         \
@@ -98,6 +172,17 @@ struct StringPtr {
   }
 
 
+  // Hands the string over to |other|, leaving this one empty.
+  void MoveTo(StringPtr* other) {
+    other->Reset();
+    other->str_ = str_;
+    other->size_ = size_;
+    other->on_heap_ = on_heap_;
+    on_heap_ = false;
+    Reset();
+  }
+
+
   void Reset() {
     if (on_heap_) {
       delete[] str_;
@@ -138,6 +223,17 @@ struct StringPtr {
   }
 
 
+  // Like ToString() but hands out the cached string for well-known header
+  // names.
+  Local<String> ToHeaderName(Environment* env) const {
+    Local<String> name =
+        env->http_header_names()->Lookup(env->isolate(), str_, size_);
+    if (name.IsEmpty())
+      return ToString(env);
+    return name;
+  }
+
+
   const char* str_;
   bool on_heap_;
   size_t size_;
@@ -148,8 +244,12 @@ class Parser : public BaseObject {
  public:
   Parser(Environment* env, Local<Object> wrap, enum http_parser_type type)
       : BaseObject(env, wrap),
+        fields_(fields_inline_),
+        values_(values_inline_),
+        max_headers_(ARRAY_SIZE(fields_inline_)),
         current_buffer_len_(0),
-        current_buffer_data_(nullptr) {
+        current_buffer_data_(nullptr),
+        batch_length_(0) {
     Wrap(object(), this);
     Init(type);
   }
@@ -158,6 +258,10 @@ class Parser : public BaseObject {
   ~Parser() override {
     ClearWrap(object());
     persistent().Reset();
+    if (fields_ != fields_inline_) {
+      delete[] fields_;
+      delete[] values_;
+    }
   }
 
 
@@ -184,17 +288,13 @@ class Parser : public BaseObject {
   HTTP_DATA_CB(on_header_field) {
     if (num_fields_ == num_values_) {
       // start of new field name
+      if (num_fields_ == max_headers_)
+        GrowHeaders();
       num_fields_++;
-      if (num_fields_ == ARRAY_SIZE(fields_)) {
-        // ran out of space - flush to javascript land
-        Flush();
-        num_fields_ = 1;
-        num_values_ = 0;
-      }
       fields_[num_fields_ - 1].Reset();
     }
 
-    CHECK_LT(num_fields_, static_cast<int>(ARRAY_SIZE(fields_)));
+    CHECK_LE(num_fields_, max_headers_);
     CHECK_EQ(num_fields_, num_values_ + 1);
 
     fields_[num_fields_ - 1].Update(at, length);
@@ -210,7 +310,7 @@ class Parser : public BaseObject {
       values_[num_values_ - 1].Reset();
     }
 
-    CHECK_LT(num_values_, static_cast<int>(ARRAY_SIZE(values_)));
+    CHECK_LE(num_values_, max_headers_);
     CHECK_EQ(num_values_, num_fields_);
 
     values_[num_values_ - 1].Update(at, length);
@@ -238,24 +338,21 @@ class Parser : public BaseObject {
 
     Local<Value> argv[A_MAX];
     Local<Object> obj = object();
-    Local<Value> cb = obj->Get(kOnHeadersComplete);
+    Local<Value> cb;
 
-    if (!cb->IsFunction())
-      return 0;
+    if (batch_.IsEmpty()) {
+      cb = obj->Get(kOnHeadersComplete);
+      if (!cb->IsFunction())
+        return 0;
+    }
 
     Local<Value> undefined = Undefined(env()->isolate());
     for (size_t i = 0; i < ARRAY_SIZE(argv); i++)
       argv[i] = undefined;
 
-    if (have_flushed_) {
-      // Slow case, flush remaining headers.
-      Flush();
-    } else {
-      // Fast case, pass headers and URL to JS land.
-      argv[A_HEADERS] = CreateHeaders();
-      if (parser_.type == HTTP_REQUEST)
-        argv[A_URL] = url_.ToString(env());
-    }
+    argv[A_HEADERS] = CreateHeaders();
+    if (parser_.type == HTTP_REQUEST)
+      argv[A_URL] = url_.ToString(env());
 
     num_fields_ = 0;
     num_values_ = 0;
@@ -282,6 +379,11 @@ class Parser : public BaseObject {
 
     argv[A_UPGRADE] = Boolean::New(env()->isolate(), parser_.upgrade);
 
+    if (!batch_.IsEmpty()) {
+      AddEvent(kOnHeadersComplete, argv, ARRAY_SIZE(argv));
+      return 0;
+    }
+
     Local<Value> head_response =
         cb.As<Function>()->Call(obj, ARRAY_SIZE(argv), argv);
 
@@ -297,6 +399,15 @@ class Parser : public BaseObject {
   HTTP_DATA_CB(on_body) {
     HandleScope scope(env()->isolate());
 
+    if (!batch_.IsEmpty()) {
+      Local<Value> argv[2] = {
+        Integer::NewFromUnsigned(env()->isolate(), at - current_buffer_data_),
+        Integer::NewFromUnsigned(env()->isolate(), length)
+      };
+      AddEvent(kOnBody, argv, ARRAY_SIZE(argv));
+      return 0;
+    }
+
     Local<Object> obj = object();
     Local<Value> cb = obj->Get(kOnBody);
 
@@ -323,6 +434,19 @@ class Parser : public BaseObject {
   HTTP_CB(on_message_complete) {
     HandleScope scope(env()->isolate());
 
+    if (!batch_.IsEmpty()) {
+      // Trailing HTTP headers go with the event.
+      Local<Value> trailers = Undefined(env()->isolate());
+      if (num_fields_) {
+        trailers = CreateHeaders();
+        num_fields_ = 0;
+        num_values_ = 0;
+        url_.Reset();
+      }
+      AddEvent(kOnMessageComplete, &trailers, 1);
+      return 0;
+    }
+
     if (num_fields_)
       Flush();  // Flush trailing HTTP headers.
 
@@ -394,11 +518,38 @@ class Parser : public BaseObject {
     parser->current_buffer_data_ = buffer_data;
     parser->got_exception_ = false;
 
+    // Request parsers with an onMessages callback collect the events for all
+    // the messages in the buffer and deliver them with a single call into JS
+    // at the end, instead of one call per event.  That is a lot cheaper when
+    // clients pipeline requests.  The headers complete callback cannot ask to
+    // skip the body that way, which only response parsers need.
+    Local<Object> obj = parser->object();
+    Local<Value> on_messages;
+    if (parser->parser_.type == HTTP_REQUEST) {
+      on_messages = obj->Get(kOnMessages);
+      if (on_messages->IsFunction()) {
+        parser->batch_ = Array::New(env->isolate());
+        parser->batch_length_ = 0;
+      }
+    }
+
     size_t nparsed =
       http_parser_execute(&parser->parser_, &settings, buffer_data, buffer_len);
 
     parser->Save();
 
+    if (!parser->batch_.IsEmpty()) {
+      Local<Array> batch = parser->batch_;
+      parser->batch_.Clear();
+      if (batch->Length() > 0) {
+        Local<Value> argv[2] = { batch, buffer_obj };
+        Local<Value> r =
+            on_messages.As<Function>()->Call(obj, ARRAY_SIZE(argv), argv);
+        if (r.IsEmpty())
+          parser->got_exception_ = true;
+      }
+    }
+
     // Unassign the 'buffer_' variable
     parser->current_buffer_.Clear();
     parser->current_buffer_len_ = 0;
@@ -486,7 +637,7 @@ class Parser : public BaseObject {
     Local<Array> headers = Array::New(env()->isolate(), 2 * num_values_);
 
     for (int i = 0; i < num_values_; ++i) {
-      headers->Set(2 * i, fields_[i].ToString(env()));
+      headers->Set(2 * i, fields_[i].ToHeaderName(env()));
       headers->Set(2 * i + 1, values_[i].ToString(env()));
     }
 
@@ -494,7 +645,40 @@ class Parser : public BaseObject {
   }
 
 
-  // spill headers and request path to JS land
+  // The parser starts out with room for ARRAY_SIZE(fields_inline_) headers,
+  // which is enough for most messages.  Messages with more headers move the
+  // storage to the heap, the parser keeps it for the messages that follow.
+  void GrowHeaders() {
+    int max_headers = 2 * max_headers_;
+    StringPtr* fields = new StringPtr[max_headers];
+    StringPtr* values = new StringPtr[max_headers];
+
+    for (int i = 0; i < num_fields_; i++)
+      fields_[i].MoveTo(&fields[i]);
+    for (int i = 0; i < num_values_; i++)
+      values_[i].MoveTo(&values[i]);
+
+    if (fields_ != fields_inline_) {
+      delete[] fields_;
+      delete[] values_;
+    }
+
+    fields_ = fields;
+    values_ = values;
+    max_headers_ = max_headers;
+  }
+
+
+  // Appends an event and its arguments to batch_, see Execute().
+  void AddEvent(uint32_t event, Local<Value> argv[], size_t argc) {
+    batch_->Set(batch_length_++, Integer::NewFromUnsigned(env()->isolate(),
+                                                          event));
+    for (size_t i = 0; i < argc; i++)
+      batch_->Set(batch_length_++, argv[i]);
+  }
+
+
+  // spill trailing headers to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
 
@@ -515,7 +699,6 @@ class Parser : public BaseObject {
       got_exception_ = true;
 
     url_.Reset();
-    have_flushed_ = true;
   }
 
 
@@ -525,23 +708,26 @@ class Parser : public BaseObject {
     status_message_.Reset();
     num_fields_ = 0;
     num_values_ = 0;
-    have_flushed_ = false;
     got_exception_ = false;
   }
 
 
   http_parser parser_;
-  StringPtr fields_[32];  // header fields
-  StringPtr values_[32];  // header values
+  StringPtr fields_inline_[32];
+  StringPtr values_inline_[32];
+  StringPtr* fields_;  // header fields
+  StringPtr* values_;  // header values
+  int max_headers_;
   StringPtr url_;
   StringPtr status_message_;
   int num_fields_;
   int num_values_;
-  bool have_flushed_;
   bool got_exception_;
   Local<Object> current_buffer_;
   size_t current_buffer_len_;
   char* current_buffer_data_;
+  Local<Array> batch_;
+  uint32_t batch_length_;
   static const struct http_parser_settings settings;
 };
 
@@ -558,6 +744,204 @@ const struct http_parser_settings Parser::settings = {
 };
 
 
+// What FormatHeaders() found out about the headers, lib/_http_outgoing.js
+// decides on the framing and the connection headers with these.
+enum HeaderFlags {
+  kSentConnection = 1 << 0,
+  kConnectionClose = 1 << 1,
+  kConnectionKeepAlive = 1 << 2,
+  kSentTransferEncoding = 1 << 3,
+  kChunked = 1 << 4,
+  kSentContentLength = 1 << 5,
+  kSentDate = 1 << 6,
+  kSentExpect = 1 << 7,
+  kSentTrailer = 1 << 8
+};
+
+
+// |lowercase| must be lowercase.
+template <typename T>
+static bool EqualsIgnoreCase(const T* str,
+                             size_t size,
+                             const char* lowercase) {
+  for (size_t i = 0; i < size; i++) {
+    T c = str[i];
+    if (c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+    if (lowercase[i] == '\0' || c != static_cast<uint8_t>(lowercase[i]))
+      return false;
+  }
+  return lowercase[size] == '\0';
+}
+
+
+template <typename T>
+static bool ContainsIgnoreCase(const T* str,
+                               size_t size,
+                               const char* lowercase) {
+  size_t needle_size = strlen(lowercase);
+  for (size_t i = 0; i + needle_size <= size; i++) {
+    if (EqualsIgnoreCase(str + i, needle_size, lowercase))
+      return true;
+  }
+  return false;
+}
+
+
+static size_t WriteString(Local<String> string, uint8_t* out) {
+  return string->WriteOneByte(out, 0, -1, String::NO_NULL_TERMINATION);
+}
+
+
+static size_t WriteString(Local<String> string, uint16_t* out) {
+  return string->Write(out, 0, -1, String::NO_NULL_TERMINATION);
+}
+
+
+// Strips CR and LF, and any whitespace that follows them, to protect against
+// response splitting.  Returns the new size.
+template <typename T>
+static size_t StripNewlines(T* str, size_t size) {
+  size_t k = 0;
+  for (size_t i = 0; i < size;) {
+    if (str[i] != '\r' && str[i] != '\n') {
+      str[k++] = str[i++];
+      continue;
+    }
+    while (i < size && (str[i] == '\r' || str[i] == '\n'))
+      i++;
+    while (i < size && (str[i] == ' ' || str[i] == '\t'))
+      i++;
+  }
+  return k;
+}
+
+
+// Writes |first_line| followed by a "field: value\r\n" line for every pair
+// in |list| to |out|, which must be big enough.  Returns the size.
+template <typename T>
+static size_t WriteHeaders(Local<String> first_line,
+                           Local<Array> list,
+                           T* out,
+                           int* flags) {
+  size_t size = WriteString(first_line, out);
+
+  for (uint32_t i = 0; i < list->Length(); i += 2) {
+    T* field = out + size;
+    size_t field_size = WriteString(list->Get(i).As<String>(), field);
+    size += field_size;
+    out[size++] = ':';
+    out[size++] = ' ';
+
+    T* value = out + size;
+    size_t value_size = WriteString(list->Get(i + 1).As<String>(), value);
+    value_size = StripNewlines(value, value_size);
+    size += value_size;
+    out[size++] = '\r';
+    out[size++] = '\n';
+
+    if (EqualsIgnoreCase(field, field_size, "connection")) {
+      *flags |= kSentConnection;
+      if (ContainsIgnoreCase(value, value_size, "close"))
+        *flags |= kConnectionClose;
+      else
+        *flags |= kConnectionKeepAlive;
+    } else if (EqualsIgnoreCase(field, field_size, "transfer-encoding")) {
+      *flags |= kSentTransferEncoding;
+      if (ContainsIgnoreCase(value, value_size, "chunk"))
+        *flags |= kChunked;
+    } else if (EqualsIgnoreCase(field, field_size, "content-length")) {
+      *flags |= kSentContentLength;
+    } else if (EqualsIgnoreCase(field, field_size, "date")) {
+      *flags |= kSentDate;
+    } else if (EqualsIgnoreCase(field, field_size, "expect")) {
+      *flags |= kSentExpect;
+    } else if (EqualsIgnoreCase(field, field_size, "trailer")) {
+      *flags |= kSentTrailer;
+    }
+  }
+
+  return size;
+}
+
+
+template <typename T>
+static Local<String> SerializeHeaders(Environment* env,
+                                      Local<String> first_line,
+                                      Local<Array> list,
+                                      size_t size,
+                                      int* flags) {
+  T stack_storage[4096];
+  T* out = stack_storage;
+  if (size > ARRAY_SIZE(stack_storage)) {
+    out = static_cast<T*>(malloc(size * sizeof(*out)));
+    if (out == nullptr)
+      FatalError("node::SerializeHeaders()", "Out Of Memory");
+  }
+
+  size = WriteHeaders(first_line, list, out, flags);
+
+  Local<String> headers;
+  if (sizeof(*out) == 1) {
+    headers = String::NewFromOneByte(env->isolate(),
+                                     reinterpret_cast<const uint8_t*>(out),
+                                     String::kNormalString,
+                                     size);
+  } else {
+    headers = String::NewFromTwoByte(env->isolate(),
+                                     reinterpret_cast<const uint16_t*>(out),
+                                     String::kNormalString,
+                                     size);
+  }
+
+  if (out != stack_storage)
+    free(out);
+
+  return headers;
+}
+
+
+// formatHeaders(firstLine, [field, value, field, value, ...])
+//
+// Serializes the status or request line and the headers in one go, without
+// the string concatenation and the regular expressions that doing it in JS
+// takes.  All arguments must be strings.  Returns [headers, flags].
+static void FormatHeaders(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsArray());
+
+  Local<String> first_line = args[0].As<String>();
+  Local<Array> list = args[1].As<Array>();
+  uint32_t length = list->Length();
+  CHECK_EQ(length % 2, 0);
+
+  bool one_byte = first_line->IsOneByte();
+  size_t size = first_line->Length();
+  for (uint32_t i = 0; i < length; i++) {
+    Local<Value> value = list->Get(i);
+    CHECK(value->IsString());
+    Local<String> string = value.As<String>();
+    one_byte = one_byte && string->IsOneByte();
+    // Room for either ": " or "\r\n".
+    size += string->Length() + 2;
+  }
+
+  int flags = 0;
+  Local<String> headers;
+  if (one_byte)
+    headers = SerializeHeaders<uint8_t>(env, first_line, list, size, &flags);
+  else
+    headers = SerializeHeaders<uint16_t>(env, first_line, list, size, &flags);
+
+  Local<Array> result = Array::New(env->isolate(), 2);
+  result->Set(0, headers);
+  result->Set(1, Integer::New(env->isolate(), flags));
+  args.GetReturnValue().Set(result);
+}
+
+
 void InitHttpParser(Handle<Object> target,
                     Handle<Value> unused,
                     Handle<Context> context,
@@ -579,6 +963,8 @@ void InitHttpParser(Handle<Object> target,
          Integer::NewFromUnsigned(env->isolate(), kOnBody));
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnMessageComplete"),
          Integer::NewFromUnsigned(env->isolate(), kOnMessageComplete));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnMessages"),
+         Integer::NewFromUnsigned(env->isolate(), kOnMessages));
 
   Local<Array> methods = Array::New(env->isolate());
 #define V(num, name, string)                                                  \
@@ -586,6 +972,8 @@ void InitHttpParser(Handle<Object> target,
   HTTP_METHOD_MAP(V)
 #undef V
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "methods"), methods);
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "knownHeaders"),
+         env->http_header_names()->CreateLowercaseMap(env->isolate()));
 
   env->SetProtoMethod(t, "close", Parser::Close);
   env->SetProtoMethod(t, "execute", Parser::Execute);
@@ -596,6 +984,17 @@ void InitHttpParser(Handle<Object> target,
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "HTTPParser"),
               t->GetFunction());
+
+  env->SetMethod(target, "formatHeaders", FormatHeaders);
+  NODE_DEFINE_CONSTANT(target, kSentConnection);
+  NODE_DEFINE_CONSTANT(target, kConnectionClose);
+  NODE_DEFINE_CONSTANT(target, kConnectionKeepAlive);
+  NODE_DEFINE_CONSTANT(target, kSentTransferEncoding);
+  NODE_DEFINE_CONSTANT(target, kChunked);
+  NODE_DEFINE_CONSTANT(target, kSentContentLength);
+  NODE_DEFINE_CONSTANT(target, kSentDate);
+  NODE_DEFINE_CONSTANT(target, kSentExpect);
+  NODE_DEFINE_CONSTANT(target, kSentTrailer);
 }
 
 }  // namespace node
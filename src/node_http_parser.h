@@ -1,14 +1,104 @@
 #ifndef SRC_NODE_HTTP_PARSER_H_
 #define SRC_NODE_HTTP_PARSER_H_
 
+#include "util.h"
 #include "v8.h"
 
 #include "http_parser.h"
 
+#include <stddef.h>
+
 namespace node {
 
 void InitHttpParser(v8::Handle<v8::Object> target);
 
+// Header names that are common enough to be worth caching.  The first column
+// is the usual spelling, the second one the lowercase form.
+#define NODE_HTTP_KNOWN_HEADERS(V)                                            \
+  V("Accept", "accept")                                                       \
+  V("Accept-Charset", "accept-charset")                                       \
+  V("Accept-Encoding", "accept-encoding")                                     \
+  V("Accept-Language", "accept-language")                                     \
+  V("Accept-Ranges", "accept-ranges")                                         \
+  V("Age", "age")                                                             \
+  V("Authorization", "authorization")                                         \
+  V("Cache-Control", "cache-control")                                         \
+  V("Connection", "connection")                                               \
+  V("Content-Disposition", "content-disposition")                             \
+  V("Content-Encoding", "content-encoding")                                   \
+  V("Content-Language", "content-language")                                   \
+  V("Content-Length", "content-length")                                       \
+  V("Content-Location", "content-location")                                   \
+  V("Content-Range", "content-range")                                         \
+  V("Content-Type", "content-type")                                           \
+  V("Cookie", "cookie")                                                       \
+  V("Date", "date")                                                           \
+  V("ETag", "etag")                                                           \
+  V("Expect", "expect")                                                       \
+  V("Expires", "expires")                                                     \
+  V("From", "from")                                                           \
+  V("Host", "host")                                                           \
+  V("If-Match", "if-match")                                                   \
+  V("If-Modified-Since", "if-modified-since")                                 \
+  V("If-None-Match", "if-none-match")                                         \
+  V("If-Range", "if-range")                                                   \
+  V("If-Unmodified-Since", "if-unmodified-since")                             \
+  V("Keep-Alive", "keep-alive")                                               \
+  V("Last-Modified", "last-modified")                                         \
+  V("Location", "location")                                                   \
+  V("Origin", "origin")                                                       \
+  V("Pragma", "pragma")                                                       \
+  V("Proxy-Authenticate", "proxy-authenticate")                               \
+  V("Proxy-Authorization", "proxy-authorization")                             \
+  V("Range", "range")                                                         \
+  V("Referer", "referer")                                                     \
+  V("Retry-After", "retry-after")                                             \
+  V("Server", "server")                                                       \
+  V("Set-Cookie", "set-cookie")                                               \
+  V("Transfer-Encoding", "transfer-encoding")                                 \
+  V("Upgrade", "upgrade")                                                     \
+  V("User-Agent", "user-agent")                                               \
+  V("Vary", "vary")                                                           \
+  V("Via", "via")                                                             \
+  V("WWW-Authenticate", "www-authenticate")                                   \
+  V("X-Forwarded-For", "x-forwarded-for")                                     \
+  V("X-Requested-With", "x-requested-with")                                   \
+
+// Internalized strings for the header names above, one set per Environment.
+// The parser hands these out instead of creating a new string for every
+// header, and lib/_http_incoming.js maps them to their lowercase form without
+// calling toLowerCase().
+class HttpHeaderNames {
+ public:
+  HttpHeaderNames();
+  ~HttpHeaderNames();
+
+  // Returns the cached string if |str| is one of the known header names,
+  // spelled either the usual way or in lowercase.  Returns an empty handle
+  // for everything else.
+  v8::Local<v8::String> Lookup(v8::Isolate* isolate,
+                               const char* str,
+                               size_t size);
+
+  // Returns a new object that maps both spellings of every known header name
+  // to the lowercase one.
+  v8::Local<v8::Object> CreateLowercaseMap(v8::Isolate* isolate);
+
+ private:
+  enum {
+#define V(name, lowercase) 1 +
+    kCount = NODE_HTTP_KNOWN_HEADERS(V) 0
+#undef V
+  };
+
+  v8::Local<v8::String> Get(v8::Isolate* isolate, int index, bool lowercase);
+
+  v8::Persistent<v8::String> names_[kCount];
+  v8::Persistent<v8::String> lowercase_names_[kCount];
+
+  DISALLOW_COPY_AND_ASSIGN(HttpHeaderNames);
+};
+
 }  // namespace node
 
 #endif  // SRC_NODE_HTTP_PARSER_H_
@@ -106,6 +106,15 @@ NO_RETURN void FatalError(const char* location, const char* message);
 
 v8::Local<v8::Value> BuildStatsObject(Environment* env, const uv_stat_t* s);
 
+// Stats packed into doubles, as used by fs.statMany() and the Float64Array
+// forms of the stat functions.  Same order as the arguments of the fs.Stats
+// constructor.
+const size_t kStatsFieldCount = 14;
+void FillStatsArray(double* fields, const uv_stat_t* s);
+// Returns the elements of |array|, after moving them off the V8 heap if the
+// array is small enough to live there.
+double* Float64ArrayData(v8::Local<v8::Float64Array> array);
+
 enum Endianness {
   kLittleEndian,  // _Not_ LITTLE_ENDIAN, clashes with endian.h.
   kBigEndian
@@ -130,6 +139,14 @@ inline bool IsBigEndian() {
   return GetEndianness() == kBigEndian;
 }
 
+// Number of requests of class `cls` that the threadpool runs at the same
+// time, jobs that split their work over several requests don't need more.
+inline size_t ThreadpoolConcurrency(uv_threadpool_class_t cls) {
+  uv_threadpool_stats_t stats;
+  CHECK_EQ(0, uv_threadpool_get_stats(cls, &stats));
+  return stats.concurrency;
+}
+
 // parse index for external array data
 inline MUST_USE_RESULT bool ParseArrayIndex(v8::Handle<v8::Value> arg,
                                             size_t def,
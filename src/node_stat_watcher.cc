@@ -12,6 +12,7 @@
 namespace node {
 
 using v8::Context;
+using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Handle;
@@ -42,9 +43,13 @@ static void Delete(uv_handle_t* handle) {
 }
 
 
-StatWatcher::StatWatcher(Environment* env, Local<Object> wrap)
+StatWatcher::StatWatcher(Environment* env,
+                         Local<Object> wrap,
+                         Local<Float64Array> values)
     : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_STATWATCHER),
-      watcher_(new uv_fs_poll_t) {
+      watcher_(new uv_fs_poll_t),
+      values_array_(env->isolate(), values),
+      values_(Float64ArrayData(values)) {
   MakeWeak<StatWatcher>(this);
   uv_fs_poll_init(env->event_loop(), watcher_);
   watcher_->data = static_cast<void*>(this);
@@ -53,6 +58,7 @@ StatWatcher::StatWatcher(Environment* env, Local<Object> wrap)
 
 StatWatcher::~StatWatcher() {
   Stop();
+  values_array_.Reset();
   uv_close(reinterpret_cast<uv_handle_t*>(watcher_), Delete);
 }
 
@@ -66,9 +72,10 @@ void StatWatcher::Callback(uv_fs_poll_t* handle,
   Environment* env = wrap->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
+  // JS turns these into fs.Stats objects when it needs to
+  FillStatsArray(wrap->values_, curr);
+  FillStatsArray(wrap->values_ + kStatsFieldCount, prev);
   Local<Value> argv[] = {
-    BuildStatsObject(env, curr),
-    BuildStatsObject(env, prev),
     Integer::New(env->isolate(), status)
   };
   wrap->MakeCallback(env->onchange_string(), ARRAY_SIZE(argv), argv);
@@ -77,8 +84,11 @@ void StatWatcher::Callback(uv_fs_poll_t* handle,
 
 void StatWatcher::New(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsFloat64Array());
   Environment* env = Environment::GetCurrent(args);
-  new StatWatcher(env, args.This());
+  Local<Float64Array> values = args[0].As<Float64Array>();
+  CHECK_GE(values->Length(), 2 * kStatsFieldCount);
+  new StatWatcher(env, args.This(), values);
 }
 
 
@@ -16,7 +16,9 @@ class StatWatcher : public AsyncWrap {
   static void Initialize(Environment* env, v8::Handle<v8::Object> target);
 
  protected:
-  StatWatcher(Environment* env, v8::Local<v8::Object> wrap);
+  StatWatcher(Environment* env,
+              v8::Local<v8::Object> wrap,
+              v8::Local<v8::Float64Array> values);
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -30,6 +32,10 @@ class StatWatcher : public AsyncWrap {
   void Stop();
 
   uv_fs_poll_t* watcher_;
+  // Keeps the array alive for as long as the watcher
+  v8::Persistent<v8::Float64Array> values_array_;
+  // The current stats, followed by the previous ones
+  double* values_;
 };
 
 }  // namespace node
@@ -1,5 +1,6 @@
 #include "node.h"
 #include "node_buffer.h"
+#include "node_zlib_simd.h"
 
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
@@ -188,10 +189,11 @@ class ZCtx : public AsyncWrap {
     }
 
     // async version
-    uv_queue_work(ctx->env()->event_loop(),
-                  work_req,
-                  ZCtx::Process,
-                  ZCtx::After);
+    uv_queue_work_class(ctx->env()->event_loop(),
+                        work_req,
+                        UV_THREADPOOL_CPU,
+                        ZCtx::Process,
+                        ZCtx::After);
 
     args.GetReturnValue().Set(ctx->object());
   }
@@ -570,6 +572,35 @@ class ZCtx : public AsyncWrap {
 };
 
 
+// crc32(buffer, initial)
+static void Crc32(const FunctionCallbackInfo<Value>& args) {
+  CHECK(Buffer::HasInstance(args[0]));
+  CHECK(args[1]->IsUint32());
+
+  const char* data = Buffer::Data(args[0]);
+  size_t len = Buffer::Length(args[0]);
+  uint32_t crc = args[1]->Uint32Value();
+
+  size_t n = crc32_simd(&crc, data, len);
+  crc = crc32(crc, reinterpret_cast<const Bytef*>(data) + n, len - n);
+  args.GetReturnValue().Set(crc);
+}
+
+
+// adler32(buffer, initial)
+static void Adler32(const FunctionCallbackInfo<Value>& args) {
+  CHECK(Buffer::HasInstance(args[0]));
+  CHECK(args[1]->IsUint32());
+
+  const char* data = Buffer::Data(args[0]);
+  size_t len = Buffer::Length(args[0]);
+  uint32_t adler = args[1]->Uint32Value();
+
+  adler = adler32(adler, reinterpret_cast<const Bytef*>(data), len);
+  args.GetReturnValue().Set(adler);
+}
+
+
 void InitZlib(Handle<Object> target,
               Handle<Value> unused,
               Handle<Context> context,
@@ -589,6 +620,9 @@ void InitZlib(Handle<Object> target,
   z->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib"));
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib"), z->GetFunction());
 
+  env->SetMethod(target, "crc32", Crc32);
+  env->SetMethod(target, "adler32", Adler32);
+
   // valid flush values.
   NODE_DEFINE_CONSTANT(target, Z_NO_FLUSH);
   NODE_DEFINE_CONSTANT(target, Z_PARTIAL_FLUSH);
@@ -0,0 +1,128 @@
+#include "node_zlib_simd.h"
+#include "node_cpu_features.h"
+
+#include <stdint.h>
+
+// See string_bytes_simd.cc, the kernels use per-function target attributes.
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__clang__) ||                                                    \
+     __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+# define NODE_ZLIB_SIMD 1
+# include <immintrin.h>
+# define NODE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace node {
+
+#if defined(NODE_ZLIB_SIMD)
+
+// The SSE4.2 crc32 instruction computes CRC-32C, which has a different
+// polynomial than the CRC-32 of zlib and gzip.  The carry-less multiply of
+// PCLMULQDQ computes any CRC; SSE4.1 is only needed for _mm_extract_epi32().
+static inline bool HasPclmul() {
+  return CpuHasFeatures(kCpuPCLMUL | kCpuSSE41);
+}
+
+
+// Folds 64 bytes at a time into four 128 bit accumulators, then those into
+// one and reduces it to 32 bits.  See Vinodh Gopal et al., "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction", Intel,
+// 2009.  The constants are for the bit-reflected CRC-32 polynomial.
+// |len| must be at least 64 and a multiple of 16, |crc| is not inverted.
+NODE_TARGET("sse4.1,pclmul")
+static uint32_t crc32_pclmul(uint32_t crc, const uint8_t* buf, size_t len) {
+  const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+  const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+  const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+  const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+  const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+  __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+  __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 16));
+  __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 32));
+  __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 48));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+  buf += 64;
+  len -= 64;
+
+  while (len >= 64) {
+    const __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+    const __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+    const __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+    const __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+    const __m128i y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+    const __m128i y6 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 16));
+    const __m128i y7 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 32));
+    const __m128i y8 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 48));
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+    buf += 64;
+    len -= 64;
+  }
+
+  // Fold the four accumulators into one
+  __m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  // Then the remaining 16 byte blocks
+  while (len >= 16) {
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    buf += 16;
+    len -= 16;
+  }
+
+  // 128 to 64 bits
+  x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, mask32);
+  x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits
+  x2 = _mm_and_si128(x1, mask32);
+  x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+  x2 = _mm_and_si128(x2, mask32);
+  x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return _mm_extract_epi32(x1, 1);
+}
+
+
+size_t crc32_simd(uint32_t* crc, const char* buf, size_t len) {
+  if (len < 64 || !HasPclmul())
+    return 0;
+  len &= ~static_cast<size_t>(15);
+  *crc = ~crc32_pclmul(~*crc, reinterpret_cast<const uint8_t*>(buf), len);
+  return len;
+}
+
+#else  // !defined(NODE_ZLIB_SIMD)
+
+size_t crc32_simd(uint32_t* crc, const char* buf, size_t len) {
+  return 0;
+}
+
+#endif  // defined(NODE_ZLIB_SIMD)
+
+}  // namespace node
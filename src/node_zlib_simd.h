@@ -0,0 +1,22 @@
+#ifndef SRC_NODE_ZLIB_SIMD_H_
+#define SRC_NODE_ZLIB_SIMD_H_
+
+// Vectorized checksum kernels for the zlib binding.
+//
+// Like the StringBytes kernels, they process a prefix of their input and
+// return how far they got; the caller finishes with zlib's own crc32().  The
+// implementation is picked at runtime; without SIMD support they return 0.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// Updates |crc|, a CRC-32 as computed by zlib's crc32(), with a prefix of
+// |buf| whose length is a multiple of 16.  Returns the number of bytes
+// consumed, 0 when |len| is too short to be worth it.
+size_t crc32_simd(uint32_t* crc, const char* buf, size_t len);
+
+}  // namespace node
+
+#endif  // SRC_NODE_ZLIB_SIMD_H_
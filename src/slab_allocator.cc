@@ -0,0 +1,145 @@
+#include "slab_allocator.h"
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <stdlib.h>
+
+namespace node {
+
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+
+size_t SlabAllocator::slab_size = SlabAllocator::kDefaultSlabSize;
+
+
+class SlabAllocator::Slab {
+ public:
+  // Slices handed out to JS start on a multiple of this.
+  static const size_t kAlignment = 16;
+
+  Slab(Isolate* isolate, size_t size)
+      : isolate_(isolate),
+        data_(static_cast<char*>(malloc(size))),
+        size_(size),
+        offset_(0),
+        refs_(1) {
+    if (data_ == nullptr) {
+      FatalError("node::SlabAllocator::Slab::Slab(v8::Isolate*, size_t)",
+                 "Out Of Memory");
+    }
+    isolate_->AdjustAmountOfExternalAllocatedMemory(size_);
+  }
+
+  char* tail() const { return data_ + offset_; }
+  size_t available() const { return size_ - offset_; }
+
+  // Marks the |used| bytes at |base| as taken, the rest of the slab is free
+  // for the next read.
+  void Consume(char* base, size_t used) {
+    size_t end = (base - data_) + used;
+    end = (end + kAlignment - 1) & ~(kAlignment - 1);
+    offset_ = end < size_ ? end : size_;
+  }
+
+  void Ref() {
+    refs_++;
+  }
+
+  void Unref() {
+    CHECK_GT(refs_, 0);
+    if (--refs_ == 0)
+      delete this;
+  }
+
+ private:
+  ~Slab() {
+    free(data_);
+    isolate_->AdjustAmountOfExternalAllocatedMemory(
+        -static_cast<int64_t>(size_));
+  }
+
+  Isolate* const isolate_;
+  char* const data_;
+  const size_t size_;
+  size_t offset_;
+  unsigned int refs_;
+
+  DISALLOW_COPY_AND_ASSIGN(Slab);
+};
+
+
+SlabAllocator::SlabAllocator() : slab_(nullptr), reserved_(nullptr) {
+}
+
+
+SlabAllocator::~SlabAllocator() {
+  // Slices that are still alive keep their slab around.
+  if (slab_ != nullptr)
+    slab_->Unref();
+}
+
+
+void SlabAllocator::Allocate(Environment* env, size_t size, uv_buf_t* buf) {
+  if (reserved_ == nullptr && size > 0 && size <= slab_size) {
+    if (slab_ == nullptr || slab_->available() < size) {
+      if (slab_ != nullptr)
+        slab_->Unref();
+      slab_ = new Slab(env->isolate(), slab_size);
+    }
+    reserved_ = slab_->tail();
+    buf->base = reserved_;
+    buf->len = size;
+    return;
+  }
+
+  buf->base = static_cast<char*>(malloc(size));
+  buf->len = size;
+
+  if (buf->base == nullptr && size > 0) {
+    FatalError(
+        "node::SlabAllocator::Allocate(Environment*, size_t, uv_buf_t*)",
+        "Out Of Memory");
+  }
+}
+
+
+Local<Object> SlabAllocator::Commit(Environment* env,
+                                    const uv_buf_t* buf,
+                                    size_t nread) {
+  CHECK_GT(nread, 0);
+  CHECK_LE(nread, buf->len);
+
+  if (reserved_ == nullptr || buf->base != reserved_) {
+    char* base = static_cast<char*>(realloc(buf->base, nread));
+    return Buffer::Use(env, base, nread);
+  }
+
+  reserved_ = nullptr;
+  // The reservation goes back to the slab, the next read reuses it.
+  if (nread < kMaxCopySize)
+    return Buffer::New(env, buf->base, nread);
+
+  slab_->Consume(buf->base, nread);
+  slab_->Ref();
+  return Buffer::New(env, buf->base, nread, FreeSlice, slab_);
+}
+
+
+void SlabAllocator::Release(const uv_buf_t* buf) {
+  if (reserved_ != nullptr && buf->base == reserved_)
+    reserved_ = nullptr;
+  else if (buf->base != nullptr)
+    free(buf->base);
+}
+
+
+void SlabAllocator::FreeSlice(char* data, void* hint) {
+  static_cast<Slab*>(hint)->Unref();
+}
+
+}  // namespace node
@@ -0,0 +1,60 @@
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>
+
+namespace node {
+
+class Environment;
+
+// Read buffers for stream and UDP handles, carved out of a large shared slab
+// instead of a malloc() and realloc() for every read.
+//
+// Allocate() reserves the free tail of the current slab for a read, Commit()
+// takes back whatever the read did not use and hands the rest to JS as a
+// Buffer that points into the slab.  Slabs are reference counted by those
+// Buffers and freed when the last one is garbage collected; a new slab is
+// started when the current one does not have room for the next read.
+//
+// Reads bigger than the slab and reads that overlap an outstanding
+// reservation fall back to malloc().  Reads smaller than kMaxCopySize are
+// copied out of the slab, a long-lived Buffer of a few bytes would otherwise
+// keep a whole slab alive.
+class SlabAllocator {
+ public:
+  static const size_t kDefaultSlabSize = 1024 * 1024;
+  static const size_t kMaxCopySize = 4096;
+
+  // Slab size of new allocators, 0 disables slab allocation altogether.
+  // Set with --read-slab-size.
+  static size_t slab_size;
+
+  SlabAllocator();
+  ~SlabAllocator();
+
+  void Allocate(Environment* env, size_t size, uv_buf_t* buf);
+  // |buf| must be the result of a call to Allocate() and |nread| > 0.
+  v8::Local<v8::Object> Commit(Environment* env,
+                               const uv_buf_t* buf,
+                               size_t nread);
+  // For reads that failed or did not return data.
+  void Release(const uv_buf_t* buf);
+
+ private:
+  class Slab;
+
+  static void FreeSlice(char* data, void* hint);
+
+  Slab* slab_;
+  char* reserved_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+}  // namespace node
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
@@ -19,6 +19,12 @@
 #include <string.h>  // memcpy()
 #include <limits.h>  // INT_MAX
 
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>  // close()
+#endif
+
 
 namespace node {
 
@@ -40,6 +46,190 @@ using v8::Undefined;
 using v8::Value;
 
 
+static void NewSendFileWrap(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+}
+
+
+#if !defined(_WIN32)
+// Sends a range of a file to a stream with sendfile(2).  The sendfile()
+// calls run on the threadpool so that disk reads don't block the event loop.
+// The socket is non-blocking; when it is full, a uv_poll_t waits for it to
+// become writable again before the transfer is resumed.
+//
+// Works on a dup() of the stream's file descriptor because libuv doesn't
+// allow two watchers on the same fd.  The stream keeps track of the transfer
+// and cancels it when it is closed, the callback then gets UV_ECANCELED.
+class SendFileWrap : public ReqWrap<uv_fs_t> {
+ public:
+  // Upper bound for a single sendfile() call.
+  static const int64_t kMaxChunkSize = 1 << 30;
+
+  SendFileWrap(Environment* env,
+               Local<Object> req_wrap_obj,
+               StreamWrap* stream,
+               int out_fd,
+               int in_fd,
+               int64_t offset,
+               int64_t length)
+      : ReqWrap<uv_fs_t>(env, req_wrap_obj, AsyncWrap::PROVIDER_SENDFILEWRAP),
+        stream_(stream),
+        out_fd_(out_fd),
+        in_fd_(in_fd),
+        offset_(offset),
+        remaining_(length),
+        bytes_(0),
+        status_(0),
+        polling_(false),
+        sending_(false),
+        canceled_(false) {
+    Wrap(req_wrap_obj, this);
+  }
+
+  ~SendFileWrap() override {
+    close(out_fd_);
+  }
+
+  int Send() {
+    int64_t length = remaining_ < kMaxChunkSize ? remaining_ : kMaxChunkSize;
+    int err = uv_fs_sendfile(env()->event_loop(),
+                             &req_,
+                             out_fd_,
+                             in_fd_,
+                             offset_,
+                             static_cast<size_t>(length),
+                             AfterSend);
+    sending_ = (err == 0);
+    return err;
+  }
+
+  // Called when the stream goes away.  The transfer stops at the next
+  // opportunity; the callback never runs synchronously from here.
+  void Cancel() {
+    stream_ = nullptr;
+    canceled_ = true;
+    if (sending_)
+      uv_cancel(reinterpret_cast<uv_req_t*>(&req_));
+    else
+      Finish(UV_ECANCELED);  // Waiting for the socket, closes the poll handle
+  }
+
+ private:
+  static void AfterSend(uv_fs_t* req) {
+    SendFileWrap* wrap = ContainerOf(&SendFileWrap::req_, req);
+    ssize_t result = req->result;
+    uv_fs_req_cleanup(req);
+    wrap->sending_ = false;
+
+    if (result > 0)
+      wrap->bytes_ += result;
+    if (wrap->canceled_)
+      return wrap->Finish(UV_ECANCELED);
+
+    if (result == UV_EAGAIN)
+      return wrap->WaitWritable();
+    if (result < 0)
+      return wrap->Finish(result);
+    // The file is shorter than the range.
+    if (result == 0)
+      return wrap->Finish(UV_EOF);
+
+    wrap->offset_ += result;
+    wrap->remaining_ -= result;
+    if (wrap->remaining_ == 0)
+      return wrap->Finish(0);
+
+    int err = wrap->Send();
+    if (err)
+      wrap->Finish(err);
+  }
+
+  static void OnWritable(uv_poll_t* handle, int status, int events) {
+    SendFileWrap* wrap = ContainerOf(&SendFileWrap::poll_, handle);
+    uv_poll_stop(handle);
+
+    int err = status;
+    if (err == 0)
+      err = wrap->Send();
+    if (err)
+      wrap->Finish(err);
+  }
+
+  static void OnPollClose(uv_handle_t* handle) {
+    uv_poll_t* poll = reinterpret_cast<uv_poll_t*>(handle);
+    SendFileWrap* wrap = ContainerOf(&SendFileWrap::poll_, poll);
+    wrap->Done();
+  }
+
+  void WaitWritable() {
+    int err = 0;
+    if (!polling_) {
+      err = uv_poll_init(env()->event_loop(), &poll_, out_fd_);
+      polling_ = (err == 0);
+    }
+    if (err == 0)
+      err = uv_poll_start(&poll_, UV_WRITABLE, OnWritable);
+    if (err)
+      Finish(err);
+  }
+
+  void Finish(int status) {
+    // Nothing left to cancel once the poll handle is closing.
+    if (stream_ != nullptr) {
+      stream_->sendfile_req_ = nullptr;
+      stream_ = nullptr;
+    }
+    status_ = status;
+    if (polling_)
+      uv_close(reinterpret_cast<uv_handle_t*>(&poll_), OnPollClose);
+    else
+      Done();
+  }
+
+  void Done() {
+    Environment* env = this->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Object> req_wrap_obj = object();
+    req_wrap_obj->Set(env->bytes_string(),
+                      Number::New(env->isolate(), bytes_));
+    Local<Value> argv[] = {
+      Integer::New(env->isolate(), status_),
+      req_wrap_obj
+    };
+    MakeCallback(env->oncomplete_string(), ARRAY_SIZE(argv), argv);
+
+    delete this;
+  }
+
+  StreamWrap* stream_;
+  const int out_fd_;
+  const int in_fd_;
+  int64_t offset_;
+  int64_t remaining_;
+  int64_t bytes_;
+  int status_;
+  bool polling_;
+  bool sending_;
+  bool canceled_;
+  uv_poll_t poll_;
+};
+
+
+static int DupCloexec(int fd) {
+#if defined(F_DUPFD_CLOEXEC)
+  return fcntl(fd, F_DUPFD_CLOEXEC, 0);
+#else
+  int newfd = dup(fd);
+  if (newfd != -1)
+    fcntl(newfd, F_SETFD, FD_CLOEXEC);
+  return newfd;
+#endif
+}
+#endif  // !defined(_WIN32)
+
+
 void StreamWrap::Initialize(Handle<Object> target,
                             Handle<Value> unused,
                             Handle<Context> context) {
@@ -58,6 +248,13 @@ void StreamWrap::Initialize(Handle<Object> target,
   ww->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "WriteWrap"));
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "WriteWrap"),
               ww->GetFunction());
+
+  Local<FunctionTemplate> sfw =
+      FunctionTemplate::New(env->isolate(), NewSendFileWrap);
+  sfw->InstanceTemplate()->SetInternalFieldCount(1);
+  sfw->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "SendFileWrap"));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SendFileWrap"),
+              sfw->GetFunction());
   env->set_write_wrap_constructor_function(ww->GetFunction());
 }
 
@@ -73,13 +270,22 @@ StreamWrap::StreamWrap(Environment* env,
                  provider,
                  parent),
       StreamBase(env),
-      stream_(stream) {
+      stream_(stream),
+      sendfile_req_(nullptr) {
   set_after_write_cb(OnAfterWriteImpl, this);
   set_alloc_cb(OnAllocImpl, this);
   set_read_cb(OnReadImpl, this);
 }
 
 
+StreamWrap::~StreamWrap() {
+#if !defined(_WIN32)
+  if (sendfile_req_ != nullptr)
+    sendfile_req_->Cancel();
+#endif
+}
+
+
 void StreamWrap::AddMethods(Environment* env,
                             v8::Handle<v8::FunctionTemplate> target,
                             int flags) {
@@ -155,14 +361,9 @@ void StreamWrap::OnAlloc(uv_handle_t* handle,
 
 
 void StreamWrap::OnAllocImpl(size_t size, uv_buf_t* buf, void* ctx) {
-  buf->base = static_cast<char*>(malloc(size));
-  buf->len = size;
-
-  if (buf->base == nullptr && size > 0) {
-    FatalError(
-        "node::StreamWrap::DoAlloc(size_t, uv_buf_t*, void*)",
-        "Out Of Memory");
-  }
+  StreamWrap* wrap = static_cast<StreamWrap*>(ctx);
+  Environment* env = wrap->env();
+  env->read_slab_allocator()->Allocate(env, size, buf);
 }
 
 
@@ -198,20 +399,18 @@ void StreamWrap::OnReadImpl(ssize_t nread,
   Local<Object> pending_obj;
 
   if (nread < 0)  {
-    if (buf->base != nullptr)
-      free(buf->base);
+    env->read_slab_allocator()->Release(buf);
     wrap->EmitData(nread, Local<Object>(), pending_obj);
     return;
   }
 
   if (nread == 0) {
-    if (buf->base != nullptr)
-      free(buf->base);
+    env->read_slab_allocator()->Release(buf);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
-  CHECK_LE(static_cast<size_t>(nread), buf->len);
+  Local<Object> data =
+      env->read_slab_allocator()->Commit(env, buf, nread);
 
   if (pending == UV_TCP) {
     pending_obj = AcceptHandle<TCPWrap, uv_tcp_t>(env, wrap);
@@ -223,7 +422,7 @@ void StreamWrap::OnReadImpl(ssize_t nread,
     CHECK_EQ(pending, UV_UNKNOWN_HANDLE);
   }
 
-  wrap->EmitData(nread, Buffer::Use(env, base, nread), pending_obj);
+  wrap->EmitData(nread, data, pending_obj);
 }
 
 
@@ -278,6 +477,54 @@ void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// sendFile(req, fd, offset, length)
+void StreamWrap::SendFile(const FunctionCallbackInfo<Value>& args) {
+#if !defined(_WIN32)
+  Environment* env = Environment::GetCurrent(args);
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsNumber());
+  CHECK(args[3]->IsNumber());
+
+  if (!wrap->IsAlive())
+    return args.GetReturnValue().Set(UV_EINVAL);
+  // Only installed on TCP handles, sendfile(2) wants a socket.
+  CHECK(wrap->is_tcp());
+  // net.Socket writes one file range at a time.
+  if (wrap->sendfile_req_ != nullptr)
+    return args.GetReturnValue().Set(UV_EBUSY);
+
+  int in_fd = args[1]->Int32Value();
+  int64_t offset = args[2]->IntegerValue();
+  int64_t length = args[3]->IntegerValue();
+  CHECK_GE(offset, 0);
+  CHECK_GT(length, 0);
+
+  int out_fd = DupCloexec(wrap->GetFD());
+  if (out_fd == -1)
+    return args.GetReturnValue().Set(-errno);
+
+  SendFileWrap* req_wrap = new SendFileWrap(env,
+                                            args[0].As<Object>(),
+                                            wrap,
+                                            out_fd,
+                                            in_fd,
+                                            offset,
+                                            length);
+  int err = req_wrap->Send();
+  req_wrap->Dispatched();
+  if (err)
+    delete req_wrap;
+  else
+    wrap->sendfile_req_ = req_wrap;
+
+  args.GetReturnValue().Set(err);
+#endif  // !defined(_WIN32)
+}
+
+
 int StreamWrap::DoShutdown(ShutdownWrap* req_wrap) {
   return uv_shutdown(&req_wrap->req_, stream(), AfterShutdown);
 }
@@ -12,6 +12,7 @@ namespace node {
 
 // Forward declaration
 class StreamWrap;
+class SendFileWrap;
 
 class StreamWrap : public HandleWrap, public StreamBase {
  public:
@@ -61,8 +62,7 @@ class StreamWrap : public HandleWrap, public StreamBase {
              AsyncWrap::ProviderType provider,
              AsyncWrap* parent = nullptr);
 
-  ~StreamWrap() {
-  }
+  ~StreamWrap();
 
   AsyncWrap* GetAsyncWrap() override;
   void UpdateWriteQueueSize();
@@ -71,7 +71,12 @@ class StreamWrap : public HandleWrap, public StreamBase {
                          v8::Handle<v8::FunctionTemplate> target,
                          int flags = StreamBase::kFlagNone);
 
+  // Sends a range of a file with sendfile(2), for TCP handles only.
+  static void SendFile(const v8::FunctionCallbackInfo<v8::Value>& args);
+
  private:
+  friend class SendFileWrap;
+
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Callbacks for libuv
@@ -98,6 +103,8 @@ class StreamWrap : public HandleWrap, public StreamBase {
                          void* ctx);
 
   uv_stream_t* const stream_;
+  // The file transfer in progress, if any.
+  SendFileWrap* sendfile_req_;
 };
 
 
@@ -1,4 +1,5 @@
 #include "string_bytes.h"
+#include "string_bytes_simd.h"
 
 #include "node.h"
 #include "node_buffer.h"
@@ -153,6 +154,24 @@ static const int unbase64_table[] =
 #define unbase64(x) unbase64_table[(uint8_t)(x)]
 
 
+// The vectorized decoders only handle one-byte input.
+template <typename TypeName>
+inline size_t base64_decode_fast(char* buf,
+                                 size_t len,
+                                 const TypeName* src,
+                                 size_t srcLen) {
+  return 0;
+}
+
+
+inline size_t base64_decode_fast(char* buf,
+                                 size_t len,
+                                 const char* src,
+                                 size_t srcLen) {
+  return base64_decode_simd(buf, len, src, srcLen);
+}
+
+
 template <typename TypeName>
 size_t base64_decode(char* buf,
                      size_t len,
@@ -164,15 +183,23 @@ size_t base64_decode(char* buf,
   const TypeName* srcEnd = src + srcLen;
 
   while (src < srcEnd && dst < dstEnd) {
+    // Decode runs of plain base64 characters in bulk, the group by group
+    // loop below deals with whitespace, padding and the tail.
+    size_t n = base64_decode_fast(dst, dstEnd - dst, src, srcEnd - src);
+    src += n;
+    dst += n / 4 * 3;
+    if (src == srcEnd || dst == dstEnd)
+      break;
+
     int remaining = srcEnd - src;
 
-    while (unbase64(*src) < 0 && src < srcEnd)
+    while (src < srcEnd && unbase64(*src) < 0)
       src++, remaining--;
     if (remaining == 0 || *src == '=')
       break;
     a = unbase64(*src++);
 
-    while (unbase64(*src) < 0 && src < srcEnd)
+    while (src < srcEnd && unbase64(*src) < 0)
       src++, remaining--;
     if (remaining <= 1 || *src == '=')
       break;
@@ -182,7 +209,7 @@ size_t base64_decode(char* buf,
     if (dst == dstEnd)
       break;
 
-    while (unbase64(*src) < 0 && src < srcEnd)
+    while (src < srcEnd && unbase64(*src) < 0)
       src++, remaining--;
     if (remaining <= 2 || *src == '=')
       break;
@@ -192,7 +219,7 @@ size_t base64_decode(char* buf,
     if (dst == dstEnd)
       break;
 
-    while (unbase64(*src) < 0 && src < srcEnd)
+    while (src < srcEnd && unbase64(*src) < 0)
       src++, remaining--;
     if (remaining <= 3 || *src == '=')
       break;
@@ -219,13 +246,32 @@ unsigned hex2bin(TypeName c) {
 }
 
 
+template <typename TypeName>
+inline size_t hex_decode_fast(char* buf,
+                              size_t len,
+                              const TypeName* src,
+                              size_t srcLen) {
+  return 0;
+}
+
+
+inline size_t hex_decode_fast(char* buf,
+                              size_t len,
+                              const char* src,
+                              size_t srcLen) {
+  return hex_decode_simd(buf, len, src, srcLen);
+}
+
+
 template <typename TypeName>
 size_t hex_decode(char* buf,
                   size_t len,
                   const TypeName* src,
                   const size_t srcLen) {
   size_t i;
-  for (i = 0; i < len && i * 2 + 1 < srcLen; ++i) {
+  for (i = hex_decode_fast(buf, len, src, srcLen);
+       i < len && i * 2 + 1 < srcLen;
+       ++i) {
     unsigned a = hex2bin(src[i * 2 + 0]);
     unsigned b = hex2bin(src[i * 2 + 1]);
     if (!~a || !~b)
@@ -237,6 +283,36 @@ size_t hex_decode(char* buf,
 }
 
 
+// Flattens a one-byte string into a char array so that the one-byte versions
+// of the decoders, which have vectorized fast paths, can be used.  It is also
+// half the size of the String::Value for the same string.
+class OneByteValue {
+ public:
+  explicit OneByteValue(Handle<String> string)
+      : out_(out_st_), length_(string->Length()) {
+    if (length_ > sizeof(out_st_))
+      out_ = new char[length_];
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(out_),
+                         0,
+                         length_,
+                         String::NO_NULL_TERMINATION);
+  }
+
+  ~OneByteValue() {
+    if (out_ != out_st_)
+      delete[] out_;
+  }
+
+  const char* operator*() const { return out_; }
+  size_t length() const { return length_; }
+
+ private:
+  char* out_;
+  size_t length_;
+  char out_st_[1024];
+};
+
+
 bool StringBytes::GetExternalParts(Isolate* isolate,
                                    Handle<Value> val,
                                    const char** data,
@@ -338,6 +414,9 @@ size_t StringBytes::Write(Isolate* isolate,
     case BASE64:
       if (is_extern) {
         nbytes = base64_decode(buf, buflen, data, external_nbytes);
+      } else if (str->IsOneByte()) {
+        OneByteValue value(str);
+        nbytes = base64_decode(buf, buflen, *value, value.length());
       } else {
         String::Value value(str);
         nbytes = base64_decode(buf, buflen, *value, value.length());
@@ -350,6 +429,9 @@ size_t StringBytes::Write(Isolate* isolate,
     case HEX:
       if (is_extern) {
         nbytes = hex_decode(buf, buflen, data, external_nbytes);
+      } else if (str->IsOneByte()) {
+        OneByteValue value(str);
+        nbytes = hex_decode(buf, buflen, *value, value.length());
       } else {
         String::Value value(str);
         nbytes = hex_decode(buf, buflen, *value, value.length());
@@ -492,6 +574,10 @@ static bool contains_non_ascii_slow(const char* buf, size_t len) {
 
 
 static bool contains_non_ascii(const char* src, size_t len) {
+  const size_t ascii = ascii_prefix_simd(src, len);
+  src += ascii;
+  len -= ascii;
+
   if (len < 16) {
     return contains_non_ascii_slow(src, len);
   }
@@ -541,6 +627,11 @@ static void force_ascii_slow(const char* src, char* dst, size_t len) {
 
 
 static void force_ascii(const char* src, char* dst, size_t len) {
+  const size_t done = force_ascii_simd(src, dst, len);
+  src += done;
+  dst += done;
+  len -= done;
+
   if (len < 16) {
     force_ascii_slow(src, dst, len);
     return;
@@ -585,6 +676,81 @@ static void force_ascii(const char* src, char* dst, size_t len) {
 }
 
 
+// Decodes UTF-8 to UTF-16 the way V8's String::NewFromUtf8() does: every byte
+// that does not start a complete, shortest-form sequence becomes a U+FFFD.
+// |dst| must have room for |len| characters.  Returns the number of
+// characters written and sets |max| to the largest one, so the caller can
+// tell if the result fits in a one-byte string.
+static size_t utf8_to_utf16(const char* src,
+                            size_t len,
+                            uint16_t* dst,
+                            uint16_t* max) {
+  static const uint16_t kBadChar = 0xfffd;
+  const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+  uint16_t* const start = dst;
+  uint16_t largest = 0;
+  size_t i = 0;
+
+  while (i < len) {
+    const size_t ascii = ascii_to_utf16_simd(src + i, len - i, dst);
+    i += ascii;
+    dst += ascii;
+
+    for (; i < len && s[i] < 0x80; i++)
+      *dst++ = s[i];
+    if (i == len)
+      break;
+
+    // Same as unibrow::Utf8::CalculateValue(), which lets surrogates through
+    // and accepts code points up to U+1FFFFF.
+    const size_t avail = len - i;
+    const uint8_t c = s[i];
+    uint32_t code_point = kBadChar;
+    size_t n = 1;
+    if (c >= 0xc0 && avail >= 2 && (s[i + 1] & 0xc0) == 0x80) {
+      const uint32_t c1 = s[i + 1] & 0x3f;
+      if (c < 0xe0) {
+        const uint32_t cp = ((c & 0x1f) << 6) | c1;
+        if (cp >= 0x80) {
+          code_point = cp;
+          n = 2;
+        }
+      } else if (avail >= 3 && (s[i + 2] & 0xc0) == 0x80) {
+        const uint32_t c2 = s[i + 2] & 0x3f;
+        if (c < 0xf0) {
+          const uint32_t cp = ((c & 0x0f) << 12) | (c1 << 6) | c2;
+          if (cp >= 0x800) {
+            code_point = cp;
+            n = 3;
+          }
+        } else if (c < 0xf8 && avail >= 4 && (s[i + 3] & 0xc0) == 0x80) {
+          const uint32_t cp =
+              ((c & 0x07) << 18) | (c1 << 12) | (c2 << 6) | (s[i + 3] & 0x3f);
+          if (cp >= 0x10000) {
+            code_point = cp;
+            n = 4;
+          }
+        }
+      }
+    }
+    i += n;
+
+    if (code_point > 0xffff) {
+      *dst++ = 0xd800 + (((code_point - 0x10000) >> 10) & 0x3ff);
+      *dst++ = 0xdc00 + (code_point & 0x3ff);
+      largest = 0xffff;
+    } else {
+      *dst++ = code_point;
+      if (code_point > largest)
+        largest = code_point;
+    }
+  }
+
+  *max = largest;
+  return dst - start;
+}
+
+
 static size_t base64_encode(const char* src,
                             size_t slen,
                             char* dst,
@@ -606,8 +772,8 @@ static size_t base64_encode(const char* src,
                               "abcdefghijklmnopqrstuvwxyz"
                               "0123456789+/";
 
-  i = 0;
-  k = 0;
+  i = base64_encode_simd(src, slen, dst);
+  k = i / 3 * 4;
   n = slen / 3 * 3;
 
   while (i < n) {
@@ -655,7 +821,8 @@ static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
       "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (uint32_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  const uint32_t done = hex_encode_simd(src, slen, dst);
+  for (uint32_t i = done, k = 2 * done; k < dlen; i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -702,10 +869,54 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       break;
 
     case UTF8:
-      val = String::NewFromUtf8(isolate,
-                                buf,
-                                String::kNormalString,
-                                buflen);
+      // Pure ASCII, which most text is, maps straight to a one-byte string.
+      if (!contains_non_ascii(buf, buflen)) {
+        if (buflen < EXTERN_APEX)
+          val = OneByteString(isolate, buf, buflen);
+        else
+          val = ExternOneByteString::NewFromCopy(isolate, buf, buflen);
+        break;
+      }
+
+      // Anything else is transcoded in a single pass, which is cheaper than
+      // letting V8 scan it once for the length and again to decode it.
+      if (buflen < EXTERN_APEX) {
+        uint16_t stack_dst[1024];
+        uint16_t* dst = stack_dst;
+        if (buflen > ARRAY_SIZE(stack_dst))
+          dst = new uint16_t[buflen];
+        uint16_t max;
+        size_t dlen = utf8_to_utf16(buf, buflen, dst, &max);
+        // V8 stores the result as a one-byte string if it can.
+        val = String::NewFromTwoByte(isolate,
+                                     dst,
+                                     String::kNormalString,
+                                     dlen);
+        if (dst != stack_dst)
+          delete[] dst;
+      } else {
+        uint16_t* dst = new uint16_t[buflen];
+        uint16_t max;
+        size_t dlen = utf8_to_utf16(buf, buflen, dst, &max);
+        if (max <= 0xff) {
+          // Latin-1 only, narrow it to half the size.
+          char* latin1 = new char[dlen];
+          for (size_t i = 0; i < dlen; i++)
+            latin1[i] = static_cast<char>(dst[i]);
+          delete[] dst;
+          val = ExternOneByteString::New(isolate, latin1, dlen);
+        } else {
+          if (dlen < buflen) {
+            // |dst| is sized for the worst case, don't keep the slack alive
+            // for as long as the string lives.
+            uint16_t* exact = new uint16_t[dlen];
+            memcpy(exact, dst, dlen * sizeof(*exact));
+            delete[] dst;
+            dst = exact;
+          }
+          val = ExternTwoByteString::New(isolate, dst, dlen);
+        }
+      }
       break;
 
     case BINARY:
@@ -0,0 +1,638 @@
+#include "string_bytes_simd.h"
+#include "node_cpu_features.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// The kernels are compiled with per-function target attributes so that the
+// rest of the binary does not require the instruction sets they use.  That
+// needs a compiler that allows intrinsics in such functions without the
+// matching -m flags.
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__clang__) ||                                                    \
+     __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+# define NODE_STRING_BYTES_SIMD 1
+# include <immintrin.h>
+# define NODE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace node {
+
+#if defined(NODE_STRING_BYTES_SIMD)
+
+enum SimdLevel {
+  SIMD_NONE,
+  SIMD_SSE2,
+  SIMD_SSSE3,
+  SIMD_AVX2
+};
+
+
+static inline SimdLevel GetSimdLevel() {
+  unsigned int features = CpuFeatures();
+  if (features & kCpuAVX2)
+    return SIMD_AVX2;
+  if (features & kCpuSSSE3)
+    return SIMD_SSSE3;
+  if (features & kCpuSSE2)
+    return SIMD_SSE2;
+  return SIMD_NONE;
+}
+
+
+//// Base 64 ////
+
+// Splits 12 input bytes (at offsets 0-11 of each 128 bit lane) into sixteen
+// 6 bit indices, one per byte.  See Wojciech Mula and Daniel Lemire, "Faster
+// Base64 Encoding and Decoding using AVX2 Instructions".
+static const int32_t kBase64EncodeMaskA = 0x0fc0fc00;
+static const int32_t kBase64EncodeMulA = 0x04000040;
+static const int32_t kBase64EncodeMaskB = 0x003f03f0;
+static const int32_t kBase64EncodeMulB = 0x01000010;
+
+
+NODE_TARGET("ssse3")
+static inline __m128i base64_encode_block_ssse3(__m128i in) {
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                         4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(kBase64EncodeMaskA));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(kBase64EncodeMulA));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(kBase64EncodeMaskB));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(kBase64EncodeMulB));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  // Map 0-25 to 13, 26-51 to 0, 52-61 to 1-10, 62 to 11 and 63 to 12, then
+  // look up the offset that turns the index into its ASCII character.
+  __m128i offset = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  offset = _mm_or_si128(offset, _mm_and_si128(less, _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '+' - 62,
+                                        '/' - 63, 'A', 0, 0);
+  offset = _mm_shuffle_epi8(offsets, offset);
+  return _mm_add_epi8(indices, offset);
+}
+
+
+NODE_TARGET("avx2")
+static inline __m256i base64_encode_block_avx2(__m256i in) {
+  in = _mm256_shuffle_epi8(in, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                               4, 5, 3, 4, 1, 2, 0, 1,
+                                               10, 11, 9, 10, 7, 8, 6, 7,
+                                               4, 5, 3, 4, 1, 2, 0, 1));
+  const __m256i t0 =
+      _mm256_and_si256(in, _mm256_set1_epi32(kBase64EncodeMaskA));
+  const __m256i t1 =
+      _mm256_mulhi_epu16(t0, _mm256_set1_epi32(kBase64EncodeMulA));
+  const __m256i t2 =
+      _mm256_and_si256(in, _mm256_set1_epi32(kBase64EncodeMaskB));
+  const __m256i t3 =
+      _mm256_mullo_epi16(t2, _mm256_set1_epi32(kBase64EncodeMulB));
+  const __m256i indices = _mm256_or_si256(t1, t3);
+
+  __m256i offset = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+  const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+  offset = _mm256_or_si256(offset,
+                           _mm256_and_si256(less, _mm256_set1_epi8(13)));
+  const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '+' - 62,
+                                           '/' - 63, 'A', 0, 0,
+                                           'a' - 26, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '+' - 62,
+                                           '/' - 63, 'A', 0, 0);
+  offset = _mm256_shuffle_epi8(offsets, offset);
+  return _mm256_add_epi8(indices, offset);
+}
+
+
+NODE_TARGET("ssse3")
+static size_t base64_encode_ssse3(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+  // Loads 16 bytes but only consumes 12.
+  for (; i + 16 <= slen; i += 12, dst += 16) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     base64_encode_block_ssse3(in));
+  }
+  return i;
+}
+
+
+NODE_TARGET("avx2")
+static size_t base64_encode_avx2(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+  // Two 16 byte loads, 12 bytes apart, consume 24 bytes.
+  for (; i + 28 <= slen; i += 24, dst += 32) {
+    const __m128i lo =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12));
+    const __m256i in =
+        _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                        base64_encode_block_avx2(in));
+  }
+  return i;
+}
+
+
+NODE_TARGET("sse2")
+static inline __m128i in_range_sse2(__m128i in, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8(lo - 1)),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), in));
+}
+
+
+// Translates characters from both the standard and the URL-safe alphabet to
+// their 6 bit values.  Returns false if the block contains anything else,
+// including whitespace and padding, which is left to the scalar decoder.
+NODE_TARGET("sse2")
+static inline bool base64_decode_values_sse2(__m128i in, __m128i* out) {
+  const __m128i upper = in_range_sse2(in, 'A', 'Z');
+  const __m128i lower = in_range_sse2(in, 'a', 'z');
+  const __m128i digit = in_range_sse2(in, '0', '9');
+  const __m128i plus = _mm_cmpeq_epi8(in, _mm_set1_epi8('+'));
+  const __m128i minus = _mm_cmpeq_epi8(in, _mm_set1_epi8('-'));
+  const __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+  const __m128i underscore = _mm_cmpeq_epi8(in, _mm_set1_epi8('_'));
+
+  const __m128i valid =
+      _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower),
+                                _mm_or_si128(digit, plus)),
+                   _mm_or_si128(_mm_or_si128(minus, slash), underscore));
+  if (_mm_movemask_epi8(valid) != 0xffff)
+    return false;
+
+  __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+  shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+  shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+  shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+  shift = _mm_or_si128(shift, _mm_and_si128(minus, _mm_set1_epi8(62 - '-')));
+  shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+  shift = _mm_or_si128(shift,
+                       _mm_and_si128(underscore, _mm_set1_epi8(63 - '_')));
+  *out = _mm_add_epi8(in, shift);
+  return true;
+}
+
+
+NODE_TARGET("avx2")
+static inline __m256i in_range_avx2(__m256i in, char lo, char hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8(lo - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), in));
+}
+
+
+NODE_TARGET("avx2")
+static inline bool base64_decode_values_avx2(__m256i in, __m256i* out) {
+  const __m256i upper = in_range_avx2(in, 'A', 'Z');
+  const __m256i lower = in_range_avx2(in, 'a', 'z');
+  const __m256i digit = in_range_avx2(in, '0', '9');
+  const __m256i plus = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('+'));
+  const __m256i minus = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('-'));
+  const __m256i slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+  const __m256i underscore = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('_'));
+
+  const __m256i valid =
+      _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower),
+                                      _mm256_or_si256(digit, plus)),
+                      _mm256_or_si256(_mm256_or_si256(minus, slash),
+                                      underscore));
+  if (_mm256_movemask_epi8(valid) != -1)
+    return false;
+
+  __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+  shift = _mm256_or_si256(
+      shift, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+  shift = _mm256_or_si256(
+      shift, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+  shift = _mm256_or_si256(
+      shift, _mm256_and_si256(plus, _mm256_set1_epi8(62 - '+')));
+  shift = _mm256_or_si256(
+      shift, _mm256_and_si256(minus, _mm256_set1_epi8(62 - '-')));
+  shift = _mm256_or_si256(
+      shift, _mm256_and_si256(slash, _mm256_set1_epi8(63 - '/')));
+  shift = _mm256_or_si256(
+      shift, _mm256_and_si256(underscore, _mm256_set1_epi8(63 - '_')));
+  *out = _mm256_add_epi8(in, shift);
+  return true;
+}
+
+
+// Packs sixteen 6 bit values into 12 bytes at the bottom of each lane.
+NODE_TARGET("ssse3")
+static inline __m128i base64_decode_pack_ssse3(__m128i values) {
+  const __m128i merged =
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4,
+                                                10, 9, 8, 14, 13, 12,
+                                                -1, -1, -1, -1));
+}
+
+
+NODE_TARGET("avx2")
+static inline __m256i base64_decode_pack_avx2(__m256i values) {
+  const __m256i merged =
+      _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+  const __m256i packed =
+      _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+  const __m256i shuffled =
+      _mm256_shuffle_epi8(packed, _mm256_setr_epi8(2, 1, 0, 6, 5, 4,
+                                                   10, 9, 8, 14, 13, 12,
+                                                   -1, -1, -1, -1,
+                                                   2, 1, 0, 6, 5, 4,
+                                                   10, 9, 8, 14, 13, 12,
+                                                   -1, -1, -1, -1));
+  // Move the 24 payload bytes to the bottom of the register.
+  return _mm256_permutevar8x32_epi32(shuffled,
+                                     _mm256_setr_epi32(0, 1, 2, 4, 5, 6,
+                                                       3, 7));
+}
+
+
+// Writes exactly 12 bytes, the destination may be a slice of a larger buffer
+// whose remaining contents must not be touched.
+NODE_TARGET("sse2")
+static inline void store12_sse2(char* dst, __m128i v) {
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), v);
+  const int32_t hi = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+  memcpy(dst + 8, &hi, sizeof(hi));
+}
+
+
+NODE_TARGET("ssse3")
+static size_t base64_decode_ssse3(char* dst,
+                                  size_t dlen,
+                                  const char* src,
+                                  size_t slen) {
+  size_t i = 0;
+  size_t k = 0;
+  for (; i + 16 <= slen && k + 12 <= dlen; i += 16, k += 12) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i values;
+    if (!base64_decode_values_sse2(in, &values))
+      break;
+    store12_sse2(dst + k, base64_decode_pack_ssse3(values));
+  }
+  return i;
+}
+
+
+NODE_TARGET("avx2")
+static size_t base64_decode_avx2(char* dst,
+                                 size_t dlen,
+                                 const char* src,
+                                 size_t slen) {
+  size_t i = 0;
+  size_t k = 0;
+  for (; i + 32 <= slen && k + 24 <= dlen; i += 32, k += 24) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i values;
+    if (!base64_decode_values_avx2(in, &values))
+      break;
+    const __m256i out = base64_decode_pack_avx2(values);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k),
+                     _mm256_castsi256_si128(out));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k + 16),
+                     _mm256_extracti128_si256(out, 1));
+  }
+  return i;
+}
+
+
+//// HEX ////
+
+NODE_TARGET("sse2")
+static inline __m128i hex_digits_sse2(__m128i nibbles) {
+  const __m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+  const __m128i offset =
+      _mm_add_epi8(_mm_set1_epi8('0'),
+                   _mm_and_si128(letters, _mm_set1_epi8('a' - '0' - 10)));
+  return _mm_add_epi8(nibbles, offset);
+}
+
+
+NODE_TARGET("sse2")
+static size_t hex_encode_sse2(const char* src, size_t slen, char* dst) {
+  const __m128i low_nibble = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= slen; i += 16, dst += 32) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi =
+        hex_digits_sse2(_mm_and_si128(_mm_srli_epi16(in, 4), low_nibble));
+    const __m128i lo = hex_digits_sse2(_mm_and_si128(in, low_nibble));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16),
+                     _mm_unpackhi_epi8(hi, lo));
+  }
+  return i;
+}
+
+
+NODE_TARGET("avx2")
+static inline __m256i hex_digits_avx2(__m256i nibbles) {
+  const __m256i letters = _mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9));
+  const __m256i offset =
+      _mm256_add_epi8(_mm256_set1_epi8('0'),
+                      _mm256_and_si256(letters,
+                                       _mm256_set1_epi8('a' - '0' - 10)));
+  return _mm256_add_epi8(nibbles, offset);
+}
+
+
+NODE_TARGET("avx2")
+static size_t hex_encode_avx2(const char* src, size_t slen, char* dst) {
+  const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= slen; i += 32, dst += 64) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i hi = hex_digits_avx2(
+        _mm256_and_si256(_mm256_srli_epi16(in, 4), low_nibble));
+    const __m256i lo = hex_digits_avx2(_mm256_and_si256(in, low_nibble));
+    // unpack works within 128 bit lanes, put the halves back in order.
+    const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                        _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32),
+                        _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  return i;
+}
+
+
+// Turns hex digits into their values, returns false if the block contains
+// any other character.
+NODE_TARGET("sse2")
+static inline bool hex_values_sse2(__m128i in, __m128i* out) {
+  const __m128i digit = in_range_sse2(in, '0', '9');
+  const __m128i upper = in_range_sse2(in, 'A', 'F');
+  const __m128i lower = in_range_sse2(in, 'a', 'f');
+  const __m128i valid = _mm_or_si128(_mm_or_si128(digit, upper), lower);
+  if (_mm_movemask_epi8(valid) != 0xffff)
+    return false;
+
+  __m128i shift = _mm_and_si128(digit, _mm_set1_epi8(-'0'));
+  shift = _mm_or_si128(shift, _mm_and_si128(upper, _mm_set1_epi8(10 - 'A')));
+  shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(10 - 'a')));
+  // Combine each pair of nibbles into one byte in the low half of a word.
+  const __m128i values = _mm_add_epi8(in, shift);
+  *out = _mm_or_si128(
+      _mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00ff)), 4),
+      _mm_srli_epi16(values, 8));
+  return true;
+}
+
+
+NODE_TARGET("sse2")
+static size_t hex_decode_sse2(char* dst,
+                              size_t dlen,
+                              const char* src,
+                              size_t slen) {
+  size_t k = 0;
+  for (; 2 * k + 32 <= slen && k + 16 <= dlen; k += 16) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * k));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * k + 16));
+    __m128i va;
+    __m128i vb;
+    if (!hex_values_sse2(a, &va) || !hex_values_sse2(b, &vb))
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k),
+                     _mm_packus_epi16(va, vb));
+  }
+  return k;
+}
+
+
+NODE_TARGET("avx2")
+static inline bool hex_values_avx2(__m256i in, __m256i* out) {
+  const __m256i digit = in_range_avx2(in, '0', '9');
+  const __m256i upper = in_range_avx2(in, 'A', 'F');
+  const __m256i lower = in_range_avx2(in, 'a', 'f');
+  const __m256i valid =
+      _mm256_or_si256(_mm256_or_si256(digit, upper), lower);
+  if (_mm256_movemask_epi8(valid) != -1)
+    return false;
+
+  __m256i shift = _mm256_and_si256(digit, _mm256_set1_epi8(-'0'));
+  shift = _mm256_or_si256(
+      shift, _mm256_and_si256(upper, _mm256_set1_epi8(10 - 'A')));
+  shift = _mm256_or_si256(
+      shift, _mm256_and_si256(lower, _mm256_set1_epi8(10 - 'a')));
+  const __m256i values = _mm256_add_epi8(in, shift);
+  *out = _mm256_or_si256(
+      _mm256_slli_epi16(_mm256_and_si256(values, _mm256_set1_epi16(0x00ff)),
+                        4),
+      _mm256_srli_epi16(values, 8));
+  return true;
+}
+
+
+NODE_TARGET("avx2")
+static size_t hex_decode_avx2(char* dst,
+                              size_t dlen,
+                              const char* src,
+                              size_t slen) {
+  size_t k = 0;
+  for (; 2 * k + 64 <= slen && k + 32 <= dlen; k += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * k));
+    const __m256i b = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(src + 2 * k + 32));
+    __m256i va;
+    __m256i vb;
+    if (!hex_values_avx2(a, &va) || !hex_values_avx2(b, &vb))
+      break;
+    // packus works within 128 bit lanes, restore the order of the quadwords.
+    const __m256i packed = _mm256_packus_epi16(va, vb);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k),
+                        _mm256_permute4x64_epi64(packed, 0xd8));
+  }
+  return k;
+}
+
+
+//// ASCII ////
+
+NODE_TARGET("sse2")
+static size_t ascii_prefix_sse2(const char* src, size_t len) {
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) {
+    const __m128i* p = reinterpret_cast<const __m128i*>(src + i);
+    const __m128i a = _mm_or_si128(_mm_loadu_si128(p + 0),
+                                   _mm_loadu_si128(p + 1));
+    const __m128i b = _mm_or_si128(_mm_loadu_si128(p + 2),
+                                   _mm_loadu_si128(p + 3));
+    if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+      break;
+  }
+  for (; i + 16 <= len; i += 16) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (_mm_movemask_epi8(in) != 0)
+      break;
+  }
+  return i;
+}
+
+
+NODE_TARGET("sse2")
+static size_t force_ascii_sse2(const char* src, char* dst, size_t len) {
+  const __m128i mask = _mm_set1_epi8(0x7f);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_and_si128(in, mask));
+  }
+  return i;
+}
+
+
+NODE_TARGET("sse2")
+static size_t ascii_to_utf16_sse2(const char* src,
+                                  size_t len,
+                                  uint16_t* dst) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (_mm_movemask_epi8(in) != 0)
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_unpacklo_epi8(in, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8),
+                     _mm_unpackhi_epi8(in, zero));
+  }
+  return i;
+}
+
+
+size_t base64_encode_simd(const char* src, size_t slen, char* dst) {
+  const SimdLevel level = GetSimdLevel();
+  size_t i = 0;
+  if (level >= SIMD_AVX2)
+    i = base64_encode_avx2(src, slen, dst);
+  if (level >= SIMD_SSSE3)
+    i += base64_encode_ssse3(src + i, slen - i, dst + i / 3 * 4);
+  return i;
+}
+
+
+size_t base64_decode_simd(char* dst, size_t dlen, const char* src,
+                          size_t slen) {
+  const SimdLevel level = GetSimdLevel();
+  size_t i = 0;
+  if (level >= SIMD_AVX2)
+    i = base64_decode_avx2(dst, dlen, src, slen);
+  if (level >= SIMD_SSSE3) {
+    const size_t k = i / 4 * 3;
+    i += base64_decode_ssse3(dst + k, dlen - k, src + i, slen - i);
+  }
+  return i;
+}
+
+
+size_t hex_encode_simd(const char* src, size_t slen, char* dst) {
+  const SimdLevel level = GetSimdLevel();
+  size_t i = 0;
+  if (level >= SIMD_AVX2)
+    i = hex_encode_avx2(src, slen, dst);
+  if (level >= SIMD_SSE2)
+    i += hex_encode_sse2(src + i, slen - i, dst + 2 * i);
+  return i;
+}
+
+
+size_t hex_decode_simd(char* dst, size_t dlen, const char* src, size_t slen) {
+  const SimdLevel level = GetSimdLevel();
+  size_t k = 0;
+  if (level >= SIMD_AVX2)
+    k = hex_decode_avx2(dst, dlen, src, slen);
+  if (level >= SIMD_SSE2)
+    k += hex_decode_sse2(dst + k, dlen - k, src + 2 * k, slen - 2 * k);
+  return k;
+}
+
+
+
+size_t ascii_prefix_simd(const char* src, size_t len) {
+  if (GetSimdLevel() >= SIMD_SSE2)
+    return ascii_prefix_sse2(src, len);
+  return 0;
+}
+
+
+size_t force_ascii_simd(const char* src, char* dst, size_t len) {
+  if (GetSimdLevel() >= SIMD_SSE2)
+    return force_ascii_sse2(src, dst, len);
+  return 0;
+}
+
+
+size_t ascii_to_utf16_simd(const char* src, size_t len, uint16_t* dst) {
+  if (GetSimdLevel() >= SIMD_SSE2)
+    return ascii_to_utf16_sse2(src, len, dst);
+  return 0;
+}
+
+
+#else  // !defined(NODE_STRING_BYTES_SIMD)
+
+size_t base64_encode_simd(const char* src, size_t slen, char* dst) {
+  return 0;
+}
+
+
+size_t base64_decode_simd(char* dst, size_t dlen, const char* src,
+                          size_t slen) {
+  return 0;
+}
+
+
+size_t hex_encode_simd(const char* src, size_t slen, char* dst) {
+  return 0;
+}
+
+
+size_t hex_decode_simd(char* dst, size_t dlen, const char* src, size_t slen) {
+  return 0;
+}
+
+
+
+size_t ascii_prefix_simd(const char* src, size_t len) {
+  return 0;
+}
+
+
+size_t force_ascii_simd(const char* src, char* dst, size_t len) {
+  return 0;
+}
+
+
+size_t ascii_to_utf16_simd(const char* src, size_t len, uint16_t* dst) {
+  return 0;
+}
+
+
+#endif  // defined(NODE_STRING_BYTES_SIMD)
+
+}  // namespace node
@@ -0,0 +1,50 @@
+#ifndef SRC_STRING_BYTES_SIMD_H_
+#define SRC_STRING_BYTES_SIMD_H_
+
+// Vectorized kernels for the StringBytes encoders and decoders.
+//
+// Every kernel processes as much of its input as it can in whole blocks and
+// returns how far it got, the caller finishes the remainder with the scalar
+// code in string_bytes.cc.  The best implementation for the CPU is picked at
+// runtime; on platforms without SIMD support the kernels do nothing and
+// return 0.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// Encodes a prefix of |src| whose length is a multiple of 3.  Returns the
+// number of bytes consumed, |consumed| / 3 * 4 characters are written to |dst|.
+size_t base64_encode_simd(const char* src, size_t slen, char* dst);
+
+// Decodes a prefix of |src| that consists of whole blocks of characters from
+// either base64 alphabet, stopping at whitespace, padding or any other
+// character.  Never writes more than |dlen| bytes.  Returns the number of
+// characters consumed, a multiple of 4; |consumed| / 4 * 3 bytes are written.
+size_t base64_decode_simd(char* dst, size_t dlen, const char* src, size_t slen);
+
+// Encodes a prefix of |src|, returns the number of bytes consumed.  Twice that
+// many characters are written to |dst|.
+size_t hex_encode_simd(const char* src, size_t slen, char* dst);
+
+// Decodes a prefix of |src| up to the first block that contains a character
+// that is not a hex digit.  Never writes more than |dlen| bytes.  Returns the
+// number of bytes written, twice that many characters are consumed.
+size_t hex_decode_simd(char* dst, size_t dlen, const char* src, size_t slen);
+
+// Returns the length of a prefix of |src| that is known to be pure ASCII.  The
+// byte that follows it may still be ASCII.
+size_t ascii_prefix_simd(const char* src, size_t len);
+
+// Clears the high bit of a prefix of |src| while copying it to |dst|, returns
+// the number of bytes copied.
+size_t force_ascii_simd(const char* src, char* dst, size_t len);
+
+// Widens a prefix of |src| that is pure ASCII to UTF-16, returns the number of
+// characters converted.
+size_t ascii_to_utf16_simd(const char* src, size_t len, uint16_t* dst);
+
+}  // namespace node
+
+#endif  // SRC_STRING_BYTES_SIMD_H_
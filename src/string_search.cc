@@ -0,0 +1,141 @@
+#include "string_search.h"
+#include "util.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace node {
+
+StringSearch::StringSearch(const char* needle, size_t needle_length)
+    : needle_(reinterpret_cast<const uint8_t*>(needle)),
+      needle_length_(needle_length),
+      skip_table_ready_(false) {
+  CHECK_GT(needle_length, 0);
+  if (needle_length == 1)
+    algorithm_ = SINGLE_BYTE;
+  else if (needle_length < kHorspoolMinNeedleLength)
+    algorithm_ = SHORT_NEEDLE;
+  else
+    algorithm_ = HORSPOOL;
+}
+
+
+size_t StringSearch::Search(const char* haystack,
+                            size_t haystack_length,
+                            size_t start) {
+  if (start > haystack_length || haystack_length - start < needle_length_)
+    return kNotFound;
+
+  const uint8_t* subject = reinterpret_cast<const uint8_t*>(haystack);
+
+  switch (algorithm_) {
+    case SINGLE_BYTE:
+      return SingleByteSearch(subject, haystack_length, start);
+    case SHORT_NEEDLE:
+      return ShortNeedleSearch(subject, haystack_length, start);
+    case HORSPOOL:
+      if (!skip_table_ready_ &&
+          haystack_length - start < kHorspoolMinHaystackLength) {
+        return ShortNeedleSearch(subject, haystack_length, start);
+      }
+      return HorspoolSearch(subject, haystack_length, start);
+  }
+
+  UNREACHABLE();
+}
+
+
+size_t StringSearch::SingleByteSearch(const uint8_t* haystack,
+                                      size_t haystack_length,
+                                      size_t start) const {
+  const void* ptr =
+      memchr(haystack + start, needle_[0], haystack_length - start);
+  if (ptr == nullptr)
+    return kNotFound;
+  return static_cast<const uint8_t*>(ptr) - haystack;
+}
+
+
+size_t StringSearch::ShortNeedleSearch(const uint8_t* haystack,
+                                       size_t haystack_length,
+                                       size_t start) const {
+  const size_t last = needle_length_ - 1;
+  const uint8_t first_byte = needle_[0];
+  const uint8_t last_byte = needle_[last];
+  size_t i = start;
+
+#if defined(__SSE2__)
+  // Compare 16 candidate positions per iteration against both the first and
+  // the last byte of the needle; only positions where both match are checked
+  // with memcmp().  This keeps false positives low even for needles made of
+  // common characters, e.g. "\r\n".
+  const __m128i first = _mm_set1_epi8(static_cast<char>(first_byte));
+  const __m128i tail = _mm_set1_epi8(static_cast<char>(last_byte));
+
+  while (i + last + 16 <= haystack_length) {
+    const __m128i block_first = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(haystack + i));
+    const __m128i block_last = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(haystack + i + last));
+    unsigned int mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                      _mm_cmpeq_epi8(block_last, tail)));
+    while (mask != 0) {
+      const unsigned int bit = __builtin_ctz(mask);
+      if (memcmp(haystack + i + bit + 1, needle_ + 1, last - 1) == 0)
+        return i + bit;
+      mask &= mask - 1;
+    }
+    i += 16;
+  }
+#endif
+
+  // Scalar path for the tail, or for the whole haystack when SSE2 is not
+  // available: memchr() for the first byte, then verify the rest.
+  while (i + last < haystack_length) {
+    const void* ptr =
+        memchr(haystack + i, first_byte, haystack_length - last - i);
+    if (ptr == nullptr)
+      return kNotFound;
+    i = static_cast<const uint8_t*>(ptr) - haystack;
+    if (haystack[i + last] == last_byte &&
+        memcmp(haystack + i + 1, needle_ + 1, last - 1) == 0) {
+      return i;
+    }
+    i++;
+  }
+
+  return kNotFound;
+}
+
+
+size_t StringSearch::HorspoolSearch(const uint8_t* haystack,
+                                    size_t haystack_length,
+                                    size_t start) {
+  const size_t last = needle_length_ - 1;
+
+  if (!skip_table_ready_) {
+    for (size_t i = 0; i < 256; i++)
+      skip_table_[i] = needle_length_;
+    for (size_t i = 0; i < last; i++)
+      skip_table_[needle_[i]] = last - i;
+    skip_table_ready_ = true;
+  }
+
+  const uint8_t last_byte = needle_[last];
+  size_t i = start;
+
+  while (i + last < haystack_length) {
+    const uint8_t c = haystack[i + last];
+    if (c == last_byte && memcmp(haystack + i, needle_, last) == 0)
+      return i;
+    i += skip_table_[c];
+  }
+
+  return kNotFound;
+}
+
+}  // namespace node
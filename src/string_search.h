@@ -0,0 +1,79 @@
+#ifndef SRC_STRING_SEARCH_H_
+#define SRC_STRING_SEARCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// Byte-oriented substring search. The algorithm is chosen once per needle:
+//
+//  - 1 byte: memchr()
+//  - short needles: SSE2 scan that filters candidates on the first and the
+//    last byte of the needle at the same time, memcmp() to confirm
+//  - long needles: Boyer-Moore-Horspool
+//
+// The Horspool skip table is built on first use and kept for the lifetime of
+// the object, which makes it cheap to run the same needle against many
+// haystacks. The needle is not copied; it must outlive the StringSearch.
+class StringSearch {
+ public:
+  static const size_t kNotFound = static_cast<size_t>(-1);
+
+  // Needles of at least this many bytes are searched with Horspool.
+  static const size_t kHorspoolMinNeedleLength = 16;
+
+  // Building the skip table does not pay off for haystacks smaller than this
+  // and the short needle scan is used for them instead.
+  static const size_t kHorspoolMinHaystackLength = 1024;
+
+  StringSearch(const char* needle, size_t needle_length);
+
+  // Returns the offset of the first occurrence of the needle at or after
+  // |start| in |haystack|, or kNotFound.
+  size_t Search(const char* haystack, size_t haystack_length, size_t start = 0);
+
+  inline const char* needle() const {
+    return reinterpret_cast<const char*>(needle_);
+  }
+
+  inline size_t needle_length() const {
+    return needle_length_;
+  }
+
+  // One-shot convenience wrapper around Search().
+  static inline size_t Find(const char* haystack,
+                            size_t haystack_length,
+                            const char* needle,
+                            size_t needle_length) {
+    StringSearch search(needle, needle_length);
+    return search.Search(haystack, haystack_length);
+  }
+
+ private:
+  enum Algorithm {
+    SINGLE_BYTE,
+    SHORT_NEEDLE,
+    HORSPOOL
+  };
+
+  size_t SingleByteSearch(const uint8_t* haystack,
+                          size_t haystack_length,
+                          size_t start) const;
+  size_t ShortNeedleSearch(const uint8_t* haystack,
+                           size_t haystack_length,
+                           size_t start) const;
+  size_t HorspoolSearch(const uint8_t* haystack,
+                        size_t haystack_length,
+                        size_t start);
+
+  const uint8_t* needle_;
+  size_t needle_length_;
+  Algorithm algorithm_;
+  bool skip_table_ready_;
+  size_t skip_table_[256];
+};
+
+}  // namespace node
+
+#endif  // SRC_STRING_SEARCH_H_
@@ -90,6 +90,9 @@ void TCPWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "unref", HandleWrap::Unref);
 
   StreamWrap::AddMethods(env, t, StreamBase::kFlagHasWritev);
+#if !defined(_WIN32)
+  env->SetProtoMethod(t, "sendFile", StreamWrap::SendFile);
+#endif
 
   env->SetProtoMethod(t, "open", Open);
   env->SetProtoMethod(t, "bind", Bind);
@@ -26,6 +26,7 @@ using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Handle;
+using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Null;
@@ -54,7 +55,20 @@ TLSWrap::TLSWrap(Environment* env,
       shutdown_(false),
       error_(nullptr),
       cycle_depth_(0),
-      eof_(false) {
+      eof_(false),
+      async_crypto_(false),
+      encrypting_(false),
+      crypto_in_(nullptr),
+      enc_out_done_(false),
+      enc_out_status_(0),
+      read_error_(0),
+      shutdown_req_(nullptr),
+      renegotiate_pending_(false),
+      dynamic_record_size_(false),
+      record_size_(kMaxRecordSize),
+      applied_record_size_(kMaxRecordSize),
+      last_write_time_(0),
+      idle_bytes_(0) {
   node::Wrap(object(), this);
   MakeWeak(this);
 
@@ -79,6 +93,8 @@ TLSWrap::~TLSWrap() {
   enc_out_ = nullptr;
   delete clear_in_;
   clear_in_ = nullptr;
+  delete crypto_in_;
+  crypto_in_ = nullptr;
 
   sc_ = nullptr;
 
@@ -278,6 +294,10 @@ void TLSWrap::EncOut() {
   if (is_waiting_new_session())
     return;
 
+  // `enc_out_` is being written to on the threadpool
+  if (encrypting_)
+    return;
+
   // Split-off queue
   if (established_ && !write_item_queue_.IsEmpty())
     MakePending();
@@ -289,10 +309,24 @@ void TLSWrap::EncOut() {
     return;
   }
 
-  char* data[kSimultaneousBufferCount];
-  size_t size[ARRAY_SIZE(data)];
-  size_t count = ARRAY_SIZE(data);
-  write_size_ = NodeBIO::FromBIO(enc_out_)->PeekMultiple(data, size, &count);
+  // Write out all of the pending chunks at once, straight from `enc_out_`.
+  // They are consumed in EncOutCb() once the write is done.
+  NodeBIO* enc_out = NodeBIO::FromBIO(enc_out_);
+  size_t count = enc_out->ChunkCount();
+
+  char* data_[kSimultaneousBufferCount];
+  size_t size_[ARRAY_SIZE(data_)];
+  uv_buf_t buf_[ARRAY_SIZE(data_)];
+  char** data = data_;
+  size_t* size = size_;
+  uv_buf_t* buf = buf_;
+  if (count > ARRAY_SIZE(data_)) {
+    data = new char*[count];
+    size = new size_t[count];
+    buf = new uv_buf_t[count];
+  }
+
+  write_size_ = enc_out->PeekMultiple(data, size, &count);
   CHECK(write_size_ != 0 && count != 0);
 
   Local<Object> req_wrap_obj =
@@ -302,12 +336,17 @@ void TLSWrap::EncOut() {
                                         this,
                                         EncOutCb);
 
-  uv_buf_t buf[ARRAY_SIZE(data)];
   for (size_t i = 0; i < count; i++)
     buf[i] = uv_buf_init(data[i], size[i]);
   int err = stream_->DoWrite(write_req, buf, count, nullptr);
   write_req->Dispatched();
 
+  if (data != data_) {
+    delete[] data;
+    delete[] size;
+    delete[] buf;
+  }
+
   // Ignore errors, this should be already handled in js
   if (err) {
     write_req->Dispose();
@@ -322,26 +361,38 @@ void TLSWrap::EncOutCb(WriteWrap* req_wrap, int status) {
   TLSWrap* wrap = req_wrap->wrap()->Cast<TLSWrap>();
   req_wrap->Dispose();
 
+  // Commit once the threadpool is done with `enc_out_`
+  if (wrap->encrypting_) {
+    wrap->enc_out_done_ = true;
+    wrap->enc_out_status_ = status;
+    return;
+  }
+
+  wrap->AfterEncOut(status);
+}
+
+
+void TLSWrap::AfterEncOut(int status) {
   // Handle error
   if (status) {
     // Ignore errors after shutdown
-    if (wrap->shutdown_)
+    if (shutdown_)
       return;
 
     // Notify about error
-    wrap->InvokeQueued(status);
+    InvokeQueued(status);
     return;
   }
 
   // Commit
-  NodeBIO::FromBIO(wrap->enc_out_)->Read(nullptr, wrap->write_size_);
+  NodeBIO::FromBIO(enc_out_)->Read(nullptr, write_size_);
 
   // Ensure that the progress will be made and `InvokeQueued` will be called.
-  wrap->ClearIn();
+  ClearIn();
 
   // Try writing more data
-  wrap->write_size_ = 0;
-  wrap->EncOut();
+  write_size_ = 0;
+  EncOut();
 }
 
 
@@ -396,6 +447,10 @@ void TLSWrap::ClearOut() {
   if (eof_)
     return;
 
+  // Records are decrypted on the loop, once the threadpool is done
+  if (encrypting_)
+    return;
+
   CHECK_NE(ssl_, nullptr);
 
   char out[kClearOutChunkSize];
@@ -451,10 +506,21 @@ bool TLSWrap::ClearIn() {
   if (!hello_parser_.IsEnded())
     return false;
 
+  if (encrypting_)
+    return false;
+
+  if (clear_in_->Length() >= kAsyncCryptoThreshold && CanEncryptAsync()) {
+    // One record size for the whole batch
+    UpdateRecordSize(clear_in_->Length());
+    EncryptAsync();
+    return false;
+  }
+
   int written = 0;
   while (clear_in_->Length() > 0) {
     size_t avail = 0;
     char* data = clear_in_->Peek(&avail);
+    avail = UpdateRecordSize(avail);
     written = SSL_write(ssl_, data, avail);
     CHECK(written == -1 || written == static_cast<int>(avail));
     if (written == -1)
@@ -482,6 +548,134 @@ bool TLSWrap::ClearIn() {
 }
 
 
+// Appends everything that is queued in `from` to `to`
+static void MoveClearText(NodeBIO* from, NodeBIO* to) {
+  while (from->Length() > 0) {
+    size_t avail = 0;
+    char* data = from->Peek(&avail);
+    to->Write(data, avail);
+    from->Read(nullptr, avail);
+  }
+}
+
+
+bool TLSWrap::CanEncryptAsync() {
+  // Handshakes, renegotiation and shutdown stay on the loop
+  return async_crypto_ &&
+         established_ &&
+         !shutdown_ &&
+         SSL_is_init_finished(ssl_) &&
+         !SSL_renegotiate_pending(ssl_);
+}
+
+
+void TLSWrap::EncryptAsync() {
+  CHECK(!encrypting_);
+  CHECK_EQ(crypto_in_->Length(), 0);
+
+  // Hand the queued data over to the threadpool, new writes are queued
+  // behind it
+  NodeBIO* queued = clear_in_;
+  clear_in_ = crypto_in_;
+  crypto_in_ = queued;
+
+  // The isolate may not be used off the loop thread, so the buffers that
+  // `enc_out_` allocates for the job are not reported to V8
+  NodeBIO::FromBIO(enc_out_)->AssignEnvironment(nullptr);
+
+  encrypting_ = true;
+  ClearWeak();
+  uv_queue_work_class(env()->event_loop(),
+                      &crypto_req_,
+                      UV_THREADPOOL_CPU,
+                      TLSWrap::EncryptWork,
+                      TLSWrap::AfterEncrypt);
+}
+
+
+void TLSWrap::EncryptWork(uv_work_t* req) {
+  TLSWrap* wrap = ContainerOf(&TLSWrap::crypto_req_, req);
+  NodeBIO* in = wrap->crypto_in_;
+
+  while (in->Length() > 0) {
+    size_t avail = 0;
+    char* data = in->Peek(&avail);
+    // Released between the records, JS accessors of `ssl_` wait for at most
+    // one of them
+    SSLLock lock(wrap);
+    int written = SSL_write(wrap->ssl_, data, avail);
+
+    // Leave the rest to the loop, it will hit the same error and report it
+    if (written <= 0)
+      break;
+    CHECK_EQ(written, static_cast<int>(avail));
+    in->Read(nullptr, avail);
+  }
+
+  // OpenSSL's error queue is per thread
+  ERR_clear_error();
+}
+
+
+void TLSWrap::AfterEncrypt(uv_work_t* req, int status) {
+  CHECK_EQ(status, 0);
+  TLSWrap* wrap = ContainerOf(&TLSWrap::crypto_req_, req);
+  Environment* env = wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  // The wrap stays strong until the end, the JS callbacks below could
+  // otherwise let it be collected while it is still in use
+  wrap->encrypting_ = false;
+  NodeBIO::FromBIO(wrap->enc_out_)->AssignEnvironment(env);
+
+  // Whatever wasn't encrypted goes in front of the data queued meanwhile
+  if (wrap->crypto_in_->Length() > 0) {
+    NodeBIO* left = wrap->crypto_in_;
+    MoveClearText(wrap->clear_in_, left);
+    wrap->crypto_in_ = wrap->clear_in_;
+    wrap->clear_in_ = left;
+  }
+
+  if (wrap->enc_out_done_) {
+    wrap->enc_out_done_ = false;
+    wrap->AfterEncOut(wrap->enc_out_status_);
+  }
+
+  // Keeps the next writes on the loop until the handshake is done
+  if (wrap->renegotiate_pending_) {
+    wrap->renegotiate_pending_ = false;
+    SSL_renegotiate(wrap->ssl_);
+    ERR_clear_error();
+  }
+
+  // Decrypt what was received in the meantime and flush the records
+  wrap->Cycle();
+
+  // The next batch is already on its way
+  if (wrap->encrypting_)
+    return;
+
+  if (wrap->read_error_ != 0) {
+    ssize_t nread = wrap->read_error_;
+    wrap->read_error_ = 0;
+    wrap->DoRead(nread, nullptr, UV_UNKNOWN_HANDLE);
+  }
+
+  if (wrap->shutdown_req_ != nullptr) {
+    ShutdownWrap* req_wrap = wrap->shutdown_req_;
+    wrap->shutdown_req_ = nullptr;
+    int err = wrap->DoShutdown(req_wrap);
+    if (err)
+      req_wrap->Done(err);
+  }
+
+  // The callbacks may have started the next batch
+  if (!wrap->encrypting_)
+    wrap->MakeWeak(wrap);
+}
+
+
 void* TLSWrap::Cast() {
   return reinterpret_cast<void*>(this);
 }
@@ -552,7 +746,7 @@ int TLSWrap::DoWrite(WriteWrap* w,
     ClearOut();
     // However if there any data that should be written to socket,
     // callback should not be invoked immediately
-    if (BIO_pending(enc_out_) == 0)
+    if (!encrypting_ && BIO_pending(enc_out_) == 0)
       return stream_->DoWrite(w, bufs, count, send_handle);
   }
 
@@ -565,6 +759,20 @@ int TLSWrap::DoWrite(WriteWrap* w,
     return 0;
   }
 
+  // Bulk writes are queued and encrypted on the threadpool
+  if (async_crypto_) {
+    size_t total = clear_in_->Length();
+    for (i = 0; i < count; i++)
+      total += bufs[i].len;
+    if (total >= kAsyncCryptoThreshold) {
+      for (i = 0; i < count; i++)
+        clear_in_->Write(bufs[i].base, bufs[i].len);
+      ClearIn();
+      EncOut();
+      return 0;
+    }
+  }
+
   // Process enqueued data first
   if (!ClearIn()) {
     // If there're still data to process - enqueue current one
@@ -573,10 +781,39 @@ int TLSWrap::DoWrite(WriteWrap* w,
     return 0;
   }
 
+  char coalesced[kMaxRecordSize];
+  const char* data = nullptr;
+  size_t size = 0;
+  size_t offset = 0;
+  size_t next = 0;
   int written = 0;
-  for (i = 0; i < count; i++) {
-    written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
-    CHECK(written == -1 || written == static_cast<int>(bufs[i].len));
+  for (i = 0; i < count; i = next) {
+    // Buffers that fit in one record together are encrypted together
+    size = bufs[i].len;
+    for (next = i + 1; next < count; next++) {
+      if (size + bufs[next].len > sizeof(coalesced))
+        break;
+      size += bufs[next].len;
+    }
+
+    data = bufs[i].base;
+    if (next - i > 1) {
+      offset = 0;
+      for (size_t j = i; j < next; j++) {
+        memcpy(coalesced + offset, bufs[j].base, bufs[j].len);
+        offset += bufs[j].len;
+      }
+      data = coalesced;
+    }
+
+    // Large buffers are split where the record size changes
+    for (offset = 0; offset < size; offset += written) {
+      size_t chunk = UpdateRecordSize(size - offset);
+      written = SSL_write(ssl_, data + offset, chunk);
+      CHECK(written == -1 || written == static_cast<int>(chunk));
+      if (written == -1)
+        break;
+    }
     if (written == -1)
       break;
   }
@@ -588,7 +825,8 @@ int TLSWrap::DoWrite(WriteWrap* w,
       return UV_EPROTO;
 
     // No errors, queue rest
-    for (; i < count; i++)
+    clear_in_->Write(data + offset, size - offset);
+    for (i = next; i < count; i++)
       clear_in_->Write(bufs[i].base, bufs[i].len);
   }
 
@@ -599,6 +837,55 @@ int TLSWrap::DoWrite(WriteWrap* w,
 }
 
 
+size_t TLSWrap::UpdateRecordSize(size_t length) {
+  // Never called while the threadpool is encrypting
+  CHECK(!encrypting_);
+
+  if (dynamic_record_size_ && established_) {
+    uint64_t now = uv_now(env()->event_loop());
+    // The congestion window has likely shrunk while the connection was idle
+    if (now - last_write_time_ >= kRecordSizeIdleTimeout)
+      idle_bytes_ = 0;
+    last_write_time_ = now;
+
+    if (idle_bytes_ < kRecordSizeBoostThreshold) {
+      record_size_ = kSmallRecordSize;
+      if (length > kRecordSizeBoostThreshold - idle_bytes_)
+        length = kRecordSizeBoostThreshold - idle_bytes_;
+    } else {
+      record_size_ = kMaxRecordSize;
+    }
+    idle_bytes_ += length;
+  }
+
+#ifdef SSL_set_max_send_fragment
+  if (record_size_ != applied_record_size_) {
+    SSL_set_max_send_fragment(ssl_, record_size_);
+    applied_record_size_ = record_size_;
+  }
+#endif  // SSL_set_max_send_fragment
+
+  return length;
+}
+
+
+#ifdef SSL_set_max_send_fragment
+int TLSWrap::SetSendFragment(int size) {
+  // Same limits as SSL_set_max_send_fragment()
+  if (size < 512 || size > kMaxRecordSize)
+    return 0;
+
+  // An explicit size turns off dynamic record sizing.  It takes effect with
+  // the next write, the threadpool may be using `ssl_` right now.
+  dynamic_record_size_ = false;
+  record_size_ = size;
+  if (!encrypting_)
+    UpdateRecordSize(0);
+  return 1;
+}
+#endif  // SSL_set_max_send_fragment
+
+
 void TLSWrap::OnAfterWriteImpl(WriteWrap* w, void* ctx) {
   // Intentionally empty
 }
@@ -645,6 +932,13 @@ void TLSWrap::DoRead(ssize_t nread,
                      const uv_buf_t* buf,
                      uv_handle_type pending) {
   if (nread < 0)  {
+    // Wait for the threadpool, decrypted data goes first
+    if (encrypting_) {
+      if (read_error_ == 0)
+        read_error_ = nread;
+      return;
+    }
+
     // Error should be emitted only after all data was read
     ClearOut();
 
@@ -680,6 +974,13 @@ void TLSWrap::DoRead(ssize_t nread,
 
 
 int TLSWrap::DoShutdown(ShutdownWrap* req_wrap) {
+  // `close_notify` has to follow the records that are being encrypted
+  if (encrypting_) {
+    CHECK_EQ(shutdown_req_, nullptr);
+    shutdown_req_ = req_wrap;
+    return 0;
+  }
+
   if (SSL_shutdown(ssl_) == 0)
     SSL_shutdown(ssl_);
   shutdown_ = true;
@@ -688,10 +989,28 @@ int TLSWrap::DoShutdown(ShutdownWrap* req_wrap) {
 }
 
 
+// Replaces SSLWrap's renegotiate(): while records are being encrypted on the
+// threadpool the renegotiation is started once the job is done.
+void TLSWrap::Renegotiate(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+
+  if (wrap->encrypting_) {
+    wrap->renegotiate_pending_ = true;
+    return args.GetReturnValue().Set(true);
+  }
+
+  SSLLock lock(wrap);
+  bool yes = SSL_renegotiate(wrap->ssl_) == 1;
+  ERR_clear_error();
+  args.GetReturnValue().Set(yes);
+}
+
+
 void TLSWrap::SetVerifyMode(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  SSLLock lock(wrap);
 
   if (args.Length() < 2 || !args[0]->IsBoolean() || !args[1]->IsBoolean())
     return env->ThrowTypeError("Bad arguments, expected two booleans");
@@ -735,6 +1054,29 @@ void TLSWrap::EnableHelloParser(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TLSWrap::EnableAsyncCrypto(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  if (wrap->async_crypto_)
+    return;
+
+  // Clear text queues are handed to the threadpool, so they can't report
+  // their memory to V8
+  NodeBIO* clear_in = new NodeBIO();
+  MoveClearText(wrap->clear_in_, clear_in);
+  delete wrap->clear_in_;
+  wrap->clear_in_ = clear_in;
+  wrap->crypto_in_ = new NodeBIO();
+  wrap->async_crypto_ = true;
+}
+
+
+void TLSWrap::EnableDynamicRecordSizing(
+    const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  wrap->dynamic_record_size_ = true;
+}
+
+
 void TLSWrap::OnClientHelloParseEnd(void* arg) {
   TLSWrap* c = static_cast<TLSWrap*>(arg);
   c->Cycle();
@@ -746,6 +1088,7 @@ void TLSWrap::GetServername(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  SSLLock lock(wrap);
 
   const char* servername = SSL_get_servername(wrap->ssl_,
                                               TLSEXT_NAMETYPE_host_name);
@@ -761,6 +1104,7 @@ void TLSWrap::SetServername(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  SSLLock lock(wrap);
 
   if (args.Length() < 1 || !args[0]->IsString())
     return env->ThrowTypeError("First argument should be a string");
@@ -791,9 +1135,16 @@ int TLSWrap::SelectSNIContextCallback(SSL* s, int* ad, void* arg) {
   Local<Object> object = p->object();
   Local<Value> ctx = object->Get(env->sni_context_string());
 
-  // Not an object, probably undefined or null
-  if (!ctx->IsObject())
-    return SSL_TLSEXT_ERR_NOACK;
+  // Not picked by JS, probably undefined or null.  Try the names that were
+  // added to the server's context.
+  if (!ctx->IsObject()) {
+    Local<Object> mapped = p->sc_->sni_map_.Lookup(env->isolate(),
+                                                   servername,
+                                                   strlen(servername));
+    if (mapped.IsEmpty())
+      return SSL_TLSEXT_ERR_NOACK;
+    ctx = mapped;
+  }
 
   Local<FunctionTemplate> cons = env->secure_context_constructor_template();
   if (!cons->HasInstance(ctx)) {
@@ -830,9 +1181,14 @@ void TLSWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "setVerifyMode", SetVerifyMode);
   env->SetProtoMethod(t, "enableSessionCallbacks", EnableSessionCallbacks);
   env->SetProtoMethod(t, "enableHelloParser", EnableHelloParser);
+  env->SetProtoMethod(t, "enableAsyncCrypto", EnableAsyncCrypto);
+  env->SetProtoMethod(t,
+                      "enableDynamicRecordSizing",
+                      EnableDynamicRecordSizing);
 
   StreamBase::AddMethods<TLSWrap>(env, t, StreamBase::kFlagHasWritev);
   SSLWrap<TLSWrap>::AddMethods(env, t);
+  env->SetProtoMethod(t, "renegotiate", Renegotiate);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   env->SetProtoMethod(t, "getServername", GetServername);
@@ -49,6 +49,9 @@ class TLSWrap : public crypto::SSLWrap<TLSWrap>,
   void ClearError() override;
 
   void NewSessionDoneCb();
+#ifdef SSL_set_max_send_fragment
+  int SetSendFragment(int size);
+#endif  // SSL_set_max_send_fragment
 
  protected:
   static const int kClearOutChunkSize = 1024;
@@ -59,8 +62,24 @@ class TLSWrap : public crypto::SSLWrap<TLSWrap>,
   // Usual ServerHello + Certificate size
   static const int kInitialClientBufferLength = 4096;
 
-  // Maximum number of buffers passed to uv_write()
-  static const int kSimultaneousBufferCount = 10;
+  // Number of buffers passed to uv_write() without a heap allocation
+  static const int kSimultaneousBufferCount = 16;
+
+  // Minimum amount of queued clear text that is encrypted on the threadpool
+  // once asynchronous crypto is enabled
+  static const size_t kAsyncCryptoThreshold = 16384;
+
+  // Largest TLS record, small buffers are copied together up to this size
+  // so that they share a record
+  static const int kMaxRecordSize = 16384;
+
+  // Dynamic record sizing: records fit in a single TCP segment until
+  // kRecordSizeBoostThreshold bytes were written, and then grow to the
+  // maximum.  Connections start over after being idle for
+  // kRecordSizeIdleTimeout ms.
+  static const int kSmallRecordSize = 1360;
+  static const uint64_t kRecordSizeBoostThreshold = 1024 * 1024;
+  static const uint64_t kRecordSizeIdleTimeout = 1000;
 
   // Write callback queue's item
   class WriteItem {
@@ -84,11 +103,22 @@ class TLSWrap : public crypto::SSLWrap<TLSWrap>,
   void InitSSL();
   void EncOut();
   static void EncOutCb(WriteWrap* req_wrap, int status);
+  void AfterEncOut(int status);
+  // Applies the record size policy to a write of `length` bytes, returns
+  // how many of them to encrypt before asking again
+  size_t UpdateRecordSize(size_t length);
   bool ClearIn();
   void ClearOut();
   void MakePending();
   bool InvokeQueued(int status);
 
+  // Asynchronous encryption of the bulk data, the SSL object is owned by
+  // the threadpool while `encrypting_` is true
+  bool CanEncryptAsync();
+  void EncryptAsync();
+  static void EncryptWork(uv_work_t* req);
+  static void AfterEncrypt(uv_work_t* req, int status);
+
   inline void Cycle() {
     // Prevent recursion
     if (++cycle_depth_ > 1)
@@ -128,10 +158,15 @@ class TLSWrap : public crypto::SSLWrap<TLSWrap>,
   static void Receive(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetVerifyMode(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Renegotiate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableSessionCallbacks(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableHelloParser(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableAsyncCrypto(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableDynamicRecordSizing(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -159,6 +194,25 @@ class TLSWrap : public crypto::SSLWrap<TLSWrap>,
   // after the `UV_EOF` on socket.
   bool eof_;
 
+  bool async_crypto_;
+  bool encrypting_;
+  uv_work_t crypto_req_;
+  // Clear text that is being encrypted on the threadpool
+  NodeBIO* crypto_in_;
+  // Socket events that arrived while `encrypting_` was true
+  bool enc_out_done_;
+  int enc_out_status_;
+  ssize_t read_error_;
+  ShutdownWrap* shutdown_req_;
+  bool renegotiate_pending_;
+
+  bool dynamic_record_size_;
+  // Record size to use for the next write and the one set on `ssl_`
+  int record_size_;
+  int applied_record_size_;
+  uint64_t last_write_time_;
+  uint64_t idle_bytes_;
+
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   v8::Persistent<v8::Value> sni_context_;
 #endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
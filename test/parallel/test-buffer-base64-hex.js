@@ -0,0 +1,92 @@
+var common = require('../common');
+var assert = require('assert');
+
+// Inputs long enough to go through the vectorized encoders and decoders, at
+// every length around their block sizes, checked against a plain JavaScript
+// implementation.
+
+var alphabet =
+    'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+
+function base64(buf) {
+  var out = '';
+  for (var i = 0; i < buf.length; i += 3) {
+    var a = buf[i];
+    var b = i + 1 < buf.length ? buf[i + 1] : 0;
+    var c = i + 2 < buf.length ? buf[i + 2] : 0;
+    out += alphabet[a >> 2];
+    out += alphabet[((a & 3) << 4) | (b >> 4)];
+    out += i + 1 < buf.length ? alphabet[((b & 15) << 2) | (c >> 6)] : '=';
+    out += i + 2 < buf.length ? alphabet[c & 63] : '=';
+  }
+  return out;
+}
+
+function hex(buf) {
+  var out = '';
+  for (var i = 0; i < buf.length; i++)
+    out += (buf[i] < 16 ? '0' : '') + buf[i].toString(16);
+  return out;
+}
+
+var data = new Buffer(200);
+for (var i = 0; i < data.length; i++)
+  data[i] = (i * 131 + 7) & 0xff;
+
+for (var len = 0; len <= data.length; len++) {
+  var buf = data.slice(0, len);
+  var b64 = base64(buf);
+  var hx = hex(buf);
+
+  assert.equal(buf.toString('base64'), b64);
+  assert.equal(buf.toString('hex'), hx);
+
+  assert.deepEqual(new Buffer(b64, 'base64'), buf);
+  assert.deepEqual(new Buffer(hx, 'hex'), buf);
+  assert.deepEqual(new Buffer(hx.toUpperCase(), 'hex'), buf);
+
+  // URL-safe alphabet and unpadded input
+  var url = b64.replace(/\+/g, '-').replace(/\//g, '_').replace(/=+$/, '');
+  assert.deepEqual(new Buffer(url, 'base64'), buf);
+
+  // line breaks every 76 characters, as in MIME
+  var mime = b64.replace(/(.{76})/g, '$1\r\n');
+  assert.deepEqual(new Buffer(mime, 'base64'), buf);
+}
+
+// two-byte strings take the non-vectorized path
+var b64 = base64(data);
+assert.deepEqual(new Buffer(b64 + '†', 'base64'), data);
+
+// hex decoding stops at the first invalid character
+var hx = hex(data);
+var bad = hx.slice(0, 100) + 'zz' + hx.slice(102);
+assert.deepEqual(new Buffer(bad, 'hex'), data.slice(0, 50));
+
+// decoding into a slice of a larger buffer leaves the rest alone
+var target = new Buffer(256);
+target.fill(0xaa);
+assert.equal(target.write(b64.slice(0, 64), 10, 'base64'), 48);
+assert.deepEqual(target.slice(10, 58), data.slice(0, 48));
+for (var i = 0; i < target.length; i++) {
+  if (i < 10 || i >= 58)
+    assert.equal(target[i], 0xaa);
+}
+
+target.fill(0xaa);
+assert.equal(target.write(b64, 10, 40, 'base64'), 40);
+assert.deepEqual(target.slice(10, 50), data.slice(0, 40));
+assert.equal(target[50], 0xaa);
+
+target.fill(0xaa);
+assert.equal(target.write(hx, 3, 45, 'hex'), 45);
+assert.deepEqual(target.slice(3, 48), data.slice(0, 45));
+assert.equal(target[2], 0xaa);
+assert.equal(target[48], 0xaa);
+
+// large enough to be backed by external strings
+var big = new Buffer(2 * 1024 * 1024);
+for (var i = 0; i < big.length; i++)
+  big[i] = (i * 7) & 0xff;
+assert.deepEqual(new Buffer(big.toString('base64'), 'base64'), big);
+assert.deepEqual(new Buffer(big.toString('hex'), 'hex'), big);
@@ -64,6 +64,65 @@ assert.equal(b.indexOf(0x61, -Infinity), 0);
 assert.equal(b.indexOf(0x61, Infinity), -1);
 assert.equal(b.indexOf(0x0), -1);
 
+// test short needles that straddle the 16 byte blocks of the vectorized scan
+var alphabet = new Buffer('abcdefghijklmnopqrstuvwxyz0123456789');
+assert.equal(alphabet.indexOf('pq'), 15);
+assert.equal(alphabet.indexOf('opqr'), 14);
+assert.equal(alphabet.indexOf('0123456789'), 26);
+assert.equal(alphabet.indexOf('789'), 33);
+assert.equal(alphabet.indexOf('89a'), -1);
+assert.equal(alphabet.indexOf(new Buffer('pq')), 15);
+assert.equal(alphabet.indexOf('\r\n'), -1);
+
+// test long needles, searched with Boyer-Moore-Horspool on large haystacks
+var boundary = '--------------------------boundary8f1a3c';
+var body = new Buffer(64 * 1024);
+body.fill('-');
+body.write(boundary, 40000);
+body.write(boundary, 50000);
+assert.equal(body.indexOf(boundary), 40000);
+assert.equal(body.indexOf(boundary, 40001), 50000);
+assert.equal(body.indexOf(boundary, 50001), -1);
+assert.equal(body.indexOf(boundary, -(body.length - 50000)), 50000);
+assert.equal(body.indexOf(new Buffer(boundary)), 40000);
+assert.equal(body.indexOf(boundary + 'x'), -1);
+assert.equal(body.indexOf(body.slice(49990, 50100)), 39990);
+assert.equal(body.indexOf(body), 0);
+assert.equal(body.slice(1).indexOf(body), -1);
+
+// long needle on a small haystack
+var small = new Buffer('xx' + boundary + 'yy');
+assert.equal(small.indexOf(boundary), 2);
+assert.equal(small.indexOf(boundary, 3), -1);
+
+// compare against a naive search over a small alphabet, where partial
+// matches are frequent
+function naiveIndexOf(haystack, needle, offset) {
+  for (var i = offset; i + needle.length <= haystack.length; i++) {
+    for (var j = 0; j < needle.length; j++) {
+      if (haystack[i + j] !== needle[j])
+        break;
+    }
+    if (j === needle.length)
+      return i;
+  }
+  return -1;
+}
+
+var haystack = new Buffer(4096);
+for (var i = 0; i < haystack.length; i++)
+  haystack[i] = 0x61 + (i * 7 + (i >> 5)) % 3;
+
+[1, 2, 3, 5, 15, 16, 17, 31, 64].forEach(function(len) {
+  for (var start = 0; start < haystack.length - len; start += 509) {
+    var needle = haystack.slice(start, start + len);
+    for (var offset = 0; offset < haystack.length; offset += 997) {
+      assert.equal(haystack.indexOf(needle, offset),
+                   naiveIndexOf(haystack, needle, offset));
+    }
+  }
+});
+
 assert.throws(function() {
   b.indexOf(function() { });
 });
@@ -0,0 +1,88 @@
+var common = require('../common');
+var assert = require('assert');
+
+var BufferSearcher = require('buffer').BufferSearcher;
+
+assert.throws(function() {
+  new BufferSearcher('');
+}, RangeError);
+assert.throws(function() {
+  new BufferSearcher({});
+}, TypeError);
+assert.throws(function() {
+  new BufferSearcher('a').search('a');
+}, TypeError);
+
+var crlf = new BufferSearcher('\r\n');
+var b = new Buffer('GET / HTTP/1.1\r\nHost: a\r\n\r\n');
+assert.equal(crlf.search(b), 14);
+assert.equal(crlf.search(b, 15), 23);
+assert.equal(crlf.search(b, -2), 25);
+assert.equal(crlf.search(b, Infinity), -1);
+assert.deepEqual(crlf.searchAll(b), [14, 23, 25]);
+assert.deepEqual(crlf.searchAll(new Buffer('')), []);
+
+assert.equal(BufferSearcher('ab').search(new Buffer('xxab')), 2);
+assert.equal(new BufferSearcher('6162', 'hex').search(new Buffer('xxab')), 2);
+assert.equal(new BufferSearcher(new Buffer([0xff]))
+                 .search(new Buffer([1, 0xff])), 1);
+
+// searchAll() reports non-overlapping matches
+assert.deepEqual(new BufferSearcher('aa').searchAll(new Buffer('aaaaa')),
+                 [0, 2]);
+
+// long needles
+var boundary = '----------------------------4ebf00fbcf09';
+var body = new Buffer(8192);
+body.fill('-');
+body.write(boundary, 1000);
+body.write(boundary, 7000);
+var bs = new BufferSearcher(boundary);
+assert.deepEqual(bs.searchAll(body), [1000, 7000]);
+assert.equal(bs.search(body, 1001), 7000);
+
+// push() finds matches that span chunk boundaries
+var s = new BufferSearcher('--boundary');
+assert.deepEqual(s.push(new Buffer('data--boun')), []);
+assert.deepEqual(s.push(new Buffer('dary more')), [-6]);
+assert.deepEqual(s.push(new Buffer('--boundary--boundary')), [0, 10]);
+assert.deepEqual(s.push(new Buffer('-')), []);
+assert.deepEqual(s.push(new Buffer('-')), []);
+assert.deepEqual(s.push(new Buffer('b')), []);
+assert.deepEqual(s.push(new Buffer('')), []);
+assert.deepEqual(s.push(new Buffer('oundary')), [-3]);
+s.reset();
+assert.deepEqual(s.push(new Buffer('oundary')), []);
+
+// feed a stream byte by byte and in random sized chunks, and compare the
+// result with searchAll() on the whole stream
+function collect(searcher, stream, sizes) {
+  var found = [];
+  var pos = 0;
+  var i = 0;
+  searcher.reset();
+  while (pos < stream.length) {
+    var size = sizes[i++ % sizes.length];
+    var chunk = stream.slice(pos, pos + size);
+    searcher.push(chunk).forEach(function(offset) {
+      found.push(pos + offset);
+    });
+    pos += chunk.length;
+  }
+  return found;
+}
+
+var stream = new Buffer(4096);
+for (var i = 0; i < stream.length; i++)
+  stream[i] = 0x61 + (i * 5 + (i >> 3)) % 2;
+
+['ab', 'aab', 'abba', 'babababa', stream.slice(300, 330).toString()]
+.forEach(function(needle) {
+  var searcher = new BufferSearcher(needle);
+  var expected = searcher.searchAll(stream);
+  assert.ok(expected.length > 0);
+  assert.deepEqual(collect(searcher, stream, [1]), expected);
+  assert.deepEqual(collect(searcher, stream, [3, 7, 1, 64, 2]), expected);
+  assert.deepEqual(collect(searcher, stream, [needle.length - 1]), expected);
+  assert.deepEqual(collect(searcher, stream, [1000]), expected);
+});
@@ -0,0 +1,87 @@
+var common = require('../common');
+var assert = require('assert');
+
+function roundtrip(str) {
+  var buf = new Buffer(str, 'utf8');
+  assert.equal(buf.toString('utf8'), str);
+  assert.equal(buf.toString('utf8').length, str.length);
+}
+
+// ASCII at lengths around the vector block sizes
+var ascii = '';
+for (var i = 0; i < 200; i++) {
+  roundtrip(ascii);
+  ascii += String.fromCharCode(32 + (i * 7) % 95);
+}
+
+// non-ASCII characters at every position of a block
+var chars = ['é', 'ÿ', 'Ā', '€', '�', '😀'];
+chars.forEach(function(ch) {
+  for (var i = 0; i < 70; i++) {
+    roundtrip(ascii.slice(0, i) + ch + ascii.slice(i, 100));
+    roundtrip(ch + ascii.slice(0, i) + ch);
+  }
+});
+
+roundtrip('été à la plage, ça va très bien');
+roundtrip('日本語のテキスト');
+roundtrip('𐀀􏿿');
+
+// malformed input is replaced, not dropped
+assert.equal(new Buffer([0xff]).toString(), '�');
+assert.equal(new Buffer([0x61, 0xc3]).toString(), 'a�');
+assert.equal(new Buffer([0xc3, 0x61]).toString(), '�a');
+
+// overlong forms, five byte sequences and truncated sequences are replaced
+// byte by byte, surrogates are let through, like V8 does it
+assert.equal(new Buffer([0xc0, 0x80]).toString(), '\ufffd\ufffd');
+assert.equal(new Buffer([0xe0, 0x80, 0x80]).toString(),
+             '\ufffd\ufffd\ufffd');
+assert.equal(new Buffer([0xf8, 0x88, 0x80, 0x80]).toString(),
+             '\ufffd\ufffd\ufffd\ufffd');
+assert.equal(new Buffer([0xe2, 0x82, 0x61]).toString(), '\ufffd\ufffda');
+assert.equal(new Buffer([0xed, 0xa0, 0x80]).toString(), '\ud800');
+
+// V8 doesn't replace four byte sequences above U+10FFFF, it masks them, so
+// U+110000 wraps around to U+10000.  This records that current behavior,
+// which the fast path has to match, it isn't a replacement.
+assert.equal(new Buffer([0xf4, 0x90, 0x80, 0x80]).toString(), '\ud800\udc00');
+
+// a sequence cut off by the end of a slice is not completed from the bytes
+// that follow it in memory
+var parent = new Buffer(4096);
+parent.fill(0x80);
+for (var i = 0; i < 64; i++)
+  parent[i * 2] = 0xc3;
+parent[128] = 0xc3;
+parent[4000] = 0xf0;
+assert.equal(parent.slice(3990, 4001).toString(),
+             new Array(11).join('\ufffd') + '\ufffd');
+assert.equal(parent.slice(0, 129).toString(),
+             new Array(65).join('\u00c0') + '\ufffd');
+
+var mixed = new Buffer(ascii + 'é' + ascii);
+mixed[ascii.length + 1] = 0x41;  // break the two byte sequence
+assert.equal(mixed.toString(), ascii + '�A' + ascii);
+
+// slices
+var buf = new Buffer('abc€def');
+assert.equal(buf.toString('utf8', 3, 6), '€');
+assert.equal(buf.toString('utf8', 0, 4), 'abc�');
+
+// large enough for external strings
+var big = new Buffer(2 * 1024 * 1024);
+big.fill('x');
+assert.equal(big.toString(), big.toString('ascii'));
+assert.equal(big.toString().length, big.length);
+
+var latin1 = new Buffer(new Array(400001).join('café '));
+assert.equal(latin1.toString(), new Array(400001).join('café '));
+
+var astral = new Buffer(new Array(300001).join('€😀'));
+assert.equal(astral.toString(), new Array(300001).join('€😀'));
+
+var badBig = new Buffer(new Array(300001).join('€\uffff'));
+for (var i = 0; i < badBig.length; i += 6)
+  badBig[i + 1] = 0x41;
+assert.equal(badBig.toString(), new Array(300001).join('\ufffdA\ufffd\uffff'));
@@ -0,0 +1,198 @@
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+var crypto = require('crypto');
+var constants = require('constants');
+
+var fs = require('fs');
+
+// The callback variants run on the threadpool and must produce the same
+// results as the synchronous ones.
+
+var certPem = fs.readFileSync(common.fixturesDir + '/test_cert.pem', 'ascii');
+var keyPem = fs.readFileSync(common.fixturesDir + '/test_key.pem', 'ascii');
+var rsaPubPem = fs.readFileSync(common.fixturesDir + '/test_rsa_pubkey.pem',
+                                'ascii');
+var rsaKeyPem = fs.readFileSync(common.fixturesDir + '/test_rsa_privkey.pem',
+                                'ascii');
+
+var callbacks = 0;
+function done() {
+  callbacks++;
+}
+
+// Sign and verify
+(function() {
+  var expected = crypto.createSign('RSA-SHA256')
+                       .update('Test123')
+                       .sign(keyPem, 'hex');
+
+  var s = crypto.createSign('RSA-SHA256').update('Test123');
+  var sync = true;
+  assert.strictEqual(s.sign(keyPem, 'hex', function(err, sig) {
+    assert.ifError(err);
+    assert(!sync);
+    assert.equal(sig, expected);
+
+    crypto.createVerify('RSA-SHA256')
+          .update('Test123')
+          .verify(certPem, sig, 'hex', function(err, result) {
+            assert.ifError(err);
+            assert.strictEqual(result, true);
+            done();
+          });
+
+    crypto.createVerify('RSA-SHA256')
+          .update('Test1234')
+          .verify(certPem, sig, 'hex', function(err, result) {
+            assert.ifError(err);
+            assert.strictEqual(result, false);
+            done();
+          });
+  }), undefined);
+  sync = false;
+
+  // The state moved to the threadpool, the object is used up
+  assert.throws(function() {
+    s.sign(keyPem);
+  }, /Not initialised/);
+
+  crypto.createSign('RSA-SHA256')
+        .update('Test123')
+        .sign(keyPem, function(err, sig) {
+          assert.ifError(err);
+          assert(Buffer.isBuffer(sig));
+          assert.equal(sig.toString('hex'), expected);
+          done();
+        });
+
+  crypto.createSign('RSA-SHA256')
+        .update('Test123')
+        .sign('not a key', function(err, sig) {
+          assert(err instanceof Error);
+          assert.equal(sig, null);
+          done();
+        });
+})();
+
+// RSA encryption
+(function() {
+  var input = new Buffer('I AM THE WALRUS');
+  crypto.publicEncrypt(rsaPubPem, input, function(err, encrypted) {
+    assert.ifError(err);
+    assert.notEqual(encrypted.toString('hex'), input.toString('hex'));
+    assert.equal(crypto.privateDecrypt(rsaKeyPem, encrypted).toString(),
+                 input.toString());
+    crypto.privateDecrypt(rsaKeyPem, encrypted, function(err, decrypted) {
+      assert.ifError(err);
+      assert.equal(decrypted.toString(), input.toString());
+      done();
+    });
+  });
+
+  var options = { key: rsaKeyPem, padding: constants.RSA_PKCS1_PADDING };
+  crypto.privateEncrypt(options, input, function(err, encrypted) {
+    assert.ifError(err);
+    crypto.publicDecrypt(rsaPubPem, encrypted, function(err, decrypted) {
+      assert.ifError(err);
+      assert.equal(decrypted.toString(), input.toString());
+      done();
+    });
+  });
+
+  crypto.privateDecrypt(rsaKeyPem, input, function(err, decrypted) {
+    assert(err instanceof Error);
+    assert.equal(decrypted, null);
+    done();
+  });
+})();
+
+// Diffie-Hellman
+(function() {
+  var alice = crypto.getDiffieHellman('modp1');
+  var bob = crypto.getDiffieHellman('modp1');
+  alice.generateKeys('hex', function(err, aliceKey) {
+    assert.ifError(err);
+    assert.equal(aliceKey, alice.getPublicKey('hex'));
+    bob.generateKeys(function(err, bobKey) {
+      assert.ifError(err);
+      assert(Buffer.isBuffer(bobKey));
+      var expected = bob.computeSecret(aliceKey, 'hex', 'hex');
+      alice.computeSecret(bobKey, null, 'hex', function(err, secret) {
+        assert.ifError(err);
+        assert.equal(secret, expected);
+        done();
+      });
+      alice.computeSecret(new Buffer([0]), function(err, secret) {
+        assert(/Supplied key is too small/.test(err.message));
+        assert.equal(secret, null);
+        done();
+      });
+    });
+  });
+})();
+
+// ECDH
+(function() {
+  var alice = crypto.createECDH('prime256v1');
+  var bob = crypto.createECDH('prime256v1');
+  alice.generateKeys();
+  bob.generateKeys();
+  var expected = bob.computeSecret(alice.getPublicKey(), null, 'hex');
+  alice.computeSecret(bob.getPublicKey(), function(err, secret) {
+    assert.ifError(err);
+    assert.equal(secret.toString('hex'), expected);
+    done();
+  });
+})();
+
+// The jobs work on a copy of the key, replacing it while they run must not
+// change their result
+(function() {
+  var prime = crypto.getDiffieHellman('modp1').getPrime();
+  var alice = crypto.createDiffieHellman(prime);
+  var bob = crypto.createDiffieHellman(prime);
+  var eve = crypto.createDiffieHellman(prime);
+  alice.generateKeys();
+  bob.generateKeys();
+  eve.generateKeys();
+  var expected = alice.computeSecret(bob.getPublicKey(), null, 'hex');
+  alice.computeSecret(bob.getPublicKey(), null, 'hex', function(err, secret) {
+    assert.ifError(err);
+    assert.equal(secret, expected);
+    done();
+  });
+  alice.setPrivateKey(eve.getPrivateKey());
+  alice.setPublicKey(eve.getPublicKey());
+
+  bob.generateKeys(function(err, bobKey) {
+    assert.ifError(err);
+    assert.deepEqual(bob.getPublicKey(), bobKey);
+    done();
+  });
+  bob.setPrivateKey(eve.getPrivateKey());
+})();
+
+(function() {
+  var alice = crypto.createECDH('prime256v1');
+  var bob = crypto.createECDH('prime256v1');
+  var eve = crypto.createECDH('prime256v1');
+  alice.generateKeys();
+  bob.generateKeys();
+  eve.generateKeys();
+  var expected = alice.computeSecret(bob.getPublicKey(), null, 'hex');
+  alice.computeSecret(bob.getPublicKey(), null, 'hex', function(err, secret) {
+    assert.ifError(err);
+    assert.equal(secret, expected);
+    done();
+  });
+  alice.setPrivateKey(eve.getPrivateKey());
+})();
+
+process.on('exit', function() {
+  assert.equal(callbacks, 13);
+});
@@ -0,0 +1,158 @@
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+var crypto = require('crypto');
+
+// update(data, output[, offset]) must produce the same bytes as update(data)
+
+var key = new Buffer('0123456789abcdef0123456789abcdef', 'hex');
+var iv = new Buffer('0123456789ab');
+var aad = new Buffer('associated');
+var plaintext = new Buffer('Lorem ipsum dolor sit amet, consectetur ' +
+                           'adipiscing elit, sed do eiusmod tempor.');
+
+// GCM, encrypted and decrypted in place
+(function() {
+  var cipher = crypto.createCipheriv('aes-128-gcm', key, iv);
+  cipher.setAAD(aad);
+  var expected = cipher.update(plaintext);
+  cipher.final();
+  var expectedTag = cipher.getAuthTag();
+
+  var data = new Buffer(plaintext);
+  cipher = crypto.createCipheriv('aes-128-gcm', key, iv);
+  cipher.setAAD(aad);
+  assert.equal(cipher.update(data, data), data.length);
+  assert.equal(cipher.final().length, 0);
+  assert.deepEqual(data, expected);
+  assert.deepEqual(cipher.getAuthTag(), expectedTag);
+
+  var decipher = crypto.createDecipheriv('aes-128-gcm', key, iv);
+  decipher.setAuthTag(expectedTag);
+  decipher.setAAD(aad);
+  assert.equal(decipher.update(data, data), data.length);
+  decipher.final();
+  assert.deepEqual(data, plaintext);
+})();
+
+// CBC over chunks that are not a multiple of the block size, encrypted and
+// decrypted into separate buffers, must match update()/final().  Working
+// in place is refused, the block held back would be written over input
+// that has not been read yet.
+(function() {
+  var cbcIv = new Buffer('0123456789abcdef');
+  var sizes = [5, 17, 1, 30, 9, 3];
+
+  function chunked(input) {
+    var chunks = [];
+    for (var i = 0, start = 0; start < input.length; i++) {
+      var end = Math.min(start + sizes[i % sizes.length], input.length);
+      chunks.push(input.slice(start, end));
+      start = end;
+    }
+    return chunks;
+  }
+
+  function viaUpdate(c, input) {
+    var out = chunked(input).map(function(chunk) {
+      return c.update(chunk);
+    });
+    out.push(c.final());
+    return Buffer.concat(out);
+  }
+
+  function viaUpdateInto(c, input) {
+    var output = new Buffer(input.length + 32);
+    var n = 0;
+    chunked(input).forEach(function(chunk) {
+      n += c.update(chunk, output, n);
+    });
+    return Buffer.concat([output.slice(0, n), c.final()]);
+  }
+
+  var expected = viaUpdate(crypto.createCipheriv('aes-128-cbc', key, cbcIv),
+                           plaintext);
+  var encrypted = viaUpdateInto(
+      crypto.createCipheriv('aes-128-cbc', key, cbcIv), plaintext);
+  assert.deepEqual(encrypted, expected);
+
+  var decrypted = viaUpdateInto(
+      crypto.createDecipheriv('aes-128-cbc', key, cbcIv), encrypted);
+  assert.deepEqual(decrypted, plaintext);
+  assert.deepEqual(
+      viaUpdate(crypto.createDecipheriv('aes-128-cbc', key, cbcIv),
+                encrypted),
+      decrypted);
+
+  var buf = new Buffer(100);
+  buf.fill(0);
+  assert.throws(function() {
+    var cipher = crypto.createCipheriv('aes-128-cbc', key, cbcIv);
+    cipher.update(buf.slice(0, 20), buf);
+  }, /Output overlaps the input/);
+  assert.throws(function() {
+    var decipher = crypto.createDecipheriv('aes-128-cbc', key, cbcIv);
+    decipher.update(buf.slice(0, 32), buf);
+  }, /Output overlaps the input/);
+})();
+
+// CBC holds back a block, the rest is written at the offset
+(function() {
+  var expected = crypto.createCipher('aes192', 'password');
+  expected = Buffer.concat([expected.update(plaintext), expected.final()]);
+
+  var cipher = crypto.createCipher('aes192', 'password');
+  var output = new Buffer(8 + plaintext.length + 16);
+  output.fill(0);
+  var n = cipher.update(plaintext, output, 8);
+  assert.equal(n, plaintext.length - plaintext.length % 16);
+  assert.deepEqual(output.slice(0, 8), new Buffer(8).fill(0));
+  var encrypted = Buffer.concat([output.slice(8, 8 + n), cipher.final()]);
+  assert.deepEqual(encrypted, expected);
+
+  var decipher = crypto.createDecipher('aes192', 'password');
+  output = new Buffer(encrypted.length + 16);
+  n = decipher.update(encrypted, output);
+  var decrypted = Buffer.concat([output.slice(0, n), decipher.final()]);
+  assert.deepEqual(decrypted, plaintext);
+})();
+
+(function() {
+  var cipher = crypto.createCipher('aes192', 'password');
+
+  // Room for the input and a block
+  assert.throws(function() {
+    cipher.update(plaintext, new Buffer(plaintext.length));
+  }, RangeError);
+  assert.throws(function() {
+    cipher.update(plaintext, new Buffer(plaintext.length + 16), 1);
+  }, RangeError);
+
+  assert.throws(function() {
+    cipher.update(plaintext, new Buffer(100), 101);
+  }, RangeError);
+  assert.throws(function() {
+    cipher.update(plaintext, new Buffer(100), -1);
+  }, RangeError);
+  assert.throws(function() {
+    cipher.update(plaintext, new Buffer(100), 1.5);
+  }, RangeError);
+
+  assert.throws(function() {
+    cipher.update('a string', new Buffer(100));
+  }, TypeError);
+
+  var buf = new Buffer(200);
+  assert.throws(function() {
+    cipher.update(buf.slice(0, 64), buf, 8);
+  }, /Output overlaps the input/);
+
+  cipher.final();
+  assert.throws(function() {
+    cipher.update(plaintext, new Buffer(plaintext.length + 16));
+  }, /Trying to add data in unsupported state/);
+})();
@@ -0,0 +1,91 @@
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+var crypto = require('crypto');
+var fs = require('fs');
+var path = require('path');
+
+var fn = path.join(common.fixturesDir, 'sample.png');
+var sampleSha1 = '22723e553129a336ad96e10f6aecdf0f45e4149e';
+
+var callbacks = 0;
+
+// Enough inputs to keep all of the threads busy, in a mix of sizes
+(function() {
+  var inputs = [];
+  for (var i = 0; i < 100; i++) {
+    var buf = new Buffer(i * 997);
+    buf.fill(i);
+    inputs.push(buf);
+  }
+  var fd = fs.openSync(fn, 'r');
+  // Files are read from the start, whatever the position of the fd
+  fs.readSync(fd, new Buffer(100), 0, 100, null);
+  inputs.push(fd);
+
+  var expected = inputs.slice(0, -1).map(function(buf) {
+    return crypto.createHash('sha1').update(buf).digest('hex');
+  });
+  expected.push(sampleSha1);
+
+  crypto.hashMany('sha1', inputs, 'hex', function(err, digests) {
+    assert.ifError(err);
+    assert.deepEqual(digests, expected);
+    fs.closeSync(fd);
+    callbacks++;
+  });
+  // Changing the array afterwards doesn't matter
+  inputs.length = 0;
+})();
+
+(function() {
+  var input = new Buffer('Test123');
+  crypto.hashMany('sha256', [input], function(err, digests) {
+    assert.ifError(err);
+    assert.equal(digests.length, 1);
+    assert(Buffer.isBuffer(digests[0]));
+    assert.equal(digests[0].toString('hex'),
+                 crypto.createHash('sha256').update(input).digest('hex'));
+    callbacks++;
+  });
+})();
+
+crypto.hashMany('sha1', [], function(err, digests) {
+  assert.ifError(err);
+  assert.deepEqual(digests, []);
+  callbacks++;
+});
+
+// A bad file descriptor fails the whole batch
+(function() {
+  var fd = fs.openSync(fn, 'r');
+  fs.closeSync(fd);
+  crypto.hashMany('sha1', [new Buffer('a'), fd], function(err, digests) {
+    assert(err instanceof Error);
+    assert.equal(err.code, 'EBADF');
+    assert.equal(err.syscall, 'read');
+    assert.equal(digests, null);
+    callbacks++;
+  });
+})();
+
+assert.throws(function() {
+  crypto.hashMany('sha1', [new Buffer('a')]);
+}, /No callback provided/);
+assert.throws(function() {
+  crypto.hashMany('sha1', new Buffer('a'), function() {});
+}, TypeError);
+assert.throws(function() {
+  crypto.hashMany('sha1', ['a string'], function() {});
+}, TypeError);
+assert.throws(function() {
+  crypto.hashMany('xyzzy', [new Buffer('a')], function() {});
+}, /Digest method not supported/);
+
+process.on('exit', function() {
+  assert.equal(callbacks, 4);
+});
@@ -84,3 +84,20 @@ fileStream.on('close', function() {
 assert.throws(function() {
   crypto.createHash('xyzzy');
 });
+
+// crypto.hash() is the same as createHash().update().digest()
+['md5', 'sha1', 'sha256', 'sha512'].forEach(function(algo) {
+  ['', 'Test123', new Buffer('Test123'), 'ünïcödé'].forEach(function(data) {
+    var expected = crypto.createHash(algo).update(data).digest('hex');
+    assert.equal(crypto.hash(algo, data, 'hex'), expected);
+    assert.equal(crypto.hash(algo, data).toString('hex'), expected);
+    assert.equal(crypto.hash(algo, data, 'base64'),
+                 new Buffer(expected, 'hex').toString('base64'));
+  });
+});
+assert.throws(function() {
+  crypto.hash('xyzzy', 'Test123');
+}, /Digest method not supported/);
+assert.throws(function() {
+  crypto.hash('sha1', 42);
+}, TypeError);
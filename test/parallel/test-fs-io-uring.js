@@ -0,0 +1,94 @@
+// Set before the first asynchronous fs call, libuv reads it when it sets up
+// the ring.
+process.env.UV_USE_IO_URING = '1';
+
+var common = require('../common');
+var assert = require('assert');
+var path = require('path');
+var fs = require('fs');
+
+// open, read, write, fsync, fdatasync and the stat calls go through io_uring
+// on kernels that support it, and through the threadpool otherwise.  The
+// results must not depend on it.
+
+var file = path.join(common.tmpDir, 'io-uring.txt');
+var missing = path.join(common.tmpDir, 'does-not-exist');
+var data = new Buffer('hello io_uring\n');
+
+try { fs.unlinkSync(file); } catch (e) {}
+
+var done = 0;
+
+function checkStats(stats, expected) {
+  assert(stats instanceof fs.Stats);
+  assert(stats.isFile());
+  ['dev', 'ino', 'mode', 'nlink', 'uid', 'gid', 'rdev', 'size', 'blksize',
+   'blocks'].forEach(function(key) {
+    assert.strictEqual(stats[key], expected[key], key);
+  });
+  assert.strictEqual(stats.mtime.getTime(), expected.mtime.getTime());
+  assert.strictEqual(stats.ctime.getTime(), expected.ctime.getTime());
+  assert.strictEqual(stats.birthtime.getTime(), expected.birthtime.getTime());
+}
+
+fs.open(file, 'w+', function(err, fd) {
+  assert.ifError(err);
+  fs.write(fd, data, 0, data.length, 0, function(err, written) {
+    assert.ifError(err);
+    assert.equal(written, data.length);
+    fs.fsync(fd, function(err) {
+      assert.ifError(err);
+      fs.fdatasync(fd, function(err) {
+        assert.ifError(err);
+        // No position, reads from the current file position
+        var buf = new Buffer(64);
+        fs.read(fd, buf, 0, buf.length, null, function(err, bytesRead) {
+          assert.ifError(err);
+          assert.equal(bytesRead, data.length);
+          assert.equal(buf.toString('utf8', 0, bytesRead), data.toString());
+          stat(fd);
+        });
+      });
+    });
+  });
+});
+
+function stat(fd) {
+  var expected = fs.fstatSync(fd);
+  assert.equal(expected.size, data.length);
+
+  fs.fstat(fd, function(err, stats) {
+    assert.ifError(err);
+    checkStats(stats, expected);
+    fs.stat(file, function(err, stats) {
+      assert.ifError(err);
+      checkStats(stats, expected);
+      fs.lstat(file, function(err, stats) {
+        assert.ifError(err);
+        checkStats(stats, expected);
+        fs.close(fd, function(err) {
+          assert.ifError(err);
+          fs.unlinkSync(file);
+          done++;
+        });
+      });
+    });
+  });
+}
+
+fs.stat(missing, function(err, stats) {
+  assert.equal(err.code, 'ENOENT');
+  assert.equal(err.path, missing);
+  assert.equal(stats, undefined);
+  done++;
+});
+
+fs.open(missing, 'r', function(err, fd) {
+  assert.equal(err.code, 'ENOENT');
+  assert.equal(fd, undefined);
+  done++;
+});
+
+process.on('exit', function() {
+  assert.equal(done, 3);
+});
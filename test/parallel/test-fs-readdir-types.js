@@ -0,0 +1,77 @@
+var common = require('../common');
+var assert = require('assert');
+var path = require('path');
+var fs = require('fs');
+
+var dir = path.join(common.tmpDir, 'readdir-types');
+var entries = {
+  'file': 'file',
+  'dir': 'directory',
+  'link': 'symlink'
+};
+
+function rmrf(dir) {
+  try {
+    fs.readdirSync(dir).forEach(function(name) {
+      var p = path.join(dir, name);
+      if (fs.lstatSync(p).isDirectory())
+        fs.rmdirSync(p);
+      else
+        fs.unlinkSync(p);
+    });
+    fs.rmdirSync(dir);
+  } catch (e) {}
+}
+
+rmrf(dir);
+fs.mkdirSync(dir);
+fs.writeFileSync(path.join(dir, 'file'), 'x');
+fs.mkdirSync(path.join(dir, 'dir'));
+fs.symlinkSync('file', path.join(dir, 'link'));
+
+function check(names, types) {
+  assert.equal(names.length, 3);
+  assert.equal(types.length, 3);
+  names.forEach(function(name, i) {
+    // Not every file system reports types
+    if (types[i] !== 'unknown')
+      assert.equal(types[i], entries[name], name);
+  });
+}
+
+var sync = fs.readdirSync(dir, { types: true });
+check(sync.names, sync.types);
+assert.deepEqual(fs.readdirSync(dir).sort(), Object.keys(entries).sort());
+
+var done = 0;
+
+fs.readdir(dir, { types: true }, function(err, names, types) {
+  assert.ifError(err);
+  check(names, types);
+  assert.deepEqual(names, sync.names);
+  assert.deepEqual(types, sync.types);
+  done++;
+});
+
+// Without the option, there are no types
+fs.readdir(dir, {}, function(err, names, types) {
+  assert.ifError(err);
+  assert.equal(names.length, 3);
+  assert.equal(arguments.length, 2);
+  done++;
+});
+
+fs.readdir(path.join(dir, 'missing'), { types: true }, function(err, names) {
+  assert.equal(err.code, 'ENOENT');
+  assert.equal(names, undefined);
+  done++;
+});
+
+assert.throws(function() {
+  fs.readdirSync(path.join(dir, 'missing'), { types: true });
+}, /ENOENT/);
+
+process.on('exit', function() {
+  assert.equal(done, 3);
+  rmrf(dir);
+});
@@ -0,0 +1,107 @@
+var common = require('../common');
+var assert = require('assert');
+var path = require('path');
+var fs = require('fs');
+
+var link = path.join(common.tmpDir, 'stat-many-link');
+try { fs.unlinkSync(link); } catch (e) {}
+fs.symlinkSync(__filename, link);
+
+var paths = [
+  __filename,
+  common.fixturesDir,
+  path.join(common.fixturesDir, 'does-not-exist'),
+  link,
+  __filename + '\u0000.js'
+];
+
+// Lots of paths are split between several threadpool jobs
+var many = [];
+for (var i = 0; i < 1000; i++)
+  many.push(i % 10 === 0 ? paths[2] : __filename);
+
+function checkEntry(stats, index, expected) {
+  var fields = [
+    'dev', 'mode', 'nlink', 'uid', 'gid', 'rdev', 'blksize', 'ino', 'size',
+    'blocks'
+  ];
+  var offset = index * 14;
+  fields.forEach(function(name, i) {
+    if (process.platform === 'win32' && expected[name] === undefined)
+      assert(isNaN(stats[offset + i]));
+    else
+      assert.strictEqual(stats[offset + i], expected[name], name);
+  });
+  assert.strictEqual(stats[offset + 11], expected.mtime.getTime());
+  assert.strictEqual(stats[offset + 12], expected.ctime.getTime());
+  assert.strictEqual(stats[offset + 13], expected.birthtime.getTime());
+}
+
+var done = 0;
+
+fs.statMany(paths, function(err, stats, errors) {
+  assert.ifError(err);
+  assert(stats instanceof Float64Array);
+  assert.equal(stats.length, paths.length * 14);
+  assert.equal(errors.length, paths.length);
+
+  assert.strictEqual(errors[0], null);
+  checkEntry(stats, 0, fs.statSync(__filename));
+  assert.strictEqual(errors[1], null);
+  checkEntry(stats, 1, fs.statSync(common.fixturesDir));
+  assert.equal(errors[2].code, 'ENOENT');
+  assert.equal(errors[2].syscall, 'stat');
+  assert.equal(errors[2].path, paths[2]);
+  for (var i = 0; i < 14; i++)
+    assert.strictEqual(stats[2 * 14 + i], 0);
+  // Follows the link
+  assert.strictEqual(errors[3], null);
+  checkEntry(stats, 3, fs.statSync(__filename));
+  // Paths with null bytes never match a file
+  assert.equal(errors[4].code, 'ENOENT');
+  done++;
+});
+
+fs.lstatMany(paths, function(err, stats, errors) {
+  assert.ifError(err);
+  assert.strictEqual(errors[0], null);
+  checkEntry(stats, 0, fs.lstatSync(__filename));
+  assert.equal(errors[2].syscall, 'lstat');
+  assert.strictEqual(errors[3], null);
+  checkEntry(stats, 3, fs.lstatSync(link));
+  done++;
+});
+
+fs.statMany(many, function(err, stats, errors) {
+  assert.ifError(err);
+  var expected = fs.statSync(__filename);
+  for (var i = 0; i < many.length; i++) {
+    if (i % 10 === 0) {
+      assert.equal(errors[i].code, 'ENOENT');
+    } else {
+      assert.strictEqual(errors[i], null);
+      assert.strictEqual(stats[i * 14 + 7], expected.ino);
+    }
+  }
+  done++;
+});
+
+fs.statMany([], function(err, stats, errors) {
+  assert.ifError(err);
+  assert.equal(stats.length, 0);
+  assert.deepEqual(errors, []);
+  done++;
+});
+
+assert.throws(function() {
+  fs.statMany('not an array', function() {});
+}, /paths must be an array/);
+
+assert.throws(function() {
+  fs.statMany([__filename, 42], function() {});
+}, /paths must be strings/);
+
+process.on('exit', function() {
+  assert.equal(done, 4);
+  fs.unlinkSync(link);
+});
@@ -0,0 +1,108 @@
+var common = require('../common');
+var assert = require('assert');
+var path = require('path');
+var fs = require('fs');
+
+// The Float64Array forms of the stat functions have to agree with the
+// fs.Stats objects, and fs.Stats.fromValues() has to turn them back into
+// the same thing.
+
+var fields = [
+  'dev', 'mode', 'nlink', 'uid', 'gid', 'rdev', 'blksize', 'ino', 'size',
+  'blocks', 'atime', 'mtime', 'ctime', 'birthtime'
+];
+
+function checkStats(actual, expected) {
+  assert(actual instanceof fs.Stats);
+  fields.forEach(function(name) {
+    if (expected[name] instanceof Date) {
+      assert(actual[name] instanceof Date);
+      assert.strictEqual(actual[name].getTime(), expected[name].getTime());
+    } else {
+      assert.strictEqual(actual[name], expected[name], name);
+    }
+  });
+  assert.strictEqual(actual.isFile(), expected.isFile());
+  assert.strictEqual(actual.isDirectory(), expected.isDirectory());
+}
+
+var values = new Float64Array(14);
+assert.strictEqual(fs.statSync(__filename, values), values);
+checkStats(fs.Stats.fromValues(values), fs.statSync(__filename));
+assert.strictEqual(values[8], fs.statSync(__filename).size);
+
+assert.strictEqual(fs.statSync(common.fixturesDir, values), values);
+checkStats(fs.Stats.fromValues(values), fs.statSync(common.fixturesDir));
+
+var link = path.join(common.tmpDir, 'stat-values-link');
+try { fs.unlinkSync(link); } catch (e) {}
+fs.symlinkSync(__filename, link);
+assert.strictEqual(fs.lstatSync(link, values), values);
+assert(fs.Stats.fromValues(values).isSymbolicLink());
+checkStats(fs.Stats.fromValues(values), fs.lstatSync(link));
+
+var fd = fs.openSync(__filename, 'r');
+assert.strictEqual(fs.fstatSync(fd, values), values);
+checkStats(fs.Stats.fromValues(values), fs.fstatSync(fd));
+
+// Larger arrays are fine, only the first 14 numbers are written
+var big = new Float64Array(28);
+fs.statSync(common.fixturesDir, big);
+checkStats(fs.Stats.fromValues(big, 0), fs.statSync(common.fixturesDir));
+for (var i = 14; i < 28; i++)
+  assert.strictEqual(big[i], 0);
+fs.fstatSync(fd, big.subarray(14));
+checkStats(fs.Stats.fromValues(big, 1), fs.fstatSync(fd));
+fs.closeSync(fd);
+
+// Errors are thrown as usual and leave the array alone
+var before = new Float64Array(values);
+assert.throws(function() {
+  fs.statSync(path.join(common.fixturesDir, 'does-not-exist'), values);
+}, function(err) {
+  return err.code === 'ENOENT';
+});
+assert.deepEqual(values, before);
+
+[null, {}, [], new Buffer(14 * 8), new Float32Array(14),
+ new Float64Array(13)].forEach(function(bad) {
+  assert.throws(function() { fs.statSync(__filename, bad); });
+  assert.throws(function() { fs.lstatSync(__filename, bad); });
+  assert.throws(function() { fs.fstatSync(1, bad); });
+  assert.throws(function() { fs.Stats.fromValues(bad); });
+});
+assert.throws(function() {
+  fs.Stats.fromValues(new Float64Array(14), 1);
+}, RangeError);
+
+// Numbers are read from the array on access, dates are created once.
+// Fields can be overwritten and are enumerable, the backing state is not.
+fs.statSync(__filename, values);
+var stats = fs.Stats.fromValues(values);
+assert.deepEqual(Object.keys(stats), []);
+assert.deepEqual(Object.keys(stats.toJSON()), fields);
+for (var key in stats)
+  assert.strictEqual(key.charAt(0) === '_' && key !== '_checkModeProperty',
+                     false, key);
+var mtime = stats.mtime;
+assert.strictEqual(stats.mtime, mtime);
+values[11] = 0;
+assert.strictEqual(stats.mtime, mtime);
+values[8] = -1;
+assert.strictEqual(stats.size, -1);
+stats.size = 42;
+assert.strictEqual(stats.size, 42);
+values[8] = 0;
+assert.strictEqual(stats.size, 42);
+stats.mtime = null;
+assert.strictEqual(stats.mtime, null);
+assert.deepEqual(Object.keys(JSON.parse(JSON.stringify(stats))).sort(),
+                 fields.slice().sort());
+assert(/mtime:/.test(require('util').inspect(stats)));
+
+// fs.statMany() results work too
+fs.statMany([common.fixturesDir, __filename], function(err, many, errors) {
+  assert.ifError(err);
+  checkStats(fs.Stats.fromValues(many, 0), fs.statSync(common.fixturesDir));
+  checkStats(fs.Stats.fromValues(many, 1), fs.statSync(__filename));
+});
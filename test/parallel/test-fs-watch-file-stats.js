@@ -0,0 +1,50 @@
+var common = require('../common');
+var assert = require('assert');
+var path = require('path');
+var fs = require('fs');
+
+// fs.watchFile() listeners get plain fs.Stats objects with the fields as own
+// enumerable properties, in the same order as fs.statSync() returns them.
+
+var file = path.join(common.tmpDir, 'watch-file-stats.txt');
+try { fs.unlinkSync(file); } catch (e) {}
+fs.writeFileSync(file, 'foo');
+
+var fields = Object.keys(fs.statSync(file));
+assert.deepEqual(fields, [
+  'dev', 'mode', 'nlink', 'uid', 'gid', 'rdev', 'blksize', 'ino', 'size',
+  'blocks', 'atime', 'mtime', 'ctime', 'birthtime'
+]);
+
+function checkShape(stats) {
+  assert(stats instanceof fs.Stats);
+  assert.deepEqual(Object.keys(stats), fields);
+  var copy = require('util')._extend({}, stats);
+  assert.deepEqual(Object.keys(copy).sort(), fields.slice().sort());
+  assert(copy.mtime instanceof Date);
+}
+
+var changes = 0;
+var watcher = fs.watchFile(file, { interval: 20 }, function(curr, prev) {
+  checkShape(curr);
+  checkShape(prev);
+  assert.strictEqual(prev.size, 3);
+  assert.strictEqual(curr.size, 6);
+  assert(curr.isFile());
+  assert.deepEqual(curr, fs.statSync(file));
+  changes++;
+  fs.unwatchFile(file);
+});
+
+// The binding holds on to the array itself, nothing on the handle can
+// drop it
+assert(!('buffer' in watcher._handle));
+
+setTimeout(function() {
+  fs.writeFileSync(file, 'foobar');
+}, 100);
+
+process.on('exit', function() {
+  assert.strictEqual(changes, 1);
+  fs.unlinkSync(file);
+});
@@ -0,0 +1,60 @@
+var common = require('../common');
+var assert = require('assert');
+var binding = process.binding('http_parser');
+var format = binding.formatHeaders;
+
+// No headers.
+assert.deepEqual(format('HTTP/1.1 200 OK\r\n', []),
+                 ['HTTP/1.1 200 OK\r\n', 0]);
+
+// Plain headers.
+assert.deepEqual(format('HTTP/1.1 200 OK\r\n', [
+  'Content-Type', 'text/plain',
+  'X-Foo', 'bar'
+]), ['HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nX-Foo: bar\r\n', 0]);
+
+// Flags, names are matched case-insensitively.
+var result = format('GET / HTTP/1.1\r\n', [
+  'connection', 'Keep-Alive',
+  'TRANSFER-ENCODING', 'Chunked',
+  'Content-Length', '42',
+  'date', 'now',
+  'Expect', '100-continue',
+  'Trailer', 'X-Foo'
+]);
+assert.equal(result[0], 'GET / HTTP/1.1\r\n' +
+                        'connection: Keep-Alive\r\n' +
+                        'TRANSFER-ENCODING: Chunked\r\n' +
+                        'Content-Length: 42\r\n' +
+                        'date: now\r\n' +
+                        'Expect: 100-continue\r\n' +
+                        'Trailer: X-Foo\r\n');
+assert.equal(result[1], binding.kSentConnection |
+                        binding.kConnectionKeepAlive |
+                        binding.kSentTransferEncoding |
+                        binding.kChunked |
+                        binding.kSentContentLength |
+                        binding.kSentDate |
+                        binding.kSentExpect |
+                        binding.kSentTrailer);
+
+assert.equal(format('', ['Connection', 'CLOSE'])[1],
+             binding.kSentConnection | binding.kConnectionClose);
+assert.equal(format('', ['Transfer-Encoding', 'gzip'])[1],
+             binding.kSentTransferEncoding);
+// Only exact names count.
+assert.equal(format('', ['Connections', 'close', 'Date2', 'x'])[1], 0);
+
+// CR and LF and the whitespace that follows them are stripped from values.
+assert.deepEqual(format('', ['X-Foo', 'a\r\n \tb\nc\r', 'X-Bar', '\n\n']),
+                 ['X-Foo: abc\r\nX-Bar: \r\n', 0]);
+
+// Strings that do not fit in one byte per character.
+assert.deepEqual(format('HTTP/1.1 200 é\r\n', ['X-Foo', '€\r\n1']),
+                 ['HTTP/1.1 200 é\r\nX-Foo: €1\r\n', 0]);
+
+// Headers that do not fit in the stack buffer.
+var big = new Array(10000).join('x');
+var bigResult = format('', ['X-Big', big, 'X-Wide', big + '€']);
+assert.equal(bigResult[0],
+             'X-Big: ' + big + '\r\nX-Wide: ' + big + '€\r\n');
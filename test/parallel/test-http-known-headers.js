@@ -0,0 +1,62 @@
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+var HTTPParser = process.binding('http_parser').HTTPParser;
+
+// The parser interns common header names and IncomingMessage looks up their
+// lowercase form instead of calling toLowerCase().  Make sure that neither
+// changes req.headers or req.rawHeaders.
+
+var knownHeaders = HTTPParser.knownHeaders;
+assert.equal(Object.getPrototypeOf(knownHeaders), null);
+Object.keys(knownHeaders).forEach(function(name) {
+  assert.equal(knownHeaders[name], name.toLowerCase());
+  assert.ok(knownHeaders[name.toLowerCase()]);
+});
+assert.equal(knownHeaders['Content-Length'], 'content-length');
+assert.equal(knownHeaders['content-length'], 'content-length');
+assert.equal(knownHeaders['CONTENT-LENGTH'], undefined);
+assert.equal(knownHeaders['constructor'], undefined);
+assert.equal(knownHeaders['__proto__'], undefined);
+
+var rawHeaders = [
+  'Host', 'localhost',
+  'USER-AGENT', 'test',
+  'accept', '*/*',
+  'ETag', '"abc"',
+  'X-Custom', 'one',
+  'Cookie', 'a=1',
+  'cookie', 'b=2',
+  'Content-Type', 'text/plain',
+  'content-type', 'text/html',
+  'Content-Length', '0',
+  'Connection', 'close'
+];
+
+var server = http.createServer(function(req, res) {
+  assert.deepEqual(req.rawHeaders, rawHeaders);
+  assert.deepEqual(req.headers, {
+    'host': 'localhost',
+    'user-agent': 'test',
+    'accept': '*/*',
+    'etag': '"abc"',
+    'x-custom': 'one',
+    'cookie': 'a=1, b=2',
+    'content-type': 'text/plain',
+    'content-length': '0',
+    'connection': 'close'
+  });
+  res.end();
+  server.close();
+});
+
+server.listen(common.PORT, function() {
+  var request = 'GET / HTTP/1.1\r\n';
+  for (var i = 0; i < rawHeaders.length; i += 2)
+    request += rawHeaders[i] + ': ' + rawHeaders[i + 1] + '\r\n';
+  var client = net.connect(common.PORT, function() {
+    client.end(request + '\r\n');
+  });
+  client.resume();
+});
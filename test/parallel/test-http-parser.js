@@ -13,6 +13,7 @@ var kOnHeaders = HTTPParser.kOnHeaders | 0;
 var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
 var kOnBody = HTTPParser.kOnBody | 0;
 var kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+var kOnMessages = HTTPParser.kOnMessages | 0;
 
 // The purpose of this test is not to check HTTP compliance but to test the
 // binding. Tests for pathological http messages should be submitted
@@ -510,6 +511,39 @@ function expectBody(expected) {
 })();
 
 
+//
+// Test many headers, split over several buffers.  All of them are passed to
+// onHeadersComplete at once, also for the messages that follow.
+//
+(function() {
+  var expected = [];
+  var request = 'GET /many HTTP/1.1' + CRLF;
+  for (var i = 0; i < 100; i++) {
+    expected.push('X-Header-' + i, 'value ' + i);
+    request += 'X-Header-' + i + ': value ' + i + CRLF;
+  }
+  request = Buffer(request + CRLF);
+
+  var onHeadersComplete = function(versionMajor, versionMinor, headers, method,
+                                   url, statusCode, statusMessage, upgrade,
+                                   shouldKeepAlive) {
+    assert.equal(url, '/many');
+    assert.deepEqual(headers, expected);
+  };
+
+  var parser = newParser(REQUEST);
+  parser[kOnHeaders] = function() {
+    assert.ok(false, 'Function should not be called.');
+  };
+  parser[kOnHeadersComplete] = mustCall(onHeadersComplete, 3);
+
+  for (var n = 0; n < 3; n++) {
+    for (var i = 0; i < request.length; i += 97)
+      parser.execute(request.slice(i, i + 97));
+  }
+})();
+
+
 //
 // Test parser reinit sequence.
 //
@@ -564,6 +598,89 @@ function expectBody(expected) {
   parser.execute(req2, 0, req2.length);
 })();
 
+//
+// Test pipelined requests in batch mode: one onMessages call per execute()
+// with the events of every message in the buffer.
+//
+(function() {
+  var request = Buffer(
+      'GET /one HTTP/1.1' + CRLF +
+      'Host: example.com' + CRLF +
+      CRLF +
+      'POST /two HTTP/1.1' + CRLF +
+      'Content-Length: 4' + CRLF +
+      CRLF +
+      'ping' +
+      'PUT /three HTTP/1.1' + CRLF +
+      'Transfer-Encoding: chunked' + CRLF +
+      CRLF +
+      '4' + CRLF +
+      'pong' + CRLF +
+      '0' + CRLF +
+      'X-Trailer: yes' + CRLF +
+      CRLF +
+      'GET /four HTTP/1.1' + CRLF +
+      'Content-Length: 8' + CRLF +
+      CRLF +
+      'part');
+
+  var calls = [];
+  var parser = newParser(REQUEST);
+  parser[kOnHeadersComplete] = function() {
+    assert.ok(false, 'Function should not be called.');
+  };
+  parser[kOnMessageComplete] = parser[kOnHeadersComplete];
+  parser[kOnMessages] = function(events, b) {
+    var records = [];
+    for (var i = 0; i < events.length;) {
+      switch (events[i]) {
+        case kOnHeadersComplete:
+          assert.equal(events[i + 1], 1);
+          assert.equal(events[i + 2], 1);
+          records.push([methods[events[i + 4]], events[i + 5], events[i + 3]]);
+          i += 10;
+          break;
+        case kOnBody:
+          records.push('' + b.slice(events[i + 1],
+                                    events[i + 1] + events[i + 2]));
+          i += 3;
+          break;
+        case kOnMessageComplete:
+          records.push(['complete', events[i + 1]]);
+          i += 2;
+          break;
+        default:
+          assert.ok(false, 'Unexpected event ' + events[i]);
+      }
+    }
+    calls.push(records);
+  };
+
+  var rest = Buffer('data');
+  parser.execute(request, 0, request.length);
+  parser.execute(rest, 0, rest.length);
+
+  assert.deepEqual(calls, [
+    [
+      ['GET', '/one', ['Host', 'example.com']],
+      ['complete', undefined],
+      ['POST', '/two', ['Content-Length', '4']],
+      'ping',
+      ['complete', undefined],
+      ['PUT', '/three', ['Transfer-Encoding', 'chunked']],
+      'pong',
+      ['complete', ['X-Trailer', 'yes']],
+      ['GET', '/four', ['Content-Length', '8']],
+      'part'
+    ],
+    [
+      'data',
+      ['complete', undefined]
+    ]
+  ]);
+})();
+
+
 // Test parser 'this' safety
 // https://github.com/joyent/node/issues/6690
 assert.throws(function() {
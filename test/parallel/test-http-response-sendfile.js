@@ -0,0 +1,96 @@
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var http = require('http');
+var net = require('net');
+var path = require('path');
+
+var content = '';
+for (var i = 0; i < 100000; i++)
+  content += String.fromCharCode(97 + i % 26);
+
+var file = path.join(common.tmpDir, 'response-sendfile.txt');
+fs.writeFileSync(file, content);
+var fd = fs.openSync(file, 'r');
+
+var finished = 0;
+
+var server = http.createServer(function(req, res) {
+  var done = function() { finished++; };
+  if (req.url === '/length') {
+    res.sendFile(fd, 5, 1000, done);
+  } else if (req.url === '/chunked') {
+    res.writeHead(200);
+    res.write('abc');
+    res.sendFile(fd, 0, 500, done);
+  } else if (req.url === '/empty') {
+    res.sendFile(fd, 0, 0, done);
+  }
+});
+
+var tests = [
+  { method: 'GET', path: '/length', body: content.slice(5, 1005),
+    headers: { 'content-length': '1000' } },
+  { method: 'GET', path: '/chunked', body: 'abc' + content.slice(0, 500),
+    headers: { 'transfer-encoding': 'chunked' } },
+  { method: 'GET', path: '/empty', body: '',
+    headers: { 'content-length': '0' } },
+  { method: 'HEAD', path: '/length', body: '',
+    headers: { 'content-length': '1000' } }
+];
+
+server.listen(common.PORT, function() {
+  (function next() {
+    var test = tests.shift();
+    if (!test)
+      return pipelined();
+
+    http.request({
+      port: common.PORT,
+      method: test.method,
+      path: test.path
+    }, function(res) {
+      var body = '';
+      res.setEncoding('binary');
+      res.on('data', function(data) {
+        body += data;
+      });
+      res.on('end', function() {
+        assert.equal(body, test.body);
+        for (var name in test.headers)
+          assert.equal(res.headers[name], test.headers[name]);
+        next();
+      });
+    }).end();
+  })();
+});
+
+// The second response waits in the outgoing queue until the first one is
+// done, the file range has to come out after it.
+function pipelined() {
+  var client = net.connect(common.PORT, function() {
+    client.write('GET /chunked HTTP/1.1\r\nHost: localhost\r\n\r\n' +
+               'GET /length HTTP/1.1\r\nHost: localhost\r\n' +
+               'Connection: close\r\n\r\n');
+  });
+  var response = '';
+  client.setEncoding('binary');
+  client.on('data', function(data) {
+    response += data;
+  });
+  client.on('end', function() {
+    var first = response.indexOf('\r\n3\r\nabc\r\n1f4\r\n' +
+                                 content.slice(0, 500) + '\r\n0\r\n\r\n');
+    var second = response.indexOf('\r\n\r\n' + content.slice(5, 1005));
+    assert.notEqual(first, -1);
+    assert(second > first);
+    assert.equal(response.length, second + 4 + 1000);
+    server.close();
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(finished, 6);
+  fs.closeSync(fd);
+  fs.unlinkSync(file);
+});
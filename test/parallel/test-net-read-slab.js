@@ -0,0 +1,97 @@
+var common = require('../common');
+var assert = require('assert');
+var child_process = require('child_process');
+var dgram = require('dgram');
+var net = require('net');
+
+// Socket reads are sliced from shared slabs.  Keep every chunk around while
+// more data arrives and check that none of them is overwritten by a later
+// read, with the default slab size, slabs that only fit a few reads, and
+// with slab allocation turned off.
+
+if (process.argv[2] !== 'child') {
+  var flags = ['--read-slab-size=0', '--read-slab-size=200000', null];
+  (function next() {
+    if (flags.length === 0)
+      return;
+    var flag = flags.shift();
+    var args = (flag ? [flag] : []).concat(__filename, 'child');
+    var child = child_process.spawn(process.execPath, args,
+                                    { stdio: 'inherit' });
+    child.on('exit', function(code, signal) {
+      assert.equal(code, 0, flag);
+      next();
+    });
+  })();
+  return;
+}
+
+var TOTAL = 4 * 1024 * 1024;
+var expected = new Buffer(TOTAL);
+for (var i = 0; i < TOTAL; i++)
+  expected[i] = (i * 7 + (i >> 12)) & 0xff;
+
+var chunks = [];
+var server = net.createServer(function(socket) {
+  socket.on('data', function(data) {
+    chunks.push(data);
+  });
+  socket.on('end', function() {
+    server.close();
+    assert.deepEqual(Buffer.concat(chunks), expected);
+    testDgram();
+  });
+});
+
+server.listen(common.PORT, function() {
+  var client = net.connect(common.PORT, function() {
+    // Mix of small and large writes so reads come in all sizes.
+    var offset = 0;
+    var size = 1;
+    while (offset < TOTAL) {
+      var end = Math.min(offset + size, TOTAL);
+      client.write(expected.slice(offset, end));
+      offset = end;
+      size = size * 3 % 100003;
+    }
+    client.end();
+  });
+});
+
+function testDgram() {
+  var COUNT = 100;
+  var messages = [];
+  var received = [];
+  for (var i = 0; i < COUNT; i++) {
+    var msg = new Buffer(1 + i * 97 % 1400);
+    msg.fill(i);
+    messages.push(msg);
+  }
+
+  var receiver = dgram.createSocket('udp4');
+  var sender = dgram.createSocket('udp4');
+
+  // One datagram in flight at a time, so none of them is dropped because the
+  // receive buffer is full.
+  function send() {
+    var msg = messages[received.length];
+    sender.send(msg, 0, msg.length, common.PORT, '127.0.0.1');
+  }
+
+  receiver.on('message', function(msg) {
+    received.push(msg);
+    if (received.length < COUNT)
+      return send();
+    receiver.close();
+    sender.close();
+    received.forEach(function(msg, i) {
+      assert.deepEqual(msg, messages[i]);
+    });
+  });
+
+  receiver.bind(common.PORT, '127.0.0.1', send);
+
+  process.on('exit', function() {
+    assert.equal(received.length, COUNT);
+  });
+}
@@ -0,0 +1,75 @@
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+
+// Destroying a socket that waits for the peer to read cancels the transfer.
+// Nothing may be left behind that keeps the process alive.  Pipes don't use
+// sendfile(2) but still get the whole range.
+
+var SIZE = 16 * 1024 * 1024;
+var file = path.join(common.tmpDir, 'sendfile-destroy.bin');
+var content = new Buffer(SIZE);
+for (var i = 0; i < SIZE; i++)
+  content[i] = i & 0xff;
+fs.writeFileSync(file, content);
+var fd = fs.openSync(file, 'r');
+
+var closed = 0;
+var pipeDone = 0;
+
+var server = net.createServer(function(socket) {
+  assert.equal(typeof socket._handle.sendFile, 'function');
+  socket.sendFile(fd, 0, SIZE, function() {
+    assert(false, 'transfer was not canceled');
+  });
+  socket.on('close', function() {
+    closed++;
+    server.close();
+    testPipe();
+  });
+  // The client never reads, give the transfer time to fill the socket.
+  setTimeout(function() {
+    socket.destroy();
+  }, 100);
+});
+
+server.listen(common.PORT, function() {
+  var client = net.connect(common.PORT);
+  client.pause();
+  client.on('error', function() {});
+  client.on('close', function() {
+    client.destroy();
+  });
+  server.on('close', function() {
+    client.destroy();
+  });
+});
+
+function testPipe() {
+  var pipeServer = net.createServer(function(socket) {
+    assert.equal(socket._handle.sendFile, undefined);
+    socket.sendFile(fd, 10, 1000);
+    socket.end();
+  });
+  pipeServer.listen(common.PIPE, function() {
+    var chunks = [];
+    var client = net.connect(common.PIPE);
+    client.on('data', function(data) {
+      chunks.push(data);
+    });
+    client.on('end', function() {
+      assert.deepEqual(Buffer.concat(chunks), content.slice(10, 1010));
+      pipeDone++;
+      pipeServer.close();
+    });
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(closed, 1);
+  assert.equal(pipeDone, 1);
+  fs.closeSync(fd);
+  fs.unlinkSync(file);
+});
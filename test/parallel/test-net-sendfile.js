@@ -0,0 +1,91 @@
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+
+// Large enough to fill the socket buffers so the transfer has to wait for
+// the socket to become writable again.
+var SIZE = 4 * 1024 * 1024;
+var content = new Buffer(SIZE);
+for (var i = 0; i < SIZE; i++)
+  content[i] = (i * 31 + (i >> 10)) & 0xff;
+
+var file = path.join(common.tmpDir, 'sendfile.bin');
+fs.writeFileSync(file, content);
+var fd = fs.openSync(file, 'r');
+
+var expected = Buffer.concat([
+  new Buffer('head'),
+  content.slice(100, SIZE - 100),
+  new Buffer('middle'),
+  content.slice(0, 10),
+  new Buffer('tail')
+]);
+
+var sendFileCallbacks = 0;
+var eofErrors = 0;
+
+assert.throws(function() {
+  new net.Socket().sendFile(-1, 0, 10);
+}, TypeError);
+assert.throws(function() {
+  new net.Socket().sendFile(fd, -1, 10);
+}, TypeError);
+assert.throws(function() {
+  new net.Socket().sendFile(fd, 0, 1.5);
+}, TypeError);
+
+var server = net.createServer(function(socket) {
+  socket.write('head');
+  socket.sendFile(fd, 100, SIZE - 200, function(err) {
+    assert.ifError(err);
+    sendFileCallbacks++;
+  });
+  socket.write('middle');
+  socket.sendFile(fd, 0, 0);
+  socket.sendFile(fd, 0, 10);
+  socket.end('tail');
+});
+
+server.listen(common.PORT, function() {
+  var chunks = [];
+  var client = net.connect(common.PORT);
+  // Don't read for a while so the server runs into a full socket.
+  client.pause();
+  setTimeout(function() {
+    client.resume();
+  }, 100);
+  client.on('data', function(data) {
+    chunks.push(data);
+  });
+  client.on('end', function() {
+    assert.deepEqual(Buffer.concat(chunks), expected);
+    testEOF();
+  });
+});
+
+// A range past the end of the file destroys the socket.
+function testEOF() {
+  server.close();
+  server = net.createServer(function(socket) {
+    socket.on('error', function(err) {
+      assert.equal(err.code, 'EOF');
+      eofErrors++;
+      server.close();
+    });
+    socket.sendFile(fd, SIZE - 10, 20);
+  });
+  server.listen(common.PORT, function() {
+    var client = net.connect(common.PORT);
+    client.on('error', function() {});
+    client.resume();
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(sendFileCallbacks, 1);
+  assert.equal(eofErrors, 1);
+  fs.closeSync(fd);
+  fs.unlinkSync(file);
+});
@@ -0,0 +1,57 @@
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+
+var classes = ['fs', 'cpu', 'dns', 'user'];
+
+var stats = process.getThreadpoolStats();
+assert.deepEqual(Object.keys(stats), classes);
+classes.forEach(function(name) {
+  assert.equal(stats[name].concurrency, 0);
+  assert.equal(stats[name].priority, 0);
+  assert.equal(typeof stats[name].queued, 'number');
+  assert.equal(typeof stats[name].running, 'number');
+  assert.equal(typeof stats[name].waitTime, 'number');
+  assert(stats[name].maxWaitTime <= stats[name].waitTime);
+});
+
+process.setThreadpoolClass('fs', { concurrency: 1 });
+process.setThreadpoolClass('dns', { priority: 2 });
+process.setThreadpoolClass('dns', { priority: -1 });
+stats = process.getThreadpoolStats();
+assert.equal(stats.fs.concurrency, 1);
+assert.equal(stats.fs.priority, 0);
+assert.equal(stats.dns.concurrency, 0);
+assert.equal(stats.dns.priority, -1);
+
+// fs requests still all complete when they run one at a time
+var before = stats.fs.completed;
+var pending = 10;
+for (var i = 0; i < 10; i++) {
+  fs.stat(__filename, function(err) {
+    assert.ifError(err);
+    if (--pending === 0) {
+      var after = process.getThreadpoolStats().fs;
+      assert.equal(after.completed - before, 10);
+      assert.equal(after.queued, 0);
+      assert.equal(after.running, 0);
+    }
+  });
+}
+
+assert.throws(function() {
+  process.setThreadpoolClass('io', { concurrency: 1 });
+}, /Unknown threadpool class: io/);
+assert.throws(function() {
+  process.setThreadpoolClass('fs');
+}, TypeError);
+assert.throws(function() {
+  process.setThreadpoolClass('fs', { concurrency: -1 });
+}, TypeError);
+assert.throws(function() {
+  process.setThreadpoolClass('fs', { priority: 0.5 });
+}, TypeError);
+
+process.on('exit', function() {
+  assert.equal(pending, 0);
+});
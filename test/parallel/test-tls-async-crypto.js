@@ -0,0 +1,112 @@
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+var tls = require('tls');
+var crypto = require('crypto');
+
+var fs = require('fs');
+var path = require('path');
+
+var options = {
+  key: fs.readFileSync(path.join(common.fixturesDir, 'test_key.pem')),
+  cert: fs.readFileSync(path.join(common.fixturesDir, 'test_cert.pem')),
+  asyncCrypto: true
+};
+
+// Mix writes that are encrypted on the loop with ones that go to the
+// threadpool, the peer must see them in order.
+var sizes = [1, 100 * 1024, 10, 16 * 1024, 16 * 1024 - 1, 1024 * 1024, 3];
+var sent = crypto.createHash('sha1');
+var received = crypto.createHash('sha1');
+var total = 0;
+var receivedBytes = 0;
+var callbacks = 0;
+var serverEnded = false;
+var renegotiated = false;
+
+var server = tls.Server(options, function(socket) {
+  socket.pipe(socket);
+  socket.on('end', function() {
+    serverEnded = true;
+  });
+});
+
+server.listen(common.PORT, function() {
+  var client = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false,
+    asyncCrypto: true
+  }, function() {
+    sizes.forEach(function(size, i) {
+      var chunk = new Buffer(size);
+      chunk.fill(i);
+      sent.update(chunk);
+      total += size;
+      client.write(chunk, function(err) {
+        assert.ifError(err);
+        assert.equal(callbacks++, i);
+      });
+    });
+    // Strings are queued together with buffers
+    var str = new Array(64 * 1024 + 1).join('é');
+    sent.update(str, 'utf8');
+    total += Buffer.byteLength(str);
+    client.write(str);
+  });
+
+  client.on('data', function(chunk) {
+    received.update(chunk);
+    receivedBytes += chunk.length;
+    if (receivedBytes === total)
+      client.end();
+  });
+
+  client.on('end', function() {
+    server.close();
+    testRenegotiate();
+  });
+});
+
+// The SSL object is in use by the threadpool right after a large write.  The
+// accessors wait for it, a renegotiation starts when the job is done.
+function testRenegotiate() {
+  var SIZE = 4 * 1024 * 1024;
+  var server = tls.Server(options, function(socket) {
+    socket.write(new Buffer(SIZE));
+    var cipher = socket.getCipher();
+    assert(Buffer.isBuffer(socket.getSession()));
+    assert.equal(socket.renegotiate({}, function(err) {
+      assert.ifError(err);
+      assert.deepEqual(socket.getCipher(), cipher);
+      renegotiated = true;
+      socket.end();
+    }), true);
+  });
+
+  server.listen(common.PORT, function() {
+    var bytes = 0;
+    var client = tls.connect({
+      port: common.PORT,
+      rejectUnauthorized: false
+    });
+    client.on('data', function(chunk) {
+      bytes += chunk.length;
+    });
+    client.on('end', function() {
+      assert.equal(bytes, SIZE);
+      server.close();
+    });
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(callbacks, sizes.length);
+  assert.equal(receivedBytes, total);
+  assert.equal(received.digest('hex'), sent.digest('hex'));
+  assert(serverEnded);
+  assert(renegotiated);
+});
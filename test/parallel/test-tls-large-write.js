@@ -0,0 +1,52 @@
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+var tls = require('tls');
+var fs = require('fs');
+var crypto = require('crypto');
+
+// A single large write is encrypted into far more BIO chunks than what fits
+// into one uv_write() on the stack.  All of them have to arrive, in order,
+// also when the chunks are reused by the next connections.
+
+var payload = crypto.pseudoRandomBytes(4 * 1024 * 1024 + 17);
+var expected = crypto.createHash('sha1').update(payload).digest('hex');
+var connections = 3;
+
+var server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+}, function(c) {
+  c.end(payload);
+});
+
+var done = 0;
+function connect() {
+  var hash = crypto.createHash('sha1');
+  var received = 0;
+  var c = tls.connect(common.PORT, {
+    rejectUnauthorized: false
+  });
+  c.on('data', function(chunk) {
+    received += chunk.length;
+    hash.update(chunk);
+  });
+  c.on('end', function() {
+    assert.equal(received, payload.length);
+    assert.equal(hash.digest('hex'), expected);
+    if (++done === connections)
+      server.close();
+    else
+      connect();
+  });
+}
+
+server.listen(common.PORT, connect);
+
+process.on('exit', function() {
+  assert.equal(done, connections);
+});
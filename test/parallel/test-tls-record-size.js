@@ -0,0 +1,88 @@
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+var tls = require('tls');
+var net = require('net');
+var fs = require('fs');
+
+// A proxy between the client and the server records the length of every
+// application data record that the server sends.
+
+var bulk = new Buffer(2 * 1024 * 1024);
+bulk.fill('x');
+var smallWrites = 100;
+
+var server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  dynamicRecordSizing: true
+}, function(c) {
+  // Writes that are flushed together are encrypted together
+  c.cork();
+  for (var i = 0; i < smallWrites; i++)
+    c.write('0123456789');
+  c.uncork();
+  c.end(bulk);
+});
+
+var records = [];
+var proxy = net.createServer(function(conn) {
+  var upstream = net.connect(common.PORT, function() {
+    conn.pipe(upstream);
+  });
+
+  var pending = new Buffer(0);
+  upstream.on('data', function(data) {
+    conn.write(data);
+    pending = Buffer.concat([pending, data]);
+    while (pending.length >= 5) {
+      var length = pending.readUInt16BE(3);
+      if (pending.length < 5 + length)
+        break;
+      // Application data
+      if (pending[0] === 23)
+        records.push(length);
+      pending = pending.slice(5 + length);
+    }
+  });
+  upstream.on('end', function() {
+    conn.end();
+  });
+});
+
+var received = 0;
+server.listen(common.PORT, function() {
+  proxy.listen(common.PORT + 1, function() {
+    var c = tls.connect(common.PORT + 1, {
+      rejectUnauthorized: false
+    }, function() {
+      c.on('data', function(chunk) {
+        received += chunk.length;
+      });
+      c.on('end', function() {
+        server.close();
+        proxy.close();
+      });
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(received, smallWrites * 10 + bulk.length);
+
+  // The small writes share a record.  It has some overhead, but it is
+  // definitely smaller than two of them.
+  assert(records[0] >= smallWrites * 10);
+  assert(records[0] < smallWrites * 10 * 2);
+
+  // Records are small at the start of the bulk transfer and get to the
+  // maximum size later on.
+  assert(records[1] < 2048);
+  var max = Math.max.apply(Math, records);
+  assert(max > 16000);
+  assert(records.indexOf(max) > 1);
+});
@@ -0,0 +1,59 @@
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+var tls = require('tls');
+
+var fs = require('fs');
+var path = require('path');
+
+// TLS sockets can't use sendfile(2), the range is read and written instead.
+
+var content = new Buffer(300000);
+for (var i = 0; i < content.length; i++)
+  content[i] = (i * 7) & 0xff;
+
+var file = path.join(common.tmpDir, 'tls-sendfile.bin');
+fs.writeFileSync(file, content);
+var fd = fs.openSync(file, 'r');
+
+var options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+
+var received = null;
+
+var server = tls.createServer(options, function(socket) {
+  socket.write('<');
+  socket.sendFile(fd, 1, content.length - 1);
+  socket.end('>');
+});
+
+server.listen(common.PORT, function() {
+  var chunks = [];
+  var client = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false
+  });
+  client.on('data', function(data) {
+    chunks.push(data);
+  });
+  client.on('end', function() {
+    received = Buffer.concat(chunks);
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.deepEqual(received, Buffer.concat([
+    new Buffer('<'),
+    content.slice(1),
+    new Buffer('>')
+  ]));
+  fs.closeSync(fd);
+  fs.unlinkSync(file);
+});
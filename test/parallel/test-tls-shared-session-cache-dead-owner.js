@@ -0,0 +1,79 @@
+// A process that dies while it holds the lock of a set in the shared session
+// cache must not block the other processes that map the file.
+
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+if (process.platform === 'win32') {
+  console.log('1..0 # Skipped: shared session cache is not supported');
+  process.exit();
+}
+var tls = require('tls');
+var constants = require('constants');
+var spawn = require('child_process').spawn;
+
+var fs = require('fs');
+var path = require('path');
+
+var cacheFile = path.join(common.tmpDir, 'tls-session-cache-dead-owner');
+
+// A header and a single set of 8 entries, see node_crypto_session_cache.cc
+var HEADER_SIZE = 64;
+var SET_SIZE = 16 + 8 * 2048;
+
+var child = spawn(process.execPath, ['-e', '']);
+child.on('exit', function(code) {
+  assert.equal(code, 0);
+
+  // Stamp the file and leave the set locked by the dead child
+  var data = new Buffer(HEADER_SIZE + SET_SIZE);
+  data.fill(0);
+  data.writeUInt32LE(0x4e534331, 0);
+  data.writeUInt32LE(child.pid, HEADER_SIZE);
+  fs.writeFileSync(cacheFile, data);
+
+  var server = tls.Server({
+    key: fs.readFileSync(common.fixturesDir + '/keys/agent2-key.pem'),
+    cert: fs.readFileSync(common.fixturesDir + '/keys/agent2-cert.pem'),
+    secureOptions: constants.SSL_OP_NO_TICKET,
+    sharedSessionCache: cacheFile
+  }, function(socket) {
+    socket.end('Goodbye');
+  });
+
+  server.listen(common.PORT, function() {
+    connect(null, function(reused, session) {
+      assert.ok(!reused);
+      connect(session, function(reused) {
+        assert.ok(reused);
+        resumed = true;
+        server.close();
+      });
+    });
+  });
+});
+
+function connect(session, cb) {
+  var client = tls.connect({
+    port: common.PORT,
+    rejectUnauthorized: false,
+    session: session
+  }, function() {
+    var reused = client.isSessionReused();
+    var session = client.getSession();
+    client.on('close', function() {
+      cb(reused, session);
+    });
+  });
+  client.resume();
+}
+
+var resumed = false;
+process.on('exit', function() {
+  assert.ok(resumed);
+  fs.unlinkSync(cacheFile);
+});
@@ -0,0 +1,88 @@
+// Sessions created by one server can be resumed by another server that maps
+// the same session cache file, e.g. one in a different cluster worker.
+
+var common = require('../common');
+var assert = require('assert');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+if (process.platform === 'win32') {
+  console.log('1..0 # Skipped: shared session cache is not supported');
+  process.exit();
+}
+var tls = require('tls');
+var constants = require('constants');
+
+var fs = require('fs');
+var path = require('path');
+
+var cacheFile = path.join(common.tmpDir, 'tls-session-cache');
+try {
+  fs.unlinkSync(cacheFile);
+} catch (e) {
+}
+
+function createServer(sharedSessionCache) {
+  return tls.Server({
+    key: fs.readFileSync(common.fixturesDir + '/keys/agent2-key.pem'),
+    cert: fs.readFileSync(common.fixturesDir + '/keys/agent2-cert.pem'),
+    // Tickets would let the client resume anyway
+    secureOptions: constants.SSL_OP_NO_TICKET,
+    sharedSessionCache: sharedSessionCache
+  }, function(socket) {
+    socket.end('Goodbye');
+  });
+}
+
+assert.throws(function() {
+  createServer({ size: 10 });
+}, TypeError);
+
+var first = createServer({ path: cacheFile, size: 64 });
+var second = createServer(cacheFile);
+var unshared = createServer();
+assert.ok(fs.statSync(cacheFile).size > 0);
+
+function connect(port, session, cb) {
+  var client = tls.connect({
+    port: port,
+    rejectUnauthorized: false,
+    session: session
+  }, function() {
+    var reused = client.isSessionReused();
+    var session = client.getSession();
+    client.on('close', function() {
+      cb(reused, session);
+    });
+  });
+  client.resume();
+}
+
+var checks = 0;
+first.listen(common.PORT, function() {
+  second.listen(common.PORT + 1, function() {
+    unshared.listen(common.PORT + 2, function() {
+      connect(common.PORT, null, function(reused, session) {
+        assert.ok(!reused);
+        connect(common.PORT + 1, session, function(reused) {
+          assert.ok(reused, 'Session should be resumed by the second server');
+          checks++;
+          connect(common.PORT + 2, session, function(reused) {
+            assert.ok(!reused);
+            checks++;
+            first.close();
+            second.close();
+            unshared.close();
+          });
+        });
+      });
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(checks, 2);
+  fs.unlinkSync(cacheFile);
+});
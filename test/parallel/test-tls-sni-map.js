@@ -0,0 +1,101 @@
+if (!process.features.tls_sni) {
+  console.error('Skipping because node compiled without OpenSSL or ' +
+                'with old OpenSSL version.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+
+if (!common.hasCrypto) {
+  console.log('1..0 # Skipped: missing crypto');
+  process.exit();
+}
+var tls = require('tls');
+
+// Exact names and wildcards added with server.addContext() are matched
+// natively, other patterns and custom SNICallbacks still go through JS.
+
+function loadPEM(n) {
+  return fs.readFileSync(common.fixturesDir + '/keys/' + n + '.pem');
+}
+
+function agent(n) {
+  return { key: loadPEM('agent' + n + '-key'),
+           cert: loadPEM('agent' + n + '-cert') };
+}
+
+// The server's own certificate is agent1, the common name of the
+// certificate that the client gets tells which context was used
+var server = tls.createServer(agent(1), function(c) {
+  c.end();
+});
+server.addContext('*.example.com', agent(2));
+server.addContext('exact.example.com', agent(3));
+server.addContext('www*.pattern.org', agent(2));
+for (var i = 0; i < 1000; i++)
+  server.addContext('host' + i + '.example.net', agent(2 + i % 2));
+
+var sniCalls = [];
+var custom = tls.createServer({
+  key: loadPEM('agent1-key'),
+  cert: loadPEM('agent1-cert'),
+  SNICallback: function(servername, cb) {
+    sniCalls.push(servername);
+    cb(null, servername === 'custom.org' ?
+        tls.createSecureContext(agent(3)).context : null);
+  }
+}, function(c) {
+  c.end();
+});
+custom.addContext('mapped.org', agent(2));
+
+var tests = [
+  [server, 'exact.example.com', 'agent3'],
+  [server, 'EXACT.Example.COM', 'agent3'],
+  [server, 'other.example.com', 'agent2'],
+  // Wildcards only match one label
+  [server, 'a.b.example.com', 'agent1'],
+  [server, 'example.com', 'agent1'],
+  [server, 'www1.pattern.org', 'agent2'],
+  [server, 'host500.example.net', 'agent2'],
+  [server, 'host501.example.net', 'agent3'],
+  [server, 'unknown.org', 'agent1'],
+  [custom, 'mapped.org', 'agent2'],
+  [custom, 'custom.org', 'agent3'],
+  [custom, 'unknown.org', 'agent1']
+];
+
+var results = [];
+function next() {
+  if (results.length === tests.length) {
+    server.close();
+    custom.close();
+    return;
+  }
+
+  var test = tests[results.length];
+  var port = test[0] === server ? common.PORT : common.PORT + 1;
+  var client = tls.connect({
+    port: port,
+    servername: test[1],
+    rejectUnauthorized: false
+  }, function() {
+    results.push(client.getPeerCertificate().subject.CN);
+    client.destroy();
+    next();
+  });
+}
+
+server.listen(common.PORT, function() {
+  custom.listen(common.PORT + 1, next);
+});
+
+process.on('exit', function() {
+  assert.deepEqual(results, tests.map(function(test) {
+    return test[2];
+  }));
+  // The callback isn't asked about the names that were added
+  assert.deepEqual(sniCalls, ['custom.org', 'unknown.org']);
+});
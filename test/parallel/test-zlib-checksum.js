@@ -0,0 +1,68 @@
+var common = require('../common');
+var assert = require('assert');
+var zlib = require('zlib');
+
+// Check values from the zlib and gzip specifications' reference code
+assert.strictEqual(zlib.crc32(''), 0);
+assert.strictEqual(zlib.crc32('123456789'), 0xcbf43926);
+assert.strictEqual(zlib.crc32(new Buffer('123456789')), 0xcbf43926);
+assert.strictEqual(zlib.crc32('The quick brown fox jumps over the lazy dog'),
+                   0x414fa339);
+assert.strictEqual(zlib.adler32(''), 1);
+assert.strictEqual(zlib.adler32('Wikipedia'), 0x11e60398);
+
+// Strings are utf8
+assert.strictEqual(zlib.crc32('ü'), zlib.crc32(new Buffer([0xc3, 0xbc])));
+
+// A table driven implementation to compare the accelerated one against
+var table = [];
+for (var n = 0; n < 256; n++) {
+  var c = n;
+  for (var k = 0; k < 8; k++)
+    c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+  table[n] = c >>> 0;
+}
+
+function crc32(buf, crc) {
+  crc = ~crc;
+  for (var i = 0; i < buf.length; i++)
+    crc = table[(crc ^ buf[i]) & 0xff] ^ (crc >>> 8);
+  return ~crc >>> 0;
+}
+
+var buf = new Buffer(4096 + 33);
+for (var i = 0; i < buf.length; i++)
+  buf[i] = (i * 31 + 7) & 0xff;
+
+// Every length around the block sizes, at different alignments
+var lengths = [0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 129, 1000, 4096];
+lengths.forEach(function(len) {
+  [0, 1, 7, 16, 33].forEach(function(start) {
+    var slice = buf.slice(start, start + len);
+    assert.strictEqual(zlib.crc32(slice), crc32(slice, 0),
+                       'crc32 of ' + len + ' bytes at ' + start);
+    assert.strictEqual(zlib.crc32(slice, 0xdeadbeef),
+                       crc32(slice, 0xdeadbeef));
+  });
+});
+
+// Continuing a checksum is the same as computing it in one go
+assert.strictEqual(zlib.crc32(buf.slice(100), zlib.crc32(buf.slice(0, 100))),
+                   zlib.crc32(buf));
+assert.strictEqual(zlib.adler32(buf.slice(100),
+                                zlib.adler32(buf.slice(0, 100))),
+                   zlib.adler32(buf));
+
+// Same as the trailer of a gzip file
+var gzipped = zlib.gzipSync(buf);
+assert.strictEqual(gzipped.readUInt32LE(gzipped.length - 8), zlib.crc32(buf));
+
+assert.throws(function() {
+  zlib.crc32(42);
+}, TypeError);
+assert.throws(function() {
+  zlib.adler32();
+}, TypeError);
+assert.throws(function() {
+  zlib.crc32('abc', '0');
+}, TypeError);